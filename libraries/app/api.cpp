@@ -83,7 +83,7 @@ bool login_api::login(const string &user, const string &password) {
 
 void login_api::enable_api(const std::string &api_name) {
    if (api_name == "database_api") {
-      _database_api = std::make_shared<database_api>(std::ref(*_app.chain_database()));
+      _database_api = std::make_shared<database_api>(std::ref(*_app.chain_database()), _app.database_api_state());
    } else if (api_name == "block_api") {
       _block_api = std::make_shared<block_api>(std::ref(*_app.chain_database()));
    } else if (api_name == "network_broadcast_api") {
@@ -568,7 +568,7 @@ range_proof_info crypto_api::range_get_info(const std::vector<char> &proof) {
 asset_api::asset_api(graphene::app::application &app) :
       _app(app),
       _db(*app.chain_database()),
-      database_api(std::ref(*app.chain_database())) {
+      database_api(std::ref(*app.chain_database()), app.database_api_state()) {
 }
 
 asset_api::~asset_api() {
@@ -608,13 +608,38 @@ vector<account_asset_balance> asset_api::get_asset_holders(std::string asset, ui
 
    return result;
 }
+
+vector<account_asset_balance> asset_api::list_asset_holders(std::string asset, optional<account_asset_balance> last, uint32_t limit) const {
+   FC_ASSERT(limit <= api_limit_get_asset_holders,
+             "Number of querying asset holder accounts can not be greater than ${configured_limit}",
+             ("configured_limit", api_limit_get_asset_holders));
+
+   asset_id_type asset_id = database_api.get_asset_id_from_string(asset);
+   const auto &bal_idx = _db.get_index_type<account_balance_index>().indices().get<by_asset_balance>();
+   auto itr = last.valid() ? bal_idx.upper_bound(boost::make_tuple(asset_id, last->amount, last->account_id))
+                           : bal_idx.lower_bound(boost::make_tuple(asset_id));
+
+   vector<account_asset_balance> result;
+   result.reserve(limit);
+   // balances are ordered largest first, so the empty ones come last
+   for (; itr != bal_idx.end() && itr->asset_type == asset_id && itr->balance.value != 0 && result.size() < limit; ++itr) {
+      account_asset_balance aab;
+      aab.name = itr->owner(_db).name;
+      aab.account_id = itr->owner;
+      aab.amount = itr->balance.value;
+      result.push_back(aab);
+   }
+
+   return result;
+}
+
 // get number of asset holders.
 int asset_api::get_asset_holders_count(std::string asset) const {
 
-   const auto &bal_idx = _db.get_index_type<account_balance_index>().indices().get<by_asset_balance>();
    asset_id_type asset_id = database_api.get_asset_id_from_string(asset);
-   auto range = bal_idx.equal_range(boost::make_tuple(asset_id));
-   int count = boost::distance(range) - 1;
+   const auto &balance_counts = _db.get_index_type<primary_index<account_balance_index>>()
+                                   .get_secondary_index<balance_counts_by_asset_index>();
+   int count = balance_counts.get_balance_counts(asset_id).balance_objects - 1;
 
    return count;
 }
@@ -622,18 +647,16 @@ int asset_api::get_asset_holders_count(std::string asset) const {
 vector<asset_holders> asset_api::get_all_asset_holders() const {
 
    vector<asset_holders> result;
+   const auto &balance_counts = _db.get_index_type<primary_index<account_balance_index>>()
+                                   .get_secondary_index<balance_counts_by_asset_index>();
 
-   vector<asset_id_type> total_assets;
    for (const asset_object &asset_obj : _db.get_index_type<asset_index>().indices()) {
       const auto &dasset_obj = asset_obj.dynamic_asset_data_id(_db);
 
       asset_id_type asset_id;
       asset_id = dasset_obj.id;
 
-      const auto &bal_idx = _db.get_index_type<account_balance_index>().indices().get<by_asset_balance>();
-      auto range = bal_idx.equal_range(boost::make_tuple(asset_id));
-
-      int count = boost::distance(range) - 1;
+      int count = balance_counts.get_balance_counts(asset_id).balance_objects - 1;
 
       asset_holders ah;
       ah.asset_id = asset_id;
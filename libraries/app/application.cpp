@@ -27,6 +27,7 @@
 #include <graphene/app/plugin.hpp>
 
 #include <graphene/chain/db_with.hpp>
+#include <graphene/chain/exceptions.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/protocol/fee_schedule.hpp>
 #include <graphene/protocol/types.hpp>
@@ -252,6 +253,17 @@ public:
       login->login(username, password);
    }
 
+   fc::http::websocket_send_options get_websocket_send_options() const {
+      fc::http::websocket_send_options send_options;
+      if (_options->count("rpc-enable-deflate"))
+         send_options.enable_deflate = _options->at("rpc-enable-deflate").as<bool>();
+      if (_options->count("rpc-deflate-min-size"))
+         send_options.deflate_min_size = _options->at("rpc-deflate-min-size").as<uint32_t>();
+      if (_options->count("rpc-max-frame-size"))
+         send_options.max_frame_size = _options->at("rpc-max-frame-size").as<uint32_t>();
+      return send_options;
+   }
+
    void reset_websocket_server() {
       try {
          if (!_options->count("rpc-endpoint"))
@@ -259,6 +271,7 @@ public:
 
          _websocket_server = std::make_shared<fc::http::websocket_server>();
          _websocket_server->on_connection(std::bind(&application_impl::new_connection, this, std::placeholders::_1));
+         _websocket_server->set_send_options(get_websocket_send_options());
 
          ilog("Configured websocket rpc to listen on ${ip}", ("ip", _options->at("rpc-endpoint").as<string>()));
          _websocket_server->listen(fc::ip::endpoint::from_string(_options->at("rpc-endpoint").as<string>()));
@@ -279,6 +292,7 @@ public:
          string password = _options->count("server-pem-password") ? _options->at("server-pem-password").as<string>() : "";
          _websocket_tls_server = std::make_shared<fc::http::websocket_tls_server>(_options->at("server-pem").as<string>(), password);
          _websocket_tls_server->on_connection(std::bind(&application_impl::new_connection, this, std::placeholders::_1));
+         _websocket_tls_server->set_send_options(get_websocket_send_options());
 
          ilog("Configured websocket TLS rpc to listen on ${ip}", ("ip", _options->at("rpc-tls-endpoint").as<string>()));
          _websocket_tls_server->listen(fc::ip::endpoint::from_string(_options->at("rpc-tls-endpoint").as<string>()));
@@ -289,7 +303,8 @@ public:
 
    explicit application_impl(application *self) :
          _self(self),
-         _chain_db(std::make_shared<chain::database>()) {
+         _chain_db(std::make_shared<chain::database>()),
+         _database_api_state(make_database_api_shared_state(*_chain_db)) {
    }
 
    ~application_impl() {
@@ -361,6 +376,10 @@ public:
          if (_options->count("enable-standby-votes-tracking")) {
             _chain_db->enable_standby_votes_tracking(_options->at("enable-standby-votes-tracking").as<bool>());
          }
+
+         if (_options->count("compress-block-storage")) {
+            _chain_db->enable_block_storage_compression(_options->at("compress-block-storage").as<bool>());
+         }
          
          std::string replay_reason = "reason not provided";
 
@@ -502,6 +521,11 @@ public:
    }
 
    virtual void handle_transaction(const graphene::net::trx_message &transaction_message) override {
+      // Turn junk away before it costs an undo session and an exception carrying the whole transaction
+      const auto precheck = _chain_db->precheck_transaction(transaction_message.trx);
+      if (precheck != graphene::chain::transaction_precheck_result::accepted)
+         FC_THROW_EXCEPTION(graphene::chain::transaction_rejected_exception, "Transaction rejected: ${r}", ("r", precheck));
+
       try {
          static fc::time_point last_call;
          static int trx_count = 0;
@@ -833,6 +857,8 @@ public:
    api_access _apiaccess;
 
    std::shared_ptr<graphene::chain::database> _chain_db;
+   /// declared after _chain_db so that it is destroyed first, it is connected to the database's signals
+   std::shared_ptr<database_api_shared_state> _database_api_state;
    std::shared_ptr<graphene::net::node> _p2p_network;
    std::shared_ptr<fc::http::websocket_server> _websocket_server;
    std::shared_ptr<fc::http::websocket_tls_server> _websocket_tls_server;
@@ -869,12 +895,21 @@ void application::set_program_options(boost::program_options::options_descriptio
    cfg.add_options()("rpc-tls-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8089"), "Endpoint for TLS websocket RPC to listen on");
    cfg.add_options()("server-pem,p", bpo::value<string>()->implicit_value("server.pem"), "The TLS certificate file for this server");
    cfg.add_options()("server-pem-password,P", bpo::value<string>()->implicit_value(""), "Password for this certificate");
+   cfg.add_options()("rpc-enable-deflate", bpo::value<bool>()->default_value(true),
+                     "Compress websocket RPC messages with permessage-deflate for clients which support it");
+   cfg.add_options()("rpc-deflate-min-size", bpo::value<uint32_t>()->default_value(0),
+                     "Send websocket RPC messages shorter than this many bytes uncompressed");
+   cfg.add_options()("rpc-max-frame-size", bpo::value<uint32_t>()->default_value(0),
+                     "Stream uncompressed websocket RPC responses in frames of at most this many bytes, 0 to send each in one frame");
    cfg.add_options()("genesis-json", bpo::value<boost::filesystem::path>(), "File to read Genesis State from");
    cfg.add_options()("dbg-init-key", bpo::value<string>(), "Block signing key to use for init witnesses, overrides genesis file");
    cfg.add_options()("api-access", bpo::value<boost::filesystem::path>(), "JSON file specifying API permissions");
    cfg.add_options()("enable-standby-votes-tracking", bpo::value<bool>()->implicit_value(true),
                      "Whether to enable tracking of votes of standby witnesses and committee members. "
                      "Set it to true to provide accurate data to API clients, set to false for slightly better performance.");
+   cfg.add_options()("compress-block-storage", bpo::value<bool>()->implicit_value(true),
+                     "Whether to store blocks in segments and zlib compress the irreversible ones, migrating existing "
+                     "block storage in the background. Set it to true to save disk space.");
    cfg.add_options()("plugins", bpo::value<string>()->default_value("account_history accounts_list affiliate_stats bookie market_history witness"),
                      "Space-separated list of plugins to activate");
 
@@ -977,6 +1012,10 @@ std::shared_ptr<chain::database> application::chain_database() const {
    return my->_chain_db;
 }
 
+std::shared_ptr<database_api_shared_state> application::database_api_state() const {
+   return my->_database_api_state;
+}
+
 void application::set_block_production(bool producing_blocks) {
    my->_is_block_producer = producing_blocks;
 }
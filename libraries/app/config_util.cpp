@@ -80,7 +80,9 @@ static void write_default_logging_config_to_stream(std::ostream &out) {
           "# Rotate log every ? minutes, if leave out default to 60\n"
           "rotation_interval=60\n"
           "# how long will logs be kept (in days), if leave out default to 1\n"
-          "rotation_limit=7\n\n"
+          "rotation_limit=7\n"
+          "# write the log from a background thread so slow disks don't delay block processing, default false\n"
+          "# async=true\n\n"
           "# declare an appender named \"p2p\" that writes messages to p2p.log\n"
           "[log.file_appender.p2p]\n"
           "# filename can be absolute or relative to this config file\n"
@@ -165,6 +167,7 @@ static fc::optional<fc::logging_config> load_logging_config_from_ini_file(const
             file_appender_config.rotate = true;
             file_appender_config.rotation_interval = fc::minutes(interval);
             file_appender_config.rotation_limit = fc::days(limit);
+            file_appender_config.async = section_tree.get_optional<bool>("async").get_value_or(false);
             logging_config.appenders.push_back(fc::appender_config(file_appender_name, "file", fc::variant(file_appender_config, GRAPHENE_MAX_NESTED_OBJECTS)));
             found_logging_config = true;
          } else if (boost::starts_with(section_name, logger_section_prefix)) {
@@ -36,18 +36,26 @@
 
 #include <fc/crypto/hex.hpp>
 #include <fc/rpc/api_connection.hpp>
+#include <fc/thread/thread.hpp>
 #include <fc/uint128.hpp>
 
 #include <boost/multiprecision/cpp_int.hpp>
 #include <boost/range/iterator_range.hpp>
 #include <boost/rational.hpp>
 
+#include <atomic>
 #include <cctype>
 
 #include <cfenv>
 #include <iostream>
+#include <list>
 
 #define GET_REQUIRED_FEES_MAX_RECURSION 4
+// object ids a connection may subscribe to exactly, beyond that they are matched by a bloom filter; also the
+// limit on the keys and on the addresses it may subscribe to
+#define MAX_EXACT_OBJECT_SUBSCRIPTIONS 10000
+// accounts whose get_full_accounts result is kept between calls, the least recently used one is evicted first
+#define MAX_CACHED_FULL_ACCOUNTS 1000
 
 typedef std::map<std::pair<graphene::chain::asset_id_type, graphene::chain::asset_id_type>, std::vector<fc::variant>> market_queue_type;
 
@@ -55,9 +63,376 @@ template class fc::api<graphene::app::database_api>;
 
 namespace graphene { namespace app {
 
+namespace detail {
+
+/**
+ * The subscriptions of one connection, shared by its database_api_impl and the subscription_registry.
+ */
+struct object_subscriber : public std::enable_shared_from_this<object_subscriber> {
+   std::function<void(const fc::variant &)> callback;
+   /// the thread the callback was set on, which serves the connection; notices are sent from it
+   fc::thread *thread = nullptr;
+   /// cleared when the subscriber is removed, notices still queued for it are dropped then
+   std::atomic<bool> active{true};
+   bool notify_remove_create = false;
+   flat_set<object_id_type> objects;
+   flat_set<account_id_type> accounts;
+   /// accounts referencing these keys or addresses, and balances owned by the addresses
+   flat_set<public_key_type> keys;
+   flat_set<address> addresses;
+   /// ids subscribed once @ref objects is full, matched approximately
+   optional<fc::bloom_filter> overflow_filter;
+};
+
+/**
+ * Maps subscribed objects, accounts, keys and addresses to the connections subscribed to them, for every
+ * database_api of one database. Each batch of changed objects is matched and serialized once rather than once per
+ * connection. The notices are queued to the thread serving each connection, so block application does not wait on
+ * connections and a notice is never written to a connection in the middle of a reply.
+ *
+ * Apart from the delivery, the registry is only used from the thread which applies blocks and serves
+ * API calls.
+ */
+class subscription_registry {
+public:
+   explicit subscription_registry(graphene::chain::database &db);
+
+   void add_subscriber(const std::shared_ptr<object_subscriber> &s);
+   void remove_subscriber(const std::shared_ptr<object_subscriber> &s);
+   void subscribe_to_object(object_subscriber &s, object_id_type id);
+   void subscribe_to_account(object_subscriber &s, account_id_type account);
+   void subscribe_to_key(object_subscriber &s, const public_key_type &key);
+   void subscribe_to_address(object_subscriber &s, const address &addr);
+
+private:
+   void on_objects(bool created_or_removed, bool full_object, const vector<object_id_type> &ids,
+                   const flat_set<account_id_type> &impacted_accounts,
+                   const std::function<const object *(object_id_type id)> &find_object);
+   /// adds the subscribers to a key or address which @p obj references to @p matched
+   void match_keys(const object &obj, flat_set<object_subscriber *> &matched) const;
+
+   graphene::chain::database &_db;
+   std::set<std::shared_ptr<object_subscriber>> _subscribers;
+   std::map<object_id_type, flat_set<object_subscriber *>> _object_subscribers;
+   std::map<account_id_type, flat_set<object_subscriber *>> _account_subscribers;
+   std::map<public_key_type, flat_set<object_subscriber *>> _key_subscribers;
+   std::map<address, flat_set<object_subscriber *>> _address_subscribers;
+   flat_set<object_subscriber *> _remove_create_subscribers;
+   flat_set<object_subscriber *> _overflowed_subscribers;
+
+   boost::signals2::scoped_connection _new_connection;
+   boost::signals2::scoped_connection _change_connection;
+   boost::signals2::scoped_connection _removed_connection;
+};
+
+template <typename Key>
+static void unsubscribe(std::map<Key, flat_set<object_subscriber *>> &subscribers, const flat_set<Key> &keys,
+                        object_subscriber *s) {
+   for (const Key &key : keys) {
+      auto itr = subscribers.find(key);
+      itr->second.erase(s);
+      if (itr->second.empty())
+         subscribers.erase(itr);
+   }
+}
+
+subscription_registry::subscription_registry(graphene::chain::database &db) :
+      _db(db) {
+   _new_connection = _db.new_objects.connect([this](const vector<object_id_type> &ids, const flat_set<account_id_type> &impacted_accounts) {
+      on_objects(true, true, ids, impacted_accounts,
+                 std::bind(&object_database::find_object, &_db, std::placeholders::_1));
+   });
+   _change_connection = _db.changed_objects.connect([this](const vector<object_id_type> &ids, const flat_set<account_id_type> &impacted_accounts) {
+      on_objects(false, true, ids, impacted_accounts,
+                 std::bind(&object_database::find_object, &_db, std::placeholders::_1));
+   });
+   _removed_connection = _db.removed_objects.connect([this](const vector<object_id_type> &ids, const vector<const object *> &objs, const flat_set<account_id_type> &impacted_accounts) {
+      on_objects(true, false, ids, impacted_accounts,
+                 [&objs](object_id_type id) -> const object * {
+                    auto it = std::find_if(objs.begin(), objs.end(), [id](const object *o) {
+                       return o != nullptr && o->id == id;
+                    });
+                    return it != objs.end() ? *it : nullptr;
+                 });
+   });
+}
+
+void subscription_registry::add_subscriber(const std::shared_ptr<object_subscriber> &s) {
+   _subscribers.insert(s);
+   if (s->notify_remove_create)
+      _remove_create_subscribers.insert(s.get());
+}
+
+void subscription_registry::remove_subscriber(const std::shared_ptr<object_subscriber> &s) {
+   s->active = false;
+   unsubscribe(_object_subscribers, s->objects, s.get());
+   unsubscribe(_account_subscribers, s->accounts, s.get());
+   unsubscribe(_key_subscribers, s->keys, s.get());
+   unsubscribe(_address_subscribers, s->addresses, s.get());
+   _remove_create_subscribers.erase(s.get());
+   _overflowed_subscribers.erase(s.get());
+   _subscribers.erase(s);
+}
+
+void subscription_registry::subscribe_to_object(object_subscriber &s, object_id_type id) {
+   if (s.objects.find(id) != s.objects.end())
+      return;
+   if (s.objects.size() < MAX_EXACT_OBJECT_SUBSCRIPTIONS) {
+      s.objects.insert(id);
+      _object_subscribers[id].insert(&s);
+      return;
+   }
+   if (!s.overflow_filter) {
+      static fc::bloom_parameters param;
+      param.projected_element_count = 10000;
+      param.false_positive_probability = 1.0 / 100;
+      param.maximum_size = 1024 * 8 * 8 * 2;
+      param.compute_optimal_parameters();
+      s.overflow_filter = fc::bloom_filter(param);
+      _overflowed_subscribers.insert(&s);
+   }
+   s.overflow_filter->insert(id);
+}
+
+void subscription_registry::subscribe_to_account(object_subscriber &s, account_id_type account) {
+   if (s.accounts.insert(account).second)
+      _account_subscribers[account].insert(&s);
+}
+
+// keys and addresses are only ever matched exactly, a connection looking up more than the limit is not
+// notified about the excess
+void subscription_registry::subscribe_to_key(object_subscriber &s, const public_key_type &key) {
+   if (s.keys.size() < MAX_EXACT_OBJECT_SUBSCRIPTIONS && s.keys.insert(key).second)
+      _key_subscribers[key].insert(&s);
+}
+
+void subscription_registry::subscribe_to_address(object_subscriber &s, const address &addr) {
+   if (s.addresses.size() < MAX_EXACT_OBJECT_SUBSCRIPTIONS && s.addresses.insert(addr).second)
+      _address_subscribers[addr].insert(&s);
+}
+
+void subscription_registry::match_keys(const object &obj, flat_set<object_subscriber *> &matched) const {
+   auto match = [&matched](const auto &subscribers, const auto &key) {
+      auto itr = subscribers.find(key);
+      if (itr != subscribers.end())
+         matched.insert(itr->second.begin(), itr->second.end());
+   };
+   if (obj.id.is<account_id_type>()) {
+      const auto &account = static_cast<const account_object &>(obj);
+      for (const authority *auth : {&account.owner, &account.active}) {
+         for (const auto &key : auth->key_auths)
+            match(_key_subscribers, key.first);
+         for (const auto &addr : auth->address_auths)
+            match(_address_subscribers, addr.first);
+      }
+      match(_key_subscribers, account.options.memo_key);
+   } else if (obj.id.is<balance_id_type>()) {
+      match(_address_subscribers, static_cast<const balance_object &>(obj).owner);
+   }
+}
+
+void subscription_registry::on_objects(bool created_or_removed, bool full_object, const vector<object_id_type> &ids,
+                                       const flat_set<account_id_type> &impacted_accounts,
+                                       const std::function<const object *(object_id_type id)> &find_object) {
+   if (_subscribers.empty())
+      return;
+
+   // connections subscribed to an impacted account, or to all creations and removals, are sent every id
+   flat_set<object_subscriber *> batch_subscribers;
+   for (const account_id_type &account : impacted_accounts) {
+      auto itr = _account_subscribers.find(account);
+      if (itr != _account_subscribers.end())
+         batch_subscribers.insert(itr->second.begin(), itr->second.end());
+   }
+   if (created_or_removed)
+      batch_subscribers.insert(_remove_create_subscribers.begin(), _remove_create_subscribers.end());
+
+   std::map<object_subscriber *, vector<variant>> updates;
+   for (const object_id_type &id : ids) {
+      optional<variant> update;
+      bool serialized = false;
+      auto notify = [&](object_subscriber *s) {
+         if (!serialized) {
+            serialized = true;
+            if (!full_object)
+               update = fc::variant(id, 1);
+            else if (auto obj = find_object(id))
+               update = obj->to_variant();
+         }
+         if (update)
+            updates[s].emplace_back(*update);
+      };
+
+      flat_set<object_subscriber *> matched;
+      auto itr = _object_subscribers.find(id);
+      if (itr != _object_subscribers.end())
+         matched.insert(itr->second.begin(), itr->second.end());
+      for (object_subscriber *s : _overflowed_subscribers)
+         if (s->overflow_filter->contains(id))
+            matched.insert(s);
+      if (!_key_subscribers.empty() || !_address_subscribers.empty())
+         if (auto obj = find_object(id))
+            match_keys(*obj, matched);
+
+      for (object_subscriber *s : batch_subscribers)
+         notify(s);
+      for (object_subscriber *s : matched)
+         if (batch_subscribers.find(s) == batch_subscribers.end())
+            notify(s);
+   }
+
+   for (auto &item : updates) {
+      // keeps the subscriber alive until the notice is sent, its connection may close in the meantime
+      std::shared_ptr<object_subscriber> subscriber = item.first->shared_from_this();
+      auto notices = std::make_shared<vector<variant>>(std::move(item.second));
+      subscriber->thread->async([subscriber, notices]() {
+         if (subscriber->active)
+            subscriber->callback(fc::variant(*notices));
+      }, "subscription notice");
+   }
+}
+
+/**
+ * The full accounts built by get_full_accounts, shared by every database_api of one database.
+ *
+ * An entry is dropped when a block changes an object relevant to its account. Entries built while transactions
+ * are pending only last until the next block, which rewinds the pending state, and a pending transaction drops
+ * every entry since it may fill orders of any account. Votes and proposals are not cached, the objects they
+ * embed change without impacting the voter or the approver.
+ *
+ * Only used from the thread which applies blocks and serves API calls.
+ */
+class full_account_cache {
+public:
+   explicit full_account_cache(graphene::chain::database &db);
+
+   /// @return the cached full account of @p account, or nullptr
+   const full_account *find(account_id_type account);
+   void insert(account_id_type account, const full_account &acnt);
+
+private:
+   void on_applied_block(const signed_block &block);
+   void invalidate(const flat_set<account_id_type> &impacted_accounts);
+
+   struct entry {
+      full_account account;
+      bool built_on_pending = false;
+      std::list<account_id_type>::iterator recency;
+   };
+   typedef std::map<account_id_type, entry> entry_map;
+
+   entry_map::iterator erase(entry_map::iterator itr);
+   void clear();
+
+   graphene::chain::database &_db;
+   entry_map _entries;
+   /// the cached accounts, most recently used first
+   std::list<account_id_type> _recently_used;
+   /// unknown until the first block is applied, the database may not be open yet when the cache is created
+   block_id_type _head_block_id;
+   bool _transactions_pending = false;
+
+   boost::signals2::scoped_connection _new_connection;
+   boost::signals2::scoped_connection _change_connection;
+   boost::signals2::scoped_connection _removed_connection;
+   boost::signals2::scoped_connection _applied_block_connection;
+   boost::signals2::scoped_connection _pending_trx_connection;
+};
+
+full_account_cache::full_account_cache(graphene::chain::database &db) :
+      _db(db) {
+   _new_connection = _db.new_objects.connect([this](const vector<object_id_type> &, const flat_set<account_id_type> &impacted_accounts) {
+      invalidate(impacted_accounts);
+   });
+   _change_connection = _db.changed_objects.connect([this](const vector<object_id_type> &, const flat_set<account_id_type> &impacted_accounts) {
+      invalidate(impacted_accounts);
+   });
+   _removed_connection = _db.removed_objects.connect([this](const vector<object_id_type> &, const vector<const object *> &, const flat_set<account_id_type> &impacted_accounts) {
+      invalidate(impacted_accounts);
+   });
+   _applied_block_connection = _db.applied_block.connect([this](const signed_block &block) {
+      on_applied_block(block);
+   });
+   _pending_trx_connection = _db.on_pending_transaction.connect([this](const signed_transaction &) {
+      clear();
+      _transactions_pending = true;
+   });
+}
+
+const full_account *full_account_cache::find(account_id_type account) {
+   auto itr = _entries.find(account);
+   if (itr == _entries.end())
+      return nullptr;
+   _recently_used.splice(_recently_used.begin(), _recently_used, itr->second.recency);
+   return &itr->second.account;
+}
+
+void full_account_cache::insert(account_id_type account, const full_account &acnt) {
+   auto itr = _entries.find(account);
+   if (itr != _entries.end())
+      erase(itr);
+   else if (_entries.size() >= MAX_CACHED_FULL_ACCOUNTS)
+      erase(_entries.find(_recently_used.back()));
+   _recently_used.push_front(account);
+   _entries.emplace(account, entry{acnt, _transactions_pending, _recently_used.begin()});
+}
+
+full_account_cache::entry_map::iterator full_account_cache::erase(entry_map::iterator itr) {
+   _recently_used.erase(itr->second.recency);
+   return _entries.erase(itr);
+}
+
+void full_account_cache::clear() {
+   _entries.clear();
+   _recently_used.clear();
+}
+
+void full_account_cache::on_applied_block(const signed_block &block) {
+   if (block.previous != _head_block_id) {
+      // switched forks, the popped blocks changed objects without notifying
+      clear();
+   } else if (_transactions_pending) {
+      for (auto itr = _entries.begin(); itr != _entries.end();) {
+         if (itr->second.built_on_pending)
+            itr = erase(itr);
+         else
+            ++itr;
+      }
+   }
+   _transactions_pending = false;
+   _head_block_id = _db.head_block_id();
+}
+
+void full_account_cache::invalidate(const flat_set<account_id_type> &impacted_accounts) {
+   if (_entries.empty())
+      return;
+   for (const account_id_type &account : impacted_accounts) {
+      auto itr = _entries.find(account);
+      if (itr != _entries.end())
+         erase(itr);
+   }
+}
+
+} // namespace detail
+
+class database_api_shared_state {
+public:
+   explicit database_api_shared_state(graphene::chain::database &db) :
+         subscriptions(std::make_shared<detail::subscription_registry>(db)),
+         full_accounts(std::make_shared<detail::full_account_cache>(db)) {
+   }
+
+   const std::shared_ptr<detail::subscription_registry> subscriptions;
+   const std::shared_ptr<detail::full_account_cache> full_accounts;
+};
+
+std::shared_ptr<database_api_shared_state> make_database_api_shared_state(graphene::chain::database &db) {
+   return std::make_shared<database_api_shared_state>(db);
+}
+
 class database_api_impl : public std::enable_shared_from_this<database_api_impl> {
 public:
-   database_api_impl(graphene::chain::database &db);
+   database_api_impl(graphene::chain::database &db, const std::shared_ptr<database_api_shared_state> &shared_state);
    ~database_api_impl();
 
    // Objects
@@ -92,6 +467,7 @@ public:
    account_id_type get_account_id_from_string(const std::string &name_or_id) const;
    vector<optional<account_object>> get_accounts(const vector<std::string> &account_names_or_ids) const;
    std::map<string, full_account> get_full_accounts(const vector<string> &names_or_ids, bool subscribe);
+   full_account build_full_account(const account_object &account, std::map<account_id_type, string> &names) const;
    optional<account_object> get_account_by_name(string name) const;
    vector<account_id_type> get_account_references(const std::string account_id_or_name) const;
    vector<optional<account_object>> lookup_account_names(const vector<string> &account_names) const;
@@ -225,6 +601,8 @@ public:
    nft_object nft_token_of_owner_by_index(const nft_metadata_id_type nft_metadata_id, const account_id_type owner, const uint64_t token_idx) const;
    vector<nft_object> nft_get_all_tokens() const;
    vector<nft_object> nft_get_tokens_by_owner(const account_id_type owner) const;
+   vector<nft_object> nft_list_tokens(const nft_id_type lower_id, uint32_t limit) const;
+   vector<nft_object> nft_list_tokens_by_owner(const account_id_type owner, const nft_id_type lower_id, uint32_t limit) const;
 
    // Marketplace
    vector<offer_object> list_offers(const offer_id_type lower_id, uint32_t limit) const;
@@ -242,6 +620,7 @@ public:
    uint32_t api_limit_get_limit_orders_by_account = 101;
    uint32_t api_limit_get_order_book = 50;
    uint32_t api_limit_all_offers_count = 100;
+   uint32_t api_limit_nft_list_tokens = 100;
    uint32_t api_limit_lookup_accounts = 1000;
    uint32_t api_limit_lookup_witness_accounts = 1000;
    uint32_t api_limit_lookup_committee_member_accounts = 1000;
@@ -256,32 +635,17 @@ public:
                                                  bool throw_if_not_found = true) const;
    const asset_object *get_asset_from_string(const std::string &symbol_or_id,
                                              bool throw_if_not_found = true) const;
-   template <typename T>
-   void subscribe_to_item(const T &i) const {
-      auto vec = fc::raw::pack(i);
-      if (!_subscribe_callback)
-         return;
-
-      if (!is_subscribed_to_item(i)) {
-         _subscribe_filter.insert(vec.data(), vec.size()); //(vecconst char*)&i, sizeof(i) );
-      }
+   void subscribe_to_item(object_id_type id) const {
+      if (_subscriber)
+         _subscriptions->subscribe_to_object(*_subscriber, id);
    }
-
-   template <typename T>
-   bool is_subscribed_to_item(const T &i) const {
-      if (!_subscribe_callback)
-         return false;
-
-      return _subscribe_filter.contains(i);
+   void subscribe_to_key(const public_key_type &key) const {
+      if (_subscriber)
+         _subscriptions->subscribe_to_key(*_subscriber, key);
    }
-
-   bool is_impacted_account(const flat_set<account_id_type> &accounts) {
-      if (!_subscribed_accounts.size() || !accounts.size())
-         return false;
-
-      return std::any_of(accounts.begin(), accounts.end(), [this](const account_id_type &account) {
-         return _subscribed_accounts.find(account) != _subscribed_accounts.end();
-      });
+   void subscribe_to_address(const address &addr) const {
+      if (_subscriber)
+         _subscriptions->subscribe_to_address(*_subscriber, addr);
    }
 
    template <typename T>
@@ -297,20 +661,19 @@ public:
       }
    }
 
-   void broadcast_updates(const vector<variant> &updates);
    void broadcast_market_updates(const market_queue_type &queue);
-   void handle_object_changed(bool force_notify, bool full_object, const vector<object_id_type> &ids, const flat_set<account_id_type> &impacted_accounts, std::function<const object *(object_id_type id)> find_object);
+   void handle_object_changed(bool full_object, const vector<object_id_type> &ids, std::function<const object *(object_id_type id)> find_object);
 
    /** called every time a block is applied to report the objects that were changed */
-   void on_objects_new(const vector<object_id_type> &ids, const flat_set<account_id_type> &impacted_accounts);
-   void on_objects_changed(const vector<object_id_type> &ids, const flat_set<account_id_type> &impacted_accounts);
-   void on_objects_removed(const vector<object_id_type> &ids, const vector<const object *> &objs, const flat_set<account_id_type> &impacted_accounts);
+   void on_objects_new(const vector<object_id_type> &ids);
+   void on_objects_changed(const vector<object_id_type> &ids);
+   void on_objects_removed(const vector<object_id_type> &ids, const vector<const object *> &objs);
    void on_applied_block();
 
-   bool _notify_remove_create = false;
-   mutable fc::bloom_filter _subscribe_filter;
-   std::set<account_id_type> _subscribed_accounts;
-   std::function<void(const fc::variant &)> _subscribe_callback;
+   /// object and account subscriptions are matched by the registry shared by all connections
+   std::shared_ptr<detail::subscription_registry> _subscriptions;
+   std::shared_ptr<detail::object_subscriber> _subscriber;
+   std::shared_ptr<detail::full_account_cache> _full_accounts;
    std::function<void(const fc::variant &)> _pending_trx_callback;
    std::function<void(const fc::variant &)> _block_applied_callback;
 
@@ -329,24 +692,26 @@ public:
 //                                                                  //
 //////////////////////////////////////////////////////////////////////
 
-database_api::database_api(graphene::chain::database &db) :
-      my(new database_api_impl(db)) {
+database_api::database_api(graphene::chain::database &db, std::shared_ptr<database_api_shared_state> shared_state) :
+      my(new database_api_impl(db, shared_state ? shared_state : make_database_api_shared_state(db))) {
 }
 
 database_api::~database_api() {
 }
 
-database_api_impl::database_api_impl(graphene::chain::database &db) :
+database_api_impl::database_api_impl(graphene::chain::database &db, const std::shared_ptr<database_api_shared_state> &shared_state) :
+      _subscriptions(shared_state->subscriptions),
+      _full_accounts(shared_state->full_accounts),
       _db(db) {
    wlog("creating database api ${x}", ("x", int64_t(this)));
-   _new_connection = _db.new_objects.connect([this](const vector<object_id_type> &ids, const flat_set<account_id_type> &impacted_accounts) {
-      on_objects_new(ids, impacted_accounts);
+   _new_connection = _db.new_objects.connect([this](const vector<object_id_type> &ids, const flat_set<account_id_type> &) {
+      on_objects_new(ids);
    });
-   _change_connection = _db.changed_objects.connect([this](const vector<object_id_type> &ids, const flat_set<account_id_type> &impacted_accounts) {
-      on_objects_changed(ids, impacted_accounts);
+   _change_connection = _db.changed_objects.connect([this](const vector<object_id_type> &ids, const flat_set<account_id_type> &) {
+      on_objects_changed(ids);
    });
-   _removed_connection = _db.removed_objects.connect([this](const vector<object_id_type> &ids, const vector<const object *> &objs, const flat_set<account_id_type> &impacted_accounts) {
-      on_objects_removed(ids, objs, impacted_accounts);
+   _removed_connection = _db.removed_objects.connect([this](const vector<object_id_type> &ids, const vector<const object *> &objs, const flat_set<account_id_type> &) {
+      on_objects_removed(ids, objs);
    });
    _applied_block_connection = _db.applied_block.connect([this](const signed_block &) {
       on_applied_block();
@@ -360,6 +725,8 @@ database_api_impl::database_api_impl(graphene::chain::database &db) :
 
 database_api_impl::~database_api_impl() {
    elog("freeing database api ${x}", ("x", int64_t(this)));
+   if (_subscriber)
+      _subscriptions->remove_subscriber(_subscriber);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -373,7 +740,7 @@ fc::variants database_api::get_objects(const vector<object_id_type> &ids) const
 }
 
 fc::variants database_api_impl::get_objects(const vector<object_id_type> &ids) const {
-   if (_subscribe_callback) {
+   if (_subscriber) {
       for (auto id : ids) {
          if (id.type() == operation_history_object_type && id.space() == protocol_ids)
             continue;
@@ -408,17 +775,16 @@ void database_api::set_subscribe_callback(std::function<void(const variant &)> c
 }
 
 void database_api_impl::set_subscribe_callback(std::function<void(const variant &)> cb, bool notify_remove_create) {
-   //edump((clear_filter));
-   _subscribe_callback = cb;
-   _notify_remove_create = notify_remove_create;
-   _subscribed_accounts.clear();
-
-   static fc::bloom_parameters param;
-   param.projected_element_count = 10000;
-   param.false_positive_probability = 1.0 / 100;
-   param.maximum_size = 1024 * 8 * 8 * 2;
-   param.compute_optimal_parameters();
-   _subscribe_filter = fc::bloom_filter(param);
+   if (_subscriber)
+      _subscriptions->remove_subscriber(_subscriber);
+   _subscriber.reset();
+   if (cb) {
+      _subscriber = std::make_shared<detail::object_subscriber>();
+      _subscriber->callback = cb;
+      _subscriber->thread = &fc::thread::current();
+      _subscriber->notify_remove_create = notify_remove_create;
+      _subscriptions->add_subscriber(_subscriber);
+   }
 }
 
 void database_api::set_pending_transaction_callback(std::function<void(const variant &)> cb) {
@@ -599,12 +965,9 @@ vector<vector<account_id_type>> database_api_impl::get_key_references(vector<pub
       address a4(pts_address(key, true, 0));
       address a5(key);
 
-      subscribe_to_item(key);
-      subscribe_to_item(a1);
-      subscribe_to_item(a2);
-      subscribe_to_item(a3);
-      subscribe_to_item(a4);
-      subscribe_to_item(a5);
+      subscribe_to_key(key);
+      for (auto &a : {a1, a2, a3, a4, a5})
+         subscribe_to_address(a);
 
       vector<account_id_type> result;
 
@@ -628,9 +991,6 @@ vector<vector<account_id_type>> database_api_impl::get_key_references(vector<pub
       final_result.emplace_back(std::move(result));
    }
 
-   for (auto i : final_result)
-      subscribe_to_item(i);
-
    return final_result;
 }
 
@@ -700,6 +1060,8 @@ std::map<std::string, full_account> database_api_impl::get_full_accounts(const v
    const auto &proposals_by_account = pidx.get_secondary_index<graphene::chain::required_approval_index>();
 
    std::map<std::string, full_account> results;
+   // registrars and referrers are mostly shared by the requested accounts
+   std::map<account_id_type, string> names;
 
    for (const std::string &account_name_or_id : names_or_ids) {
       const account_object *account = nullptr;
@@ -714,23 +1076,20 @@ std::map<std::string, full_account> database_api_impl::get_full_accounts(const v
       if (account == nullptr)
          continue;
 
-      if (subscribe) {
-         FC_ASSERT(std::distance(_subscribed_accounts.begin(), _subscribed_accounts.end()) <= 100);
-         _subscribed_accounts.insert(account->get_id());
+      if (subscribe && _subscriber) {
+         FC_ASSERT(_subscriber->accounts.size() <= 100);
+         _subscriptions->subscribe_to_account(*_subscriber, account->get_id());
          subscribe_to_item(account->id);
       }
 
-      full_account acnt;
-      acnt.account = *account;
-      acnt.statistics = account->statistics(_db);
-      acnt.registrar_name = account->registrar(_db).name;
-      acnt.referrer_name = account->referrer(_db).name;
-      acnt.lifetime_referrer_name = account->lifetime_referrer(_db).name;
-      acnt.votes = lookup_vote_ids(vector<vote_id_type>(account->options.votes.begin(), account->options.votes.end()));
-
-      if (account->cashback_vb) {
-         acnt.cashback_balance = account->cashback_balance(_db);
+      full_account &acnt = results[account_name_or_id];
+      if (const full_account *cached = _full_accounts->find(account->id))
+         acnt = *cached;
+      else {
+         acnt = build_full_account(*account, names);
+         _full_accounts->insert(account->id, acnt);
       }
+
       // Add the account's proposals
       auto required_approvals_itr = proposals_by_account._account_to_proposals.find(account->id);
       if (required_approvals_itr != proposals_by_account._account_to_proposals.end()) {
@@ -738,58 +1097,99 @@ std::map<std::string, full_account> database_api_impl::get_full_accounts(const v
          for (auto proposal_id : required_approvals_itr->second)
             acnt.proposals.push_back(proposal_id(_db));
       }
+   }
 
-      // Add the account's balances
-      const auto &balances = _db.get_index_type<primary_index<account_balance_index>>().get_secondary_index<balances_by_account_index>().get_account_balances(account->id);
-      for (const auto balance : balances)
-         acnt.balances.emplace_back(*balance.second);
+   // Look up the votes of all the accounts at once, they mostly vote for the same witnesses and committee members
+   flat_set<vote_id_type> vote_ids;
+   for (const auto &item : results)
+      vote_ids.insert(item.second.account.options.votes.begin(), item.second.account.options.votes.end());
+   std::map<vote_id_type, variant> votes;
+   for (auto itr = vote_ids.begin(); itr != vote_ids.end();) {
+      auto batch_end = itr + std::min<size_t>(vote_ids.end() - itr, 999);
+      vector<vote_id_type> batch(itr, batch_end);
+      vector<variant> found = lookup_vote_ids(batch);
+      for (size_t i = 0; i < found.size(); ++i)
+         votes[batch[i]] = std::move(found[i]);
+      itr = batch_end;
+   }
+   for (auto &item : results) {
+      full_account &acnt = item.second;
+      acnt.votes.reserve(acnt.account.options.votes.size());
+      for (const vote_id_type &vote : acnt.account.options.votes)
+         acnt.votes.push_back(votes[vote]);
+   }
 
-      // Add the account's vesting balances
-      auto vesting_range = _db.get_index_type<vesting_balance_index>().indices().get<by_account>().equal_range(account->id);
-      std::for_each(vesting_range.first, vesting_range.second,
-                    [&acnt](const vesting_balance_object &balance) {
-                       acnt.vesting_balances.emplace_back(balance);
-                    });
+   return results;
+}
 
-      // Add the account's orders
-      auto order_range = _db.get_index_type<limit_order_index>().indices().get<by_account>().equal_range(account->id);
-      std::for_each(order_range.first, order_range.second,
-                    [&acnt](const limit_order_object &order) {
-                       acnt.limit_orders.emplace_back(order);
-                    });
-      auto call_range = _db.get_index_type<call_order_index>().indices().get<by_account>().equal_range(account->id);
-      std::for_each(call_range.first, call_range.second,
-                    [&acnt](const call_order_object &call) {
-                       acnt.call_orders.emplace_back(call);
-                    });
-      auto settle_range = _db.get_index_type<force_settlement_index>().indices().get<by_account>().equal_range(account->id);
-      std::for_each(settle_range.first, settle_range.second,
-                    [&acnt](const force_settlement_object &settle) {
-                       acnt.settle_orders.emplace_back(settle);
-                    });
+full_account database_api_impl::build_full_account(const account_object &account, std::map<account_id_type, string> &names) const {
+   auto get_name = [this, &names](account_id_type id) -> const string & {
+      auto itr = names.find(id);
+      if (itr == names.end())
+         itr = names.emplace(id, id(_db).name).first;
+      return itr->second;
+   };
 
-      // get assets issued by user
-      auto asset_range = _db.get_index_type<asset_index>().indices().get<by_issuer>().equal_range(account->id);
-      std::for_each(asset_range.first, asset_range.second,
-                    [&acnt](const asset_object &asset) {
-                       acnt.assets.emplace_back(asset.id);
-                    });
+   full_account acnt;
+   acnt.account = account;
+   acnt.statistics = account.statistics(_db);
+   acnt.registrar_name = get_name(account.registrar);
+   acnt.referrer_name = get_name(account.referrer);
+   acnt.lifetime_referrer_name = get_name(account.lifetime_referrer);
 
-      // get withdraws permissions
-      auto withdraw_range = _db.get_index_type<withdraw_permission_index>().indices().get<by_from>().equal_range(account->id);
-      std::for_each(withdraw_range.first, withdraw_range.second,
-                    [&acnt](const withdraw_permission_object &withdraw) {
-                       acnt.withdraws.emplace_back(withdraw);
-                    });
+   if (account.cashback_vb) {
+      acnt.cashback_balance = account.cashback_balance(_db);
+   }
 
-      auto pending_payouts_range =
-            _db.get_index_type<pending_dividend_payout_balance_for_holder_object_index>().indices().get<by_account_dividend_payout>().equal_range(boost::make_tuple(account->id));
+   // Add the account's balances
+   const auto &balances = _db.get_index_type<primary_index<account_balance_index>>().get_secondary_index<balances_by_account_index>().get_account_balances(account.id);
+   for (const auto balance : balances)
+      acnt.balances.emplace_back(*balance.second);
 
-      std::copy(pending_payouts_range.first, pending_payouts_range.second, std::back_inserter(acnt.pending_dividend_payments));
+   // Add the account's vesting balances
+   auto vesting_range = _db.get_index_type<vesting_balance_index>().indices().get<by_account>().equal_range(account.id);
+   std::for_each(vesting_range.first, vesting_range.second,
+                 [&acnt](const vesting_balance_object &balance) {
+                    acnt.vesting_balances.emplace_back(balance);
+                 });
 
-      results[account_name_or_id] = acnt;
-   }
-   return results;
+   // Add the account's orders
+   auto order_range = _db.get_index_type<limit_order_index>().indices().get<by_account>().equal_range(account.id);
+   std::for_each(order_range.first, order_range.second,
+                 [&acnt](const limit_order_object &order) {
+                    acnt.limit_orders.emplace_back(order);
+                 });
+   auto call_range = _db.get_index_type<call_order_index>().indices().get<by_account>().equal_range(account.id);
+   std::for_each(call_range.first, call_range.second,
+                 [&acnt](const call_order_object &call) {
+                    acnt.call_orders.emplace_back(call);
+                 });
+   auto settle_range = _db.get_index_type<force_settlement_index>().indices().get<by_account>().equal_range(account.id);
+   std::for_each(settle_range.first, settle_range.second,
+                 [&acnt](const force_settlement_object &settle) {
+                    acnt.settle_orders.emplace_back(settle);
+                 });
+
+   // get assets issued by user
+   auto asset_range = _db.get_index_type<asset_index>().indices().get<by_issuer>().equal_range(account.id);
+   std::for_each(asset_range.first, asset_range.second,
+                 [&acnt](const asset_object &asset) {
+                    acnt.assets.emplace_back(asset.id);
+                 });
+
+   // get withdraws permissions
+   auto withdraw_range = _db.get_index_type<withdraw_permission_index>().indices().get<by_from>().equal_range(account.id);
+   std::for_each(withdraw_range.first, withdraw_range.second,
+                 [&acnt](const withdraw_permission_object &withdraw) {
+                    acnt.withdraws.emplace_back(withdraw);
+                 });
+
+   auto pending_payouts_range =
+         _db.get_index_type<pending_dividend_payout_balance_for_holder_object_index>().indices().get<by_account_dividend_payout>().equal_range(boost::make_tuple(account.id));
+
+   std::copy(pending_payouts_range.first, pending_payouts_range.second, std::back_inserter(acnt.pending_dividend_payments));
+
+   return acnt;
 }
 
 optional<account_object> database_api::get_account_by_name(string name) const {
@@ -919,7 +1319,7 @@ vector<balance_object> database_api_impl::get_balance_objects(const vector<addre
       vector<balance_object> result;
 
       for (const auto &owner : addrs) {
-         subscribe_to_item(owner);
+         subscribe_to_address(owner);
          auto itr = by_owner_idx.lower_bound(boost::make_tuple(owner, asset_id_type(0)));
          while (itr != by_owner_idx.end() && itr->owner == owner) {
             result.push_back(*itr);
@@ -2432,7 +2832,7 @@ uint64_t database_api::nft_get_balance(const account_id_type owner) const {
 uint64_t database_api_impl::nft_get_balance(const account_id_type owner) const {
    const auto &idx_nft = _db.get_index_type<nft_index>().indices().get<by_owner>();
    const auto &idx_nft_range = idx_nft.equal_range(owner);
-   return std::distance(idx_nft_range.first, idx_nft_range.second);
+   return idx_nft.rank(idx_nft_range.second) - idx_nft.rank(idx_nft_range.first);
 }
 
 optional<account_id_type> database_api::nft_owner_of(const nft_id_type token_id) const {
@@ -2539,13 +2939,9 @@ nft_object database_api::nft_token_by_index(const nft_metadata_id_type nft_metad
 nft_object database_api_impl::nft_token_by_index(const nft_metadata_id_type nft_metadata_id, const uint64_t token_idx) const {
    const auto &idx_nft = _db.get_index_type<nft_index>().indices().get<by_metadata>();
    auto idx_nft_range = idx_nft.equal_range(nft_metadata_id);
-   uint64_t tmp_idx = token_idx;
-   for (auto itr = idx_nft_range.first; itr != idx_nft_range.second; ++itr) {
-      if (tmp_idx == 0) {
-         return *itr;
-      }
-      tmp_idx = tmp_idx - 1;
-   }
+   const uint64_t first_rank = idx_nft.rank(idx_nft_range.first);
+   if (token_idx < idx_nft.rank(idx_nft_range.second) - first_rank)
+      return *idx_nft.nth(first_rank + token_idx);
    return {};
 }
 
@@ -2556,13 +2952,9 @@ nft_object database_api::nft_token_of_owner_by_index(const nft_metadata_id_type
 nft_object database_api_impl::nft_token_of_owner_by_index(const nft_metadata_id_type nft_metadata_id, const account_id_type owner, const uint64_t token_idx) const {
    const auto &idx_nft = _db.get_index_type<nft_index>().indices().get<by_metadata_and_owner>();
    auto idx_nft_range = idx_nft.equal_range(std::make_tuple(nft_metadata_id, owner));
-   uint64_t tmp_idx = token_idx;
-   for (auto itr = idx_nft_range.first; itr != idx_nft_range.second; ++itr) {
-      if (tmp_idx == 0) {
-         return *itr;
-      }
-      tmp_idx = tmp_idx - 1;
-   }
+   const uint64_t first_rank = idx_nft.rank(idx_nft_range.first);
+   if (token_idx < idx_nft.rank(idx_nft_range.second) - first_rank)
+      return *idx_nft.nth(first_rank + token_idx);
    return {};
 }
 
@@ -2593,6 +2985,44 @@ vector<nft_object> database_api_impl::nft_get_tokens_by_owner(const account_id_t
    return result;
 }
 
+vector<nft_object> database_api::nft_list_tokens(const nft_id_type lower_id, uint32_t limit) const {
+   return my->nft_list_tokens(lower_id, limit);
+}
+
+vector<nft_object> database_api_impl::nft_list_tokens(const nft_id_type lower_id, uint32_t limit) const {
+   FC_ASSERT(limit <= api_limit_nft_list_tokens,
+             "Number of querying NFTs can not be greater than ${configured_limit}",
+             ("configured_limit", api_limit_nft_list_tokens));
+   const auto &idx_nft = _db.get_index_type<nft_index>().indices().get<by_id>();
+   vector<nft_object> result;
+   result.reserve(limit);
+
+   auto itr = idx_nft.lower_bound(lower_id);
+   while (limit-- && itr != idx_nft.end())
+      result.emplace_back(*itr++);
+
+   return result;
+}
+
+vector<nft_object> database_api::nft_list_tokens_by_owner(const account_id_type owner, const nft_id_type lower_id, uint32_t limit) const {
+   return my->nft_list_tokens_by_owner(owner, lower_id, limit);
+}
+
+vector<nft_object> database_api_impl::nft_list_tokens_by_owner(const account_id_type owner, const nft_id_type lower_id, uint32_t limit) const {
+   FC_ASSERT(limit <= api_limit_nft_list_tokens,
+             "Number of querying NFTs can not be greater than ${configured_limit}",
+             ("configured_limit", api_limit_nft_list_tokens));
+   const auto &idx_nft = _db.get_index_type<nft_index>().indices().get<by_owner_and_id>();
+   vector<nft_object> result;
+   result.reserve(limit);
+
+   auto itr = idx_nft.lower_bound(boost::make_tuple(owner, object_id_type(lower_id)));
+   while (limit-- && itr != idx_nft.end() && itr->owner == owner)
+      result.emplace_back(*itr++);
+
+   return result;
+}
+
 vector<custom_account_authority_object> database_api::get_custom_account_authorities(const account_id_type account) const {
    return my->get_custom_account_authorities(account);
 }
@@ -2882,16 +3312,6 @@ vector<account_role_object> database_api_impl::get_account_roles_by_owner(accoun
 //                                                                  //
 //////////////////////////////////////////////////////////////////////
 
-void database_api_impl::broadcast_updates(const vector<variant> &updates) {
-   if (updates.size() && _subscribe_callback) {
-      auto capture_this = shared_from_this();
-      fc::async([capture_this, updates]() {
-         if (capture_this->_subscribe_callback)
-            capture_this->_subscribe_callback(fc::variant(updates));
-      });
-   }
-}
-
 void database_api_impl::broadcast_market_updates(const market_queue_type &queue) {
    if (queue.size()) {
       auto capture_this = shared_from_this();
@@ -2905,8 +3325,8 @@ void database_api_impl::broadcast_market_updates(const market_queue_type &queue)
    }
 }
 
-void database_api_impl::on_objects_removed(const vector<object_id_type> &ids, const vector<const object *> &objs, const flat_set<account_id_type> &impacted_accounts) {
-   handle_object_changed(_notify_remove_create, false, ids, impacted_accounts,
+void database_api_impl::on_objects_removed(const vector<object_id_type> &ids, const vector<const object *> &objs) {
+   handle_object_changed(false, ids,
                          [objs](object_id_type id) -> const object * {
                             auto it = std::find_if(
                                   objs.begin(), objs.end(),
@@ -2921,36 +3341,17 @@ void database_api_impl::on_objects_removed(const vector<object_id_type> &ids, co
                          });
 }
 
-void database_api_impl::on_objects_new(const vector<object_id_type> &ids, const flat_set<account_id_type> &impacted_accounts) {
-   handle_object_changed(_notify_remove_create, true, ids, impacted_accounts,
+void database_api_impl::on_objects_new(const vector<object_id_type> &ids) {
+   handle_object_changed(true, ids,
                          std::bind(&object_database::find_object, &_db, std::placeholders::_1));
 }
 
-void database_api_impl::on_objects_changed(const vector<object_id_type> &ids, const flat_set<account_id_type> &impacted_accounts) {
-   handle_object_changed(false, true, ids, impacted_accounts,
+void database_api_impl::on_objects_changed(const vector<object_id_type> &ids) {
+   handle_object_changed(true, ids,
                          std::bind(&object_database::find_object, &_db, std::placeholders::_1));
 }
 
-void database_api_impl::handle_object_changed(bool force_notify, bool full_object, const vector<object_id_type> &ids, const flat_set<account_id_type> &impacted_accounts, std::function<const object *(object_id_type id)> find_object) {
-   if (_subscribe_callback) {
-      vector<variant> updates;
-
-      for (auto id : ids) {
-         if (force_notify || is_subscribed_to_item(id) || is_impacted_account(impacted_accounts)) {
-            if (full_object) {
-               auto obj = find_object(id);
-               if (obj) {
-                  updates.emplace_back(obj->to_variant());
-               }
-            } else {
-               updates.emplace_back(fc::variant(id, 1));
-            }
-         }
-      }
-
-      broadcast_updates(updates);
-   }
-
+void database_api_impl::handle_object_changed(bool full_object, const vector<object_id_type> &ids, std::function<const object *(object_id_type id)> find_object) {
    if (_market_subscriptions.size()) {
       market_queue_type broadcast_queue;
       /// pushing the future back / popping the prior future if it is complete.
@@ -94,7 +94,7 @@ class history_api {
 public:
    history_api(application &app) :
          _app(app),
-         database_api(std::ref(*app.chain_database())) {
+         database_api(std::ref(*app.chain_database()), app.database_api_state()) {
    }
 
    /**
@@ -334,6 +334,17 @@ public:
           */
    vector<account_asset_balance> get_asset_holders(std::string asset, uint32_t start, uint32_t limit) const;
 
+   /**
+          * @brief Page through the holders of an asset, largest balance first
+          * @param asset The specific asset id or symbol
+          * @param last The last holder of the previous page, or null for the first page
+          * @param limit Maximum limit must not exceed 100
+          * @return Up to limit holders following last, ordered by descending amount then account id
+          *
+          * Unlike get_asset_holders, the cost of a page does not grow with its position in the listing.
+          */
+   vector<account_asset_balance> list_asset_holders(std::string asset, optional<account_asset_balance> last, uint32_t limit) const;
+
    /**
           * @brief Get asset holders count for a specific asset
           * @param asset The specific asset id or symbol
@@ -484,6 +495,7 @@ FC_API(graphene::app::crypto_api,
 
 FC_API(graphene::app::asset_api,
       (get_asset_holders)
+      (list_asset_holders)
       (get_asset_holders_count)
       (get_all_asset_holders))
 
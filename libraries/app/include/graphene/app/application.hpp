@@ -36,6 +36,7 @@ class application_impl;
 using std::string;
 
 class abstract_plugin;
+class database_api_shared_state;
 
 class application {
 public:
@@ -83,6 +84,8 @@ public:
 
    net::node_ptr p2p_node();
    std::shared_ptr<chain::database> chain_database() const;
+   /// Shared by the database_api instances of all connections
+   std::shared_ptr<database_api_shared_state> database_api_state() const;
 
    void set_block_production(bool producing_blocks);
    fc::optional<api_access_info> get_api_access_info(const string &username) const;
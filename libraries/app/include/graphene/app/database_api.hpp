@@ -80,6 +80,13 @@ using namespace std;
 
 class database_api_impl;
 
+/**
+ * The object subscriptions and the cached full accounts, shared by every database_api of one database. The owner
+ * of the database owns it as well, see application::database_api_state(), and must destroy it first.
+ */
+class database_api_shared_state;
+std::shared_ptr<database_api_shared_state> make_database_api_shared_state(graphene::chain::database &db);
+
 struct order {
    double price;
    double quote;
@@ -137,7 +144,8 @@ struct gpos_info {
  */
 class database_api {
 public:
-   database_api(graphene::chain::database &db);
+   /// Without @p shared_state the database_api gets a subscription registry and full account cache of its own
+   database_api(graphene::chain::database &db, std::shared_ptr<database_api_shared_state> shared_state = nullptr);
    ~database_api();
 
    /////////////
@@ -914,6 +922,23 @@ public:
     */
    vector<nft_object> nft_get_tokens_by_owner(const account_id_type owner) const;
 
+   /**
+    * @brief Returns a page of all NFT's, in id order
+    * @param lower_id ID of the first NFT to return
+    * @param limit Maximum number of NFT's to return, must not exceed 100
+    * @return List of NFT's starting at lower_id
+    */
+   vector<nft_object> nft_list_tokens(const nft_id_type lower_id, uint32_t limit) const;
+
+   /**
+    * @brief Returns a page of the NFT's owned by owner, in id order
+    * @param owner NFT owner
+    * @param lower_id ID of the first NFT to return
+    * @param limit Maximum number of NFT's to return, must not exceed 100
+    * @return List of NFT's owned by owner starting at lower_id
+    */
+   vector<nft_object> nft_list_tokens_by_owner(const account_id_type owner, const nft_id_type lower_id, uint32_t limit) const;
+
    //////////////////
    // MARKET PLACE //
    //////////////////
@@ -1111,6 +1136,8 @@ FC_API(graphene::app::database_api,
    (nft_token_of_owner_by_index)
    (nft_get_all_tokens)
    (nft_get_tokens_by_owner)
+   (nft_list_tokens)
+   (nft_list_tokens_by_owner)
 
    // Marketplace
    (list_offers)
@@ -24,9 +24,13 @@
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/database.hpp>
 
+#include <fc/crypto/city.hpp>
+#include <fc/crypto/rand.hpp>
 #include <fc/io/raw.hpp>
 #include <fc/uint128.hpp>
 
+#include <cstring>
+
 namespace graphene { namespace chain {
 
 share_type cut_fee(share_type a, uint16_t p)
@@ -112,34 +116,112 @@ void account_statistics_object::pay_fee( share_type core_fee, share_type cashbac
       pending_vested_fees += core_fee;
 }
 
-set<account_id_type> account_member_index::get_account_members(const account_object& a)const
+namespace {
+
+template< typename T, typename Compare = std::less<T> >
+void sort_unique( vector<T>& v, Compare comp = Compare() )
 {
-   set<account_id_type> result;
-   for( auto auth : a.owner.account_auths )
-      result.insert(auth.first);
-   for( auto auth : a.active.account_auths )
-      result.insert(auth.first);
-   return result;
+   std::sort( v.begin(), v.end(), comp );
+   v.erase( std::unique( v.begin(), v.end(), [&comp]( const T& a, const T& b ) { return !comp( a, b ) && !comp( b, a ); } ),
+            v.end() );
 }
-set<public_key_type, account_member_index::key_compare> account_member_index::get_key_members(const account_object& a)const
+
+/**
+ * Walks two sorted member lists and only touches the map entries of members that were removed or added.
+ * Entries left without any account are erased.
+ */
+template< typename Map, typename T, typename Compare = std::less<T> >
+void update_memberships( Map& memberships, const vector<T>& before, const vector<T>& after,
+                         account_id_type account, Compare comp = Compare() )
 {
-   set<public_key_type, key_compare> result;
-   for( auto auth : a.owner.key_auths )
-      result.insert(auth.first);
-   for( auto auth : a.active.key_auths )
-      result.insert(auth.first);
-   result.insert( a.options.memo_key );
-   return result;
+   auto remove = [&]( const T& item ) {
+      auto itr = memberships.find( item );
+      if( itr == memberships.end() )
+         return;
+      itr->second.erase( account );
+      if( itr->second.empty() )
+         memberships.erase( itr );
+   };
+   auto add = [&]( const T& item ) {
+      memberships[item].insert( account );
+   };
+
+   auto b = before.begin();
+   auto a = after.begin();
+   while( b != before.end() && a != after.end() )
+   {
+      if( comp( *b, *a ) )
+         remove( *b++ );
+      else if( comp( *a, *b ) )
+         add( *a++ );
+      else
+         ++b, ++a;
+   }
+   for( ; b != before.end(); ++b )
+      remove( *b );
+   for( ; a != after.end(); ++a )
+      add( *a );
 }
-set<address> account_member_index::get_address_members(const account_object& a)const
+
+/** Hashes the seed followed by the data, the seed being drawn once per process */
+template< size_t Size >
+size_t seeded_hash( const char* data )
 {
-   set<address> result;
-   for( auto auth : a.owner.address_auths )
-      result.insert(auth.first);
-   for( auto auth : a.active.address_auths )
-      result.insert(auth.first);
-   result.insert( a.options.memo_key );
-   return result;
+   static const uint64_t seed = []() {
+      uint64_t result;
+      fc::rand_bytes( reinterpret_cast<char*>( &result ), sizeof(result) );
+      return result;
+   }();
+
+   char buffer[sizeof(seed) + Size];
+   memcpy( buffer, &seed, sizeof(seed) );
+   memcpy( buffer + sizeof(seed), data, Size );
+   return fc::city_hash_size_t( buffer, sizeof(buffer) );
+}
+
+} // anonymous namespace
+
+size_t account_member_index::key_hash::operator()( const public_key_type& k )const
+{
+   return seeded_hash< sizeof(k.key_data) >( reinterpret_cast<const char*>( k.key_data.data() ) );
+}
+
+size_t account_member_index::address_hash::operator()( const address& a )const
+{
+   return seeded_hash< sizeof(a.addr) >( a.addr.data() );
+}
+
+void account_member_index::get_account_members( const account_object& a, vector<account_id_type>& result )const
+{
+   result.clear();
+   result.reserve( a.owner.account_auths.size() + a.active.account_auths.size() );
+   for( const auto& auth : a.owner.account_auths )
+      result.push_back( auth.first );
+   for( const auto& auth : a.active.account_auths )
+      result.push_back( auth.first );
+   sort_unique( result );
+}
+void account_member_index::get_key_members( const account_object& a, vector<public_key_type>& result )const
+{
+   result.clear();
+   result.reserve( a.owner.key_auths.size() + a.active.key_auths.size() + 1 );
+   for( const auto& auth : a.owner.key_auths )
+      result.push_back( auth.first );
+   for( const auto& auth : a.active.key_auths )
+      result.push_back( auth.first );
+   result.push_back( a.options.memo_key );
+   sort_unique( result, key_compare() );
+}
+void account_member_index::get_address_members( const account_object& a, vector<address>& result )const
+{
+   result.clear();
+   result.reserve( a.owner.address_auths.size() + a.active.address_auths.size() + 1 );
+   for( const auto& auth : a.owner.address_auths )
+      result.push_back( auth.first );
+   for( const auto& auth : a.active.address_auths )
+      result.push_back( auth.first );
+   result.push_back( a.options.memo_key );
+   sort_unique( result );
 }
 
 void account_member_index::object_loaded(const object& obj)
@@ -152,17 +234,21 @@ void account_member_index::object_created(const object& obj)
     assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
     const account_object& a = static_cast<const account_object&>(obj);
 
-    auto account_members = get_account_members(a);
-    for( auto item : account_members )
-       account_to_account_memberships[item].insert(obj.id);
+    const vector<account_id_type> no_accounts;
+    const vector<public_key_type> no_keys;
+    const vector<address> no_addresses;
+    vector<account_id_type> account_members;
+    vector<public_key_type> key_members;
+    vector<address> address_members;
+
+    get_account_members( a, account_members );
+    update_memberships( account_to_account_memberships, no_accounts, account_members, a.id );
 
-    auto key_members = get_key_members(a);
-    for( auto item : key_members )
-       account_to_key_memberships[item].insert(obj.id);
+    get_key_members( a, key_members );
+    update_memberships( account_to_key_memberships, no_keys, key_members, a.id, key_compare() );
 
-    auto address_members = get_address_members(a);
-    for( auto item : address_members )
-       account_to_address_memberships[item].insert(obj.id);
+    get_address_members( a, address_members );
+    update_memberships( account_to_address_memberships, no_addresses, address_members, a.id );
 }
 
 void account_member_index::object_removed(const object& obj)
@@ -170,28 +256,30 @@ void account_member_index::object_removed(const object& obj)
     assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
     const account_object& a = static_cast<const account_object&>(obj);
 
-    auto key_members = get_key_members(a);
-    for( auto item : key_members )
-       account_to_key_memberships[item].erase( obj.id );
+    const vector<account_id_type> no_accounts;
+    const vector<public_key_type> no_keys;
+    const vector<address> no_addresses;
+    vector<account_id_type> account_members;
+    vector<public_key_type> key_members;
+    vector<address> address_members;
 
-    auto address_members = get_address_members(a);
-    for( auto item : address_members )
-       account_to_address_memberships[item].erase( obj.id );
+    get_key_members( a, key_members );
+    update_memberships( account_to_key_memberships, key_members, no_keys, a.id, key_compare() );
 
-    auto account_members = get_account_members(a);
-    for( auto item : account_members )
-       account_to_account_memberships[item].erase( obj.id );
+    get_address_members( a, address_members );
+    update_memberships( account_to_address_memberships, address_members, no_addresses, a.id );
+
+    get_account_members( a, account_members );
+    update_memberships( account_to_account_memberships, account_members, no_accounts, a.id );
 }
 
 void account_member_index::about_to_modify(const object& before)
 {
-   before_key_members.clear();
-   before_account_members.clear();
    assert( dynamic_cast<const account_object*>(&before) ); // for debug only
    const account_object& a = static_cast<const account_object&>(before);
-   before_key_members     = get_key_members(a);
-   before_address_members = get_address_members(a);
-   before_account_members = get_account_members(a);
+   get_key_members( a, before_key_members );
+   get_address_members( a, before_address_members );
+   get_account_members( a, before_account_members );
 }
 
 void account_member_index::object_modified(const object& after)
@@ -199,66 +287,24 @@ void account_member_index::object_modified(const object& after)
     assert( dynamic_cast<const account_object*>(&after) ); // for debug only
     const account_object& a = static_cast<const account_object&>(after);
 
+    // most modifications do not touch the authorities, in which case the diffs below are empty
     {
-       set<account_id_type> after_account_members = get_account_members(a);
-       vector<account_id_type> removed; removed.reserve(before_account_members.size());
-       std::set_difference(before_account_members.begin(), before_account_members.end(),
-                           after_account_members.begin(), after_account_members.end(),
-                           std::inserter(removed, removed.end()));
-
-       for( auto itr = removed.begin(); itr != removed.end(); ++itr )
-          account_to_account_memberships[*itr].erase(after.id);
-
-       vector<object_id_type> added; added.reserve(after_account_members.size());
-       std::set_difference(after_account_members.begin(), after_account_members.end(),
-                           before_account_members.begin(), before_account_members.end(),
-                           std::inserter(added, added.end()));
-
-       for( auto itr = added.begin(); itr != added.end(); ++itr )
-          account_to_account_memberships[*itr].insert(after.id);
+       vector<account_id_type> after_account_members;
+       get_account_members( a, after_account_members );
+       update_memberships( account_to_account_memberships, before_account_members, after_account_members, a.id );
     }
 
-
     {
-       set<public_key_type, key_compare> after_key_members = get_key_members(a);
-
-       vector<public_key_type> removed; removed.reserve(before_key_members.size());
-       std::set_difference(before_key_members.begin(), before_key_members.end(),
-                           after_key_members.begin(), after_key_members.end(),
-                           std::inserter(removed, removed.end()));
-
-       for( auto itr = removed.begin(); itr != removed.end(); ++itr )
-          account_to_key_memberships[*itr].erase(after.id);
-
-       vector<public_key_type> added; added.reserve(after_key_members.size());
-       std::set_difference(after_key_members.begin(), after_key_members.end(),
-                           before_key_members.begin(), before_key_members.end(),
-                           std::inserter(added, added.end()));
-
-       for( auto itr = added.begin(); itr != added.end(); ++itr )
-          account_to_key_memberships[*itr].insert(after.id);
+       vector<public_key_type> after_key_members;
+       get_key_members( a, after_key_members );
+       update_memberships( account_to_key_memberships, before_key_members, after_key_members, a.id, key_compare() );
     }
 
     {
-       set<address> after_address_members = get_address_members(a);
-
-       vector<address> removed; removed.reserve(before_address_members.size());
-       std::set_difference(before_address_members.begin(), before_address_members.end(),
-                           after_address_members.begin(), after_address_members.end(),
-                           std::inserter(removed, removed.end()));
-
-       for( auto itr = removed.begin(); itr != removed.end(); ++itr )
-          account_to_address_memberships[*itr].erase(after.id);
-
-       vector<address> added; added.reserve(after_address_members.size());
-       std::set_difference(after_address_members.begin(), after_address_members.end(),
-                           before_address_members.begin(), before_address_members.end(),
-                           std::inserter(added, added.end()));
-
-       for( auto itr = added.begin(); itr != added.end(); ++itr )
-          account_to_address_memberships[*itr].insert(after.id);
+       vector<address> after_address_members;
+       get_address_members( a, after_address_members );
+       update_memberships( account_to_address_memberships, before_address_members, after_address_members, a.id );
     }
-
 }
 
 void account_referrer_index::object_loaded( const object& obj )
@@ -315,9 +361,9 @@ void balances_by_account_index::object_modified( const object& after  )
    ids_being_modified.pop();
 }
 
-const map< asset_id_type, const account_balance_object* >& balances_by_account_index::get_account_balances( const account_id_type& acct )const
+const flat_map< asset_id_type, const account_balance_object* >& balances_by_account_index::get_account_balances( const account_id_type& acct )const
 {
-   static const map< asset_id_type, const account_balance_object* > _empty;
+   static const flat_map< asset_id_type, const account_balance_object* > _empty;
 
    if( balances.size() < (acct.instance.value >> bits) + 1 ) return _empty;
    return balances[acct.instance.value >> bits][acct.instance.value & mask];
@@ -332,6 +378,30 @@ const account_balance_object* balances_by_account_index::get_account_balance( co
    return itr->second;
 }
 
+void balance_counts_by_asset_index::object_loaded( const object& obj )
+{
+   object_created(obj);
+}
+
+void balance_counts_by_asset_index::object_created( const object& obj )
+{
+   const auto& abo = dynamic_cast< const account_balance_object& >( obj );
+   ++counts[abo.asset_type].balance_objects;
+}
+
+void balance_counts_by_asset_index::object_removed( const object& obj )
+{
+   const auto& abo = dynamic_cast< const account_balance_object& >( obj );
+   --counts[abo.asset_type].balance_objects;
+}
+
+balance_counts_by_asset_index::balance_counts balance_counts_by_asset_index::get_balance_counts( const asset_id_type& asset )const
+{
+   const auto itr = counts.find( asset );
+   if( itr == counts.end() ) return balance_counts();
+   return itr->second;
+}
+
 } } // graphene::chain
 
 GRAPHENE_EXTERNAL_SERIALIZATION( /*not extern*/, graphene::chain::account_object )
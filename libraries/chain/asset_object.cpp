@@ -340,6 +340,62 @@ void sweeps_vesting_balance_object::adjust_balance( const asset& delta )
    balance += delta.amount.value;
 }
 
+void dividend_assets_index::object_loaded( const object& obj )
+{
+   object_created( obj );
+}
+
+void dividend_assets_index::object_created( const object& obj )
+{
+   const auto& a = dynamic_cast< const asset_object& >( obj );
+   if( a.dividend_data_id )
+      dividend_assets.insert( a.id );
+}
+
+void dividend_assets_index::object_removed( const object& obj )
+{
+   dividend_assets.erase( asset_id_type( obj.id ) );
+}
+
+void dividend_assets_index::object_modified( const object& after )
+{
+   const auto& a = dynamic_cast< const asset_object& >( after );
+   if( a.dividend_data_id )
+      dividend_assets.insert( a.id );
+   else
+      dividend_assets.erase( a.id );
+}
+
+void bitasset_call_limit_index::object_loaded( const object& obj )
+{
+   object_created( obj );
+}
+
+void bitasset_call_limit_index::object_created( const object& obj )
+{
+   object_modified( obj );
+}
+
+void bitasset_call_limit_index::object_removed( const object& obj )
+{
+   call_limits.erase( dynamic_cast< const asset_bitasset_data_object& >( obj ).asset_id );
+}
+
+void bitasset_call_limit_index::object_modified( const object& after )
+{
+   const auto& bitasset = dynamic_cast< const asset_bitasset_data_object& >( after );
+   if( bitasset.is_prediction_market || bitasset.has_settlement() || bitasset.current_feed.settlement_price.is_null() )
+      call_limits.erase( bitasset.asset_id );
+   else
+      call_limits[ bitasset.asset_id ] = bitasset.current_feed.max_short_squeeze_price();
+}
+
+const price* bitasset_call_limit_index::get_call_limit( asset_id_type mia )const
+{
+   auto itr = call_limits.find( mia );
+   return itr == call_limits.end() ? nullptr : &itr->second;
+}
+
 GRAPHENE_EXTERNAL_SERIALIZATION( /*not extern*/, graphene::chain::asset_dynamic_data_object )
 GRAPHENE_EXTERNAL_SERIALIZATION( /*not extern*/, graphene::chain::asset_bitasset_data_object )
 GRAPHENE_EXTERNAL_SERIALIZATION( /*not extern*/, graphene::chain::asset_dividend_data_object )
@@ -126,6 +126,9 @@ void_result betting_market_group_update_evaluator::do_evaluate(const betting_mar
    _betting_market_group = &op.betting_market_group_id(d);
 
    FC_ASSERT(op.new_description || op.new_rules_id || op.status, "nothing to change");
+   if (d.head_block_time() >= HARDFORK_BMG_SETTLEMENT_TIME)
+      FC_ASSERT(!_betting_market_group->is_settling(d.head_block_time()),
+                "Unable to update a betting market group while it is being settled");
 
    if (op.new_rules_id)
    {
@@ -209,6 +212,9 @@ void_result betting_market_create_evaluator::do_evaluate(const betting_market_cr
              "betting_market_group_id must refer to a betting_market_group_id_type");
    _group_id = resolved_betting_market_group_id;
    FC_ASSERT(db().find_object(_group_id), "Invalid betting_market_group specified");
+   if (db().head_block_time() >= HARDFORK_BMG_SETTLEMENT_TIME)
+      FC_ASSERT(!_group_id(db()).is_settling(db().head_block_time()),
+                "Unable to add a betting market to a group that is being settled");
 
    return void_result();
 } FC_CAPTURE_AND_RETHROW( (op) ) }
@@ -247,6 +253,15 @@ void_result betting_market_update_evaluator::do_evaluate(const betting_market_up
       FC_ASSERT(d.find_object(_group_id), "invalid betting_market_group specified");
    }
 
+   if (d.head_block_time() >= HARDFORK_BMG_SETTLEMENT_TIME)
+   {
+      FC_ASSERT(!_betting_market->group_id(d).is_settling(d.head_block_time()),
+                "Unable to update a betting market while its group is being settled");
+      if (op.new_group_id.valid())
+         FC_ASSERT(!_group_id(d).is_settling(d.head_block_time()),
+                   "Unable to move a betting market to a group that is being settled");
+   }
+
    return void_result();
 } FC_CAPTURE_AND_RETHROW( (op) ) }
 
@@ -284,6 +299,9 @@ void_result bet_place_evaluator::do_evaluate(const bet_place_operation& op)
               "Unable to place bets while the market is re-grading" );
    FC_ASSERT( _betting_market_group->get_status() != betting_market_group_status::settled, 
               "Unable to place bets while the market is settled" );
+   if (d.head_block_time() >= HARDFORK_BMG_SETTLEMENT_TIME)
+      FC_ASSERT( !_betting_market_group->is_settling(d.head_block_time()),
+                 "Unable to place bets while the market is being settled" );
 
    _asset = &_betting_market_group->asset_id(d);
    FC_ASSERT( is_authorized_asset( d, *fee_paying_account, *_asset ) );
@@ -383,29 +383,7 @@ betting_market_status betting_market_object::get_status() const
 
 void betting_market_object::cancel_all_unmatched_bets(database& db) const
 {
-   const auto& bet_odds_idx = db.get_index_type<bet_object_index>().indices().get<by_odds>();
-
-   // first, cancel all bets on the active books
-   auto book_itr = bet_odds_idx.lower_bound(std::make_tuple(id));
-   auto book_end = bet_odds_idx.upper_bound(std::make_tuple(id));
-   while (book_itr != book_end)
-   {
-      auto old_book_itr = book_itr;
-      ++book_itr;
-      db.cancel_bet(*old_book_itr, true);
-   }
-
-   // then, cancel any delayed bets on that market.  We don't have an index for
-   // that, so walk through all delayed bets
-   book_itr = bet_odds_idx.begin();
-   while (book_itr != bet_odds_idx.end() &&
-          book_itr->end_of_delay)
-   {
-      auto old_book_itr = book_itr;
-      ++book_itr;
-      if (old_book_itr->betting_market_id == id)
-         db.cancel_bet(*old_book_itr, true);
-   }
+   db.cancel_all_unmatched_bets_on_betting_market(*this);
 }
     
 void betting_market_object::cancel_all_bets(database& db) const
@@ -464,6 +442,104 @@ void betting_market_object::on_canceled_event(database& db)
    my->state_machine.process_event(canceled_event(db));
 }
 
+void bet_order_book_index::object_loaded( const object& obj )
+{
+   object_created( obj );
+}
+
+void bet_order_book_index::object_created( const object& obj )
+{
+   add_bet( static_cast<const bet_object&>( obj ) );
+}
+
+void bet_order_book_index::object_removed( const object& obj )
+{
+   remove_bet( static_cast<const bet_object&>( obj ) );
+}
+
+void bet_order_book_index::about_to_modify( const object& before )
+{
+   remove_bet( static_cast<const bet_object&>( before ) );
+}
+
+void bet_order_book_index::object_modified( const object& after )
+{
+   add_bet( static_cast<const bet_object&>( after ) );
+}
+
+namespace {
+   template<typename PriceLevels>
+   void add_to_price_levels( PriceLevels& levels, const bet_object& bet )
+   {
+      bet_order_book_index::price_level& level = levels[bet.backer_multiplier];
+      level.total_amount_to_bet += bet.amount_to_bet.amount;
+      level.bets.insert( bet.id );
+   }
+
+   template<typename PriceLevels>
+   void remove_from_price_levels( PriceLevels& levels, const bet_object& bet )
+   {
+      auto level_itr = levels.find( bet.backer_multiplier );
+      if( level_itr == levels.end() )
+         return;
+      if( level_itr->second.bets.erase( bet.id ) )
+         level_itr->second.total_amount_to_bet -= bet.amount_to_bet.amount;
+      if( level_itr->second.bets.empty() )
+         levels.erase( level_itr );
+   }
+}
+
+void bet_order_book_index::add_bet( const bet_object& bet )
+{
+   market_order_book& book = order_books[bet.betting_market_id];
+   if( bet.end_of_delay )
+      book.delayed_bets.insert( bet.id );
+   else if( bet.back_or_lay == bet_type::back )
+      add_to_price_levels( book.back_bets, bet );
+   else
+      add_to_price_levels( book.lay_bets, bet );
+}
+
+void bet_order_book_index::remove_bet( const bet_object& bet )
+{
+   auto book_itr = order_books.find( bet.betting_market_id );
+   if( book_itr == order_books.end() )
+      return;
+   market_order_book& book = book_itr->second;
+   if( bet.end_of_delay )
+      book.delayed_bets.erase( bet.id );
+   else if( bet.back_or_lay == bet_type::back )
+      remove_from_price_levels( book.back_bets, bet );
+   else
+      remove_from_price_levels( book.lay_bets, bet );
+   if( book.back_bets.empty() && book.lay_bets.empty() && book.delayed_bets.empty() )
+      order_books.erase( book_itr );
+}
+
+const bet_order_book_index::market_order_book* bet_order_book_index::get_order_book( betting_market_id_type betting_market_id )const
+{
+   auto book_itr = order_books.find( betting_market_id );
+   return book_itr == order_books.end() ? nullptr : &book_itr->second;
+}
+
+optional<bet_id_type> bet_order_book_index::get_best_matching_bet( betting_market_id_type betting_market_id, bet_type maker_side,
+                                                                   bet_multiplier_type taker_multiplier )const
+{
+   const market_order_book* book = get_order_book( betting_market_id );
+   if( !book )
+      return optional<bet_id_type>();
+   // a lay taker matches backs at or below its odds, a back taker matches lays at or above them
+   if( maker_side == bet_type::back )
+   {
+      if( book->back_bets.empty() || book->back_bets.begin()->first > taker_multiplier )
+         return optional<bet_id_type>();
+      return *book->back_bets.begin()->second.bets.begin();
+   }
+   if( book->lay_bets.empty() || book->lay_bets.begin()->first < taker_multiplier )
+      return optional<bet_id_type>();
+   return *book->lay_bets.begin()->second.bets.begin();
+}
+
 } } // graphene::chain
 
 namespace fc { 
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <graphene/chain/block_archive.hpp>
+#include <graphene/chain/block_database.hpp>
+
+#include <fc/compress/zlib.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/io/datastream.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/thread/parallel.hpp>
+
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace graphene { namespace chain { namespace block_archive {
+
+const uint64_t archive_magic   = 0x3176686372616b62ull; // "bkarchv1"
+const uint32_t archive_version = 1;
+const uint64_t max_chunk_size  = uint64_t(1) << 30;
+
+struct archive_header
+{
+   uint64_t magic   = archive_magic;
+   uint32_t version = archive_version;
+};
+
+struct archive_chunk_header
+{
+   uint32_t      first_block_num   = 0;
+   uint32_t      block_count       = 0;
+   block_id_type previous;            ///< id of the block before the first block of the chunk
+   block_id_type last_block_id;
+   uint64_t      uncompressed_size = 0;
+   uint64_t      compressed_size   = 0;
+   fc::sha256    checksum;            ///< hash of the compressed payload
+};
+
+} } } // graphene::chain::block_archive
+
+FC_REFLECT( graphene::chain::block_archive::archive_header, (magic)(version) )
+FC_REFLECT( graphene::chain::block_archive::archive_chunk_header,
+            (first_block_num)(block_count)(previous)(last_block_id)(uncompressed_size)(compressed_size)(checksum) )
+
+namespace graphene { namespace chain { namespace block_archive {
+
+struct archive_chunk
+{
+   archive_chunk_header  header;
+   std::string           payload;
+   vector<signed_block>  blocks;
+   vector<block_id_type> block_ids;
+};
+
+namespace {
+
+template<typename T>
+void write_packed( std::ofstream& out, const T& value )
+{
+   const vector<char> data = fc::raw::pack( value );
+   out.write( data.data(), data.size() );
+}
+
+/// Reads a fixed-size record, returning false on a clean end of file
+template<typename T>
+bool read_packed( std::ifstream& in, T& value )
+{
+   vector<char> data( fc::raw::pack_size( T() ) );
+   in.read( data.data(), data.size() );
+   if( in.gcount() == 0 && in.eof() )
+      return false;
+   FC_ASSERT( size_t( in.gcount() ) == data.size(), "Block archive is truncated" );
+   value = fc::raw::unpack<T>( data );
+   return true;
+}
+
+void compress_chunk( archive_chunk& chunk )
+{
+   fc::datastream<size_t> size_stream;
+   for( const signed_block& block : chunk.blocks )
+      fc::raw::pack( size_stream, block );
+   std::string data( size_stream.tellp(), '\0' );
+   fc::datastream<char*> ds( &data[0], data.size() );
+   for( const signed_block& block : chunk.blocks )
+      fc::raw::pack( ds, block );
+
+   chunk.payload = fc::zlib_compress( data );
+   chunk.header.uncompressed_size = data.size();
+   chunk.header.compressed_size = chunk.payload.size();
+   chunk.header.checksum = fc::sha256::hash( chunk.payload );
+   vector<signed_block>().swap( chunk.blocks );
+}
+
+/// Checks the chunk checksum, unpacks its blocks and checks their linkage, block numbers and merkle roots
+void verify_chunk( archive_chunk& chunk )
+{
+   const archive_chunk_header& header = chunk.header;
+   FC_ASSERT( fc::sha256::hash( chunk.payload ) == header.checksum,
+              "Checksum mismatch in chunk starting at block ${n}", ("n", header.first_block_num) );
+   const std::string data = fc::zlib_decompress( chunk.payload );
+   FC_ASSERT( data.size() == header.uncompressed_size,
+              "Size mismatch in chunk starting at block ${n}", ("n", header.first_block_num) );
+   std::string().swap( chunk.payload );
+
+   fc::datastream<const char*> ds( data.data(), data.size() );
+   chunk.blocks.resize( header.block_count );
+   chunk.block_ids.resize( header.block_count );
+   block_id_type previous = header.previous;
+   for( uint32_t i = 0; i < header.block_count; ++i )
+   {
+      const uint32_t block_num = header.first_block_num + i;
+      signed_block& block = chunk.blocks[i];
+      fc::raw::unpack( ds, block );
+      FC_ASSERT( block.previous == previous, "Block ${n} does not link to its predecessor", ("n", block_num) );
+      FC_ASSERT( block.block_num() == block_num, "Block ${n} is out of sequence", ("n", block_num) );
+      FC_ASSERT( block.transaction_merkle_root == block.calculate_merkle_root(),
+                 "Merkle root mismatch in block ${n}", ("n", block_num) );
+      previous = chunk.block_ids[i] = block.id();
+   }
+   FC_ASSERT( ds.remaining() == 0, "Trailing data in chunk starting at block ${n}", ("n", header.first_block_num) );
+   FC_ASSERT( previous == header.last_block_id,
+              "Last block id mismatch in chunk starting at block ${n}", ("n", header.first_block_num) );
+}
+
+bool read_chunk( std::ifstream& in, archive_chunk& chunk )
+{
+   if( !read_packed( in, chunk.header ) )
+      return false;
+   FC_ASSERT( chunk.header.block_count > 0 && chunk.header.compressed_size <= max_chunk_size
+              && chunk.header.uncompressed_size <= max_chunk_size,
+              "Corrupt chunk header at block ${n}", ("n", chunk.header.first_block_num) );
+   chunk.payload.resize( chunk.header.compressed_size );
+   in.read( &chunk.payload[0], chunk.payload.size() );
+   FC_ASSERT( uint64_t( in.gcount() ) == chunk.header.compressed_size, "Block archive is truncated" );
+   return true;
+}
+
+/// Streams the archive in batches of chunks_in_parallel chunks, verifying each batch in parallel before passing it on
+/// @return the number of the last block in the archive
+uint32_t read_archive( const fc::path& archive_path, uint32_t chunks_in_parallel,
+                       const std::function<void( const archive_chunk& )>& consume )
+{
+   std::ifstream in( archive_path.generic_string().c_str(), std::ios::binary );
+   FC_ASSERT( in.is_open(), "Unable to open ${f}", ("f", archive_path) );
+   archive_header header;
+   FC_ASSERT( read_packed( in, header ) && header.magic == archive_magic, "${f} is not a block archive", ("f", archive_path) );
+   FC_ASSERT( header.version == archive_version, "Unsupported block archive version ${v}", ("v", header.version) );
+
+   optional<archive_chunk_header> prior;
+   bool at_end = false;
+   while( !at_end )
+   {
+      vector<archive_chunk> batch;
+      while( batch.size() < chunks_in_parallel )
+      {
+         archive_chunk chunk;
+         if( !read_chunk( in, chunk ) )
+         {
+            at_end = true;
+            break;
+         }
+         batch.push_back( std::move( chunk ) );
+      }
+      fc::parallel_for_ranges( batch.size(), 1, [&batch]( size_t, size_t begin, size_t end ) {
+         for( size_t i = begin; i < end; ++i )
+            verify_chunk( batch[i] );
+      });
+      for( const archive_chunk& chunk : batch )
+      {
+         if( prior.valid() )
+            FC_ASSERT( chunk.header.previous == prior->last_block_id
+                       && chunk.header.first_block_num == prior->first_block_num + prior->block_count,
+                       "Chunk starting at block ${n} does not follow the previous chunk", ("n", chunk.header.first_block_num) );
+         prior = chunk.header;
+         consume( chunk );
+      }
+      if( prior.valid() )
+         ilog( "Verified blocks up to ${n}", ("n", prior->first_block_num + prior->block_count - 1) );
+   }
+   FC_ASSERT( prior.valid(), "${f} holds no blocks", ("f", archive_path) );
+   return prior->first_block_num + prior->block_count - 1;
+}
+
+} // anonymous namespace
+
+void export_blocks( const fc::path& blocks_dir, const fc::path& archive_path,
+                    uint32_t first_block, uint32_t last_block, uint32_t blocks_per_chunk, uint32_t chunks_in_parallel )
+{
+   FC_ASSERT( fc::exists( blocks_dir / "index" ), "No block database in ${d}", ("d", blocks_dir) );
+   block_database blocks;
+   blocks.open( blocks_dir );
+   const optional<block_id_type> head_id = blocks.last_id();
+   FC_ASSERT( head_id.valid(), "No blocks in ${d}", ("d", blocks_dir) );
+   const uint32_t head_num = block_header::num_from_id( *head_id );
+   if( last_block == 0 || last_block > head_num )
+      last_block = head_num;
+   FC_ASSERT( first_block >= 1 && first_block <= last_block,
+              "Invalid block range ${f}-${l}", ("f", first_block)("l", last_block) );
+
+   std::ofstream out( archive_path.generic_string().c_str(), std::ios::binary | std::ios::trunc );
+   out.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+   write_packed( out, archive_header() );
+
+   uint64_t bytes_written = 0;
+   uint64_t next_block = first_block;
+   while( next_block <= last_block )
+   {
+      // Blocks are read serially, chunks are packed and compressed in parallel and written in order
+      vector<archive_chunk> batch;
+      while( batch.size() < chunks_in_parallel && next_block <= last_block )
+      {
+         archive_chunk chunk;
+         chunk.header.first_block_num = next_block;
+         chunk.header.block_count = std::min<uint64_t>( blocks_per_chunk, last_block - next_block + 1 );
+         chunk.blocks.reserve( chunk.header.block_count );
+         for( uint32_t i = 0; i < chunk.header.block_count; ++i, ++next_block )
+         {
+            optional<signed_block> block = blocks.fetch_by_number( next_block );
+            FC_ASSERT( block.valid(), "Block ${n} is missing from the block database", ("n", next_block) );
+            chunk.blocks.push_back( std::move( *block ) );
+         }
+         chunk.header.previous = chunk.blocks.front().previous;
+         chunk.header.last_block_id = blocks.fetch_block_id( next_block - 1 );
+         batch.push_back( std::move( chunk ) );
+      }
+      fc::parallel_for_ranges( batch.size(), 1, [&batch]( size_t, size_t begin, size_t end ) {
+         for( size_t i = begin; i < end; ++i )
+            compress_chunk( batch[i] );
+      });
+      for( const archive_chunk& chunk : batch )
+      {
+         write_packed( out, chunk.header );
+         out.write( chunk.payload.data(), chunk.payload.size() );
+         bytes_written += chunk.payload.size();
+      }
+      ilog( "Exported blocks ${f}-${l} (${m} MiB)", ("f", first_block)("l", next_block - 1)("m", bytes_written / (1024 * 1024)) );
+   }
+   out.close();
+   blocks.close();
+}
+
+uint32_t verify_archive( const fc::path& archive_path, uint32_t chunks_in_parallel )
+{
+   return read_archive( archive_path, chunks_in_parallel, []( const archive_chunk& ) {} );
+}
+
+uint32_t import_blocks( const fc::path& blocks_dir, const fc::path& archive_path, uint32_t chunks_in_parallel )
+{
+   block_database blocks;
+   blocks.open( blocks_dir );
+   const optional<block_id_type> existing_head = blocks.last_id();
+   block_id_type head_id = existing_head.valid() ? *existing_head : block_id_type();
+   uint32_t head_num = block_header::num_from_id( head_id );
+
+   read_archive( archive_path, chunks_in_parallel, [&blocks, &head_id, &head_num]( const archive_chunk& chunk ) {
+      for( uint32_t i = 0; i < chunk.header.block_count; ++i )
+      {
+         const uint32_t block_num = chunk.header.first_block_num + i;
+         if( block_num < head_num )
+            continue;
+         if( block_num == head_num )
+         {
+            FC_ASSERT( chunk.block_ids[i] == head_id, "Block ${n} in the archive is on a different fork", ("n", block_num) );
+            continue;
+         }
+         FC_ASSERT( chunk.blocks[i].previous == head_id,
+                    "Block ${n} does not extend the blocks already in the database", ("n", block_num) );
+         blocks.store( chunk.block_ids[i], chunk.blocks[i] );
+         head_id = chunk.block_ids[i];
+         head_num = block_num;
+      }
+   });
+
+   blocks.flush();
+   blocks.close();
+   return head_num;
+}
+
+} } } // graphene::chain::block_archive
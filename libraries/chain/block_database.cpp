@@ -23,8 +23,13 @@
  */
 #include <graphene/chain/block_database.hpp>
 #include <graphene/protocol/fee_schedule.hpp>
+#include <fc/compress/zlib.hpp>
+#include <fc/io/fstream.hpp>
 #include <fc/io/raw.hpp>
 
+#include <chrono>
+#include <cstdio>
+
 namespace graphene { namespace chain {
 
 struct index_entry
@@ -38,42 +43,361 @@ FC_REFLECT( graphene::chain::index_entry, (block_pos)(block_size)(block_id) );
 
 namespace graphene { namespace chain {
 
-void block_database::open( const fc::path& dbdir )
+/**
+ * A compressed segment file is the zlib compression of this header followed by the payload it describes.
+ */
+struct compressed_segment_header
+{
+   uint32_t                                first_block_num = 0;
+   /// offset in the payload and size of each block of the segment, size 0 if the block is absent
+   vector<std::pair<uint64_t, uint32_t>>   blocks;
+};
+
+} }
+FC_REFLECT( graphene::chain::compressed_segment_header, (first_block_num)(blocks) );
+
+namespace graphene { namespace chain {
+
+namespace {
+
+   const uint32_t blocks_per_segment   = 10000;
+   /// set in index_entry::block_pos of blocks stored in a segment file rather than the legacy blocks file
+   const uint64_t segment_storage_flag = uint64_t(1) << 63;
+
+   fc::path segment_filename( const fc::path& segments_dir, uint32_t segment, bool compressed )
+   {
+      char name[32];
+      snprintf( name, sizeof(name), "%08u.%s", segment, compressed ? "zblocks" : "blocks" );
+      return segments_dir / name;
+   }
+
+   /**
+    * Builds the compressed file for a segment from the blocks its index entries currently point to.
+    * Runs on a background thread, so it only uses its own streams; the segment's blocks are irreversible,
+    * so neither their index entries nor their data change while it runs.
+    */
+   void write_compressed_segment( const fc::path& index_filename, const fc::path& legacy_filename,
+                                  const fc::path& plain_filename, const fc::path& compressed_filename,
+                                  uint32_t first_block_num )
+   { try {
+      std::ifstream index( index_filename.generic_string().c_str(), std::ios::binary );
+      std::ifstream legacy_blocks( legacy_filename.generic_string().c_str(), std::ios::binary );
+      std::ifstream plain_blocks( plain_filename.generic_string().c_str(), std::ios::binary );
+
+      compressed_segment_header header;
+      header.first_block_num = first_block_num;
+      header.blocks.resize( blocks_per_segment );
+      std::string payload;
+      for( uint32_t i = 0; i < blocks_per_segment; ++i )
+      {
+         index_entry e;
+         index.seekg( sizeof(e) * (uint64_t(first_block_num) + i) );
+         index.read( (char*)&e, sizeof(e) );
+         if( index.gcount() != sizeof(e) )
+            break;
+         if( e.block_size == 0 )
+            continue;
+
+         std::ifstream& source = (e.block_pos & segment_storage_flag) ? plain_blocks : legacy_blocks;
+         vector<char> data( e.block_size );
+         source.clear();
+         source.seekg( e.block_pos & ~segment_storage_flag );
+         source.read( data.data(), e.block_size );
+         FC_ASSERT( source.gcount() == e.block_size, "Block ${n} is truncated", ("n", first_block_num + i) );
+         FC_ASSERT( fc::raw::unpack<signed_block>( data ).id() == e.block_id,
+                    "Block ${n} does not match its index entry", ("n", first_block_num + i) );
+         header.blocks[i] = std::make_pair( uint64_t( payload.size() ), e.block_size );
+         payload.append( data.data(), data.size() );
+      }
+
+      const vector<char> packed_header = fc::raw::pack( header );
+      std::string contents( packed_header.begin(), packed_header.end() );
+      contents += payload;
+      const std::string compressed = fc::zlib_compress( contents );
+
+      const fc::path temp_filename = compressed_filename.generic_string() + ".tmp";
+      {
+         std::ofstream out( temp_filename.generic_string().c_str(), std::ios::binary | std::ios::trunc );
+         out.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+         out.write( compressed.data(), compressed.size() );
+      }
+      fc::rename( temp_filename, compressed_filename );
+   } FC_CAPTURE_AND_RETHROW( (compressed_filename) ) }
+
+}
+
+void block_database::open( const fc::path& dbdir, bool segment_storage )
 { try {
    fc::create_directories(dbdir);
    _block_num_to_pos.exceptions(std::ios_base::failbit | std::ios_base::badbit);
    _blocks.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+   _segment_blocks.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+   _read_segment_blocks.exceptions(std::ios_base::failbit | std::ios_base::badbit);
 
    _index_filename = dbdir / "index";
+   _blocks_filename = dbdir / "blocks";
+   _segments_dir = dbdir / "segments";
+   _segment_storage = segment_storage;
+   _compaction_enabled = segment_storage;
+   _compressed_segments = 0;
+   _legacy_block_count.reset();
+
    if( !fc::exists( _index_filename ) )
    {
      _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
-     _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
+     if( fc::exists( _segments_dir ) )
+        fc::remove_all( _segments_dir );
+     if( segment_storage )
+        fc::remove( _blocks_filename );
+     else
+        _blocks.open( _blocks_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
    }
    else
    {
      _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
-     _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+     if( fc::exists( _blocks_filename ) )
+        _blocks.open( _blocks_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+     else if( !segment_storage )
+        _blocks.open( _blocks_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
+   }
+
+   // Segments are compressed in order, so the compressed ones are always a prefix
+   while( fc::exists( segment_filename( _segments_dir, _compressed_segments, true ) ) )
+      ++_compressed_segments;
+   if( _compressed_segments > 0 )
+      fc::remove( segment_filename( _segments_dir, _compressed_segments - 1, false ) );
+   if( fc::exists( _segments_dir ) )
+      fc::remove( segment_filename( _segments_dir, _compressed_segments, true ).generic_string() + ".tmp" );
+
+   // While segment storage is enabled nothing is added to the legacy file, so the size of the index when it
+   // was enabled bounds the block numbers the legacy file can hold
+   const fc::path legacy_marker = _segments_dir / "legacy_blocks";
+   if( segment_storage && _blocks.is_open() )
+   {
+      fc::create_directories( _segments_dir );
+      if( !fc::exists( legacy_marker ) )
+      {
+         std::ofstream marker( legacy_marker.generic_string().c_str(), std::ios::binary | std::ios::trunc );
+         const uint64_t index_entries = fc::file_size( _index_filename ) / sizeof(index_entry);
+         marker.write( (const char*)&index_entries, sizeof(index_entries) );
+      }
+      std::ifstream marker( legacy_marker.generic_string().c_str(), std::ios::binary );
+      uint64_t legacy_block_count = 0;
+      marker.read( (char*)&legacy_block_count, sizeof(legacy_block_count) );
+      FC_ASSERT( marker.gcount() == sizeof(legacy_block_count), "Corrupt ${f}", ("f", legacy_marker) );
+      _legacy_block_count = legacy_block_count;
    }
+   else if( fc::exists( legacy_marker ) )
+      fc::remove( legacy_marker );
+   else if( segment_storage )
+      fc::create_directories( _segments_dir );
 } FC_CAPTURE_AND_RETHROW( (dbdir) ) }
 
 bool block_database::is_open()const
 {
-  return _blocks.is_open();
+  return _block_num_to_pos.is_open();
 }
 
 void block_database::close()
 {
+  if( _compaction.valid() )
+  {
+     try
+     {
+        _compaction.get();
+        finish_compaction();
+     }
+     catch( const fc::exception& e )
+     {
+        elog( "Failed to compress block segment: ${e}", ("e", e.to_detail_string()) );
+     }
+  }
   _blocks.close();
   _block_num_to_pos.close();
+  if( _segment_blocks.is_open() )
+     _segment_blocks.close();
+  _segment_blocks_num.reset();
+  if( _read_segment_blocks.is_open() )
+     _read_segment_blocks.close();
+  _read_segment_blocks_num.reset();
+  _cached_segment_num.reset();
+  _cached_segment_blocks.clear();
+  _cached_segment_payload.clear();
 }
 
 void block_database::flush()
 {
-  _blocks.flush();
+  if( _blocks.is_open() )
+     _blocks.flush();
+  if( _segment_blocks.is_open() )
+     _segment_blocks.flush();
   _block_num_to_pos.flush();
 }
 
+std::fstream& block_database::segment_blocks_for_write( uint32_t segment )
+{
+   FC_ASSERT( segment >= _compressed_segments,
+              "Cannot store a block in segment ${s}, it is already compressed", ("s", segment) );
+   if( _segment_blocks_num.valid() && *_segment_blocks_num == segment )
+      return _segment_blocks;
+
+   if( _segment_blocks.is_open() )
+      _segment_blocks.close();
+   if( _read_segment_blocks_num.valid() && *_read_segment_blocks_num == segment )
+   {
+      _read_segment_blocks.close();
+      _read_segment_blocks_num.reset();
+   }
+   const fc::path filename = segment_filename( _segments_dir, segment, false );
+   auto mode = std::fstream::binary | std::fstream::in | std::fstream::out;
+   if( !fc::exists( filename ) )
+      mode |= std::fstream::trunc;
+   _segment_blocks.open( filename.generic_string().c_str(), mode );
+   _segment_blocks_num = segment;
+   return _segment_blocks;
+}
+
+std::istream& block_database::segment_blocks_for_read( uint32_t segment )const
+{
+   if( _segment_blocks_num.valid() && *_segment_blocks_num == segment )
+      return _segment_blocks;
+   if( !_read_segment_blocks_num.valid() || *_read_segment_blocks_num != segment )
+   {
+      if( _read_segment_blocks.is_open() )
+         _read_segment_blocks.close();
+      _read_segment_blocks_num.reset();
+      _read_segment_blocks.open( segment_filename( _segments_dir, segment, false ).generic_string().c_str(), std::ios::binary );
+      _read_segment_blocks_num = segment;
+   }
+   return _read_segment_blocks;
+}
+
+bool block_database::read_block_data( const index_entry& e, vector<char>& data )const
+{
+   if( e.block_size == 0 )
+      return false;
+
+   const uint32_t block_num = block_header::num_from_id( e.block_id );
+   const uint32_t segment = block_num / blocks_per_segment;
+   if( segment < _compressed_segments )
+      return read_compressed_block_data( segment, block_num, data );
+
+   uint64_t pos = e.block_pos;
+   std::istream* source = nullptr;
+   if( pos & segment_storage_flag )
+   {
+      pos &= ~segment_storage_flag;
+      source = &segment_blocks_for_read( segment );
+   }
+   else if( _blocks.is_open() )
+      source = &_blocks;
+   else
+      return false;
+
+   source->seekg( 0, source->end );
+   const std::streampos size = source->tellg();
+   if( size < 0 || pos + e.block_size > static_cast<uint64_t>(size) )
+      return false;
+   data.resize( e.block_size );
+   source->seekg( pos );
+   source->read( data.data(), e.block_size );
+   return source->gcount() == e.block_size;
+}
+
+bool block_database::read_compressed_block_data( uint32_t segment, uint32_t block_num, vector<char>& data )const
+{
+   if( !_cached_segment_num.valid() || *_cached_segment_num != segment )
+   {
+      _cached_segment_num.reset();
+      std::string compressed;
+      fc::read_file_contents( segment_filename( _segments_dir, segment, true ), compressed );
+      std::string contents = fc::zlib_decompress( compressed );
+
+      fc::datastream<const char*> ds( contents.data(), contents.size() );
+      compressed_segment_header header;
+      fc::raw::unpack( ds, header );
+      FC_ASSERT( header.first_block_num == segment * blocks_per_segment && header.blocks.size() == blocks_per_segment,
+                 "Corrupt compressed block segment ${s}", ("s", segment) );
+      _cached_segment_blocks = std::move( header.blocks );
+      _cached_segment_payload = contents.substr( contents.size() - ds.remaining() );
+      _cached_segment_num = segment;
+   }
+
+   const auto& location = _cached_segment_blocks[ block_num - segment * blocks_per_segment ];
+   if( location.second == 0 || location.first + location.second > _cached_segment_payload.size() )
+      return false;
+   data.assign( _cached_segment_payload.data() + location.first,
+                _cached_segment_payload.data() + location.first + location.second );
+   return true;
+}
+
+void block_database::compact( uint32_t last_irreversible_block_num )
+{
+   if( !_compaction_enabled )
+      return;
+   try
+   {
+      if( _compaction.valid() )
+      {
+         if( _compaction.wait_for( std::chrono::seconds(0) ) != std::future_status::ready )
+            return;
+         _compaction.get();
+         finish_compaction();
+      }
+
+      const uint64_t segment_end = uint64_t( _compressed_segments + 1 ) * blocks_per_segment;
+      if( segment_end > uint64_t( last_irreversible_block_num ) + 1 )
+         return;
+
+      flush();
+      const uint32_t segment = _compressed_segments;
+      _compaction = std::async( std::launch::async,
+                                [index_filename = _index_filename, legacy_filename = _blocks_filename,
+                                 plain_filename = segment_filename( _segments_dir, segment, false ),
+                                 compressed_filename = segment_filename( _segments_dir, segment, true ), segment]() {
+         write_compressed_segment( index_filename, legacy_filename, plain_filename, compressed_filename,
+                                   segment * blocks_per_segment );
+      });
+   }
+   catch( const fc::exception& e )
+   {
+      elog( "Failed to compress block segment, block storage compaction is disabled until restart: ${e}",
+            ("e", e.to_detail_string()) );
+      _compaction_enabled = false;
+   }
+   catch( const std::exception& e )
+   {
+      elog( "Failed to compress block segment, block storage compaction is disabled until restart: ${e}",
+            ("e", e.what()) );
+      _compaction_enabled = false;
+   }
+}
+
+void block_database::finish_compaction()
+{
+   const uint32_t segment = _compressed_segments++;
+   if( _segment_blocks_num.valid() && *_segment_blocks_num == segment )
+   {
+      _segment_blocks.close();
+      _segment_blocks_num.reset();
+   }
+   if( _read_segment_blocks_num.valid() && *_read_segment_blocks_num == segment )
+   {
+      _read_segment_blocks.close();
+      _read_segment_blocks_num.reset();
+   }
+   fc::remove( segment_filename( _segments_dir, segment, false ) );
+
+   if( _legacy_block_count.valid() && uint64_t( _compressed_segments ) * blocks_per_segment >= *_legacy_block_count )
+   {
+      ilog( "All legacy blocks are in compressed segments, removing ${f}", ("f", _blocks_filename) );
+      _blocks.close();
+      fc::remove( _blocks_filename );
+      fc::remove( _segments_dir / "legacy_blocks" );
+      _legacy_block_count.reset();
+   }
+}
+
 void block_database::store( const block_id_type& _id, const signed_block& b )
 {
    if (true == replay_mode){
@@ -89,12 +413,15 @@ void block_database::store( const block_id_type& _id, const signed_block& b )
    auto num = block_header::num_from_id(id);
    _block_num_to_pos.seekp( sizeof( index_entry ) * num );
    index_entry e;
-   _blocks.seekp( 0, _blocks.end );
+   std::fstream& blocks = _segment_storage ? segment_blocks_for_write( num / blocks_per_segment ) : _blocks;
+   blocks.seekp( 0, blocks.end );
    auto vec = fc::raw::pack( b );
-   e.block_pos  = _blocks.tellp();
+   e.block_pos  = blocks.tellp();
+   if( _segment_storage )
+      e.block_pos |= segment_storage_flag;
    e.block_size = vec.size();
    e.block_id   = id;
-   _blocks.write( vec.data(), vec.size() );
+   blocks.write( vec.data(), vec.size() );
    _block_num_to_pos.write( (char*)&e, sizeof(e) );
 }
 
@@ -184,10 +511,9 @@ optional<signed_block> block_database::fetch_optional( const block_id_type& id )
 
       if( e.block_id != id ) return optional<signed_block>();
 
-      vector<char> data( e.block_size );
-      _blocks.seekg( e.block_pos );
-      if (e.block_size)
-         _blocks.read( data.data(), e.block_size );
+      vector<char> data;
+      if( !read_block_data( e, data ) )
+         return optional<signed_block>();
       auto result = fc::raw::unpack<signed_block>(data);
       FC_ASSERT( result.id() == e.block_id );
       return result;
@@ -219,9 +545,9 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
       _block_num_to_pos.seekg( index_pos, _block_num_to_pos.beg );
       _block_num_to_pos.read( (char*)&e, sizeof(e) );
 
-      vector<char> data( e.block_size );
-      _blocks.seekg( e.block_pos );
-      _blocks.read( data.data(), e.block_size );
+      vector<char> data;
+      if( !read_block_data( e, data ) )
+         return optional<signed_block>();
       auto result = fc::raw::unpack<signed_block>(data);
       FC_ASSERT( result.id() == e.block_id );
       return result;
@@ -251,21 +577,16 @@ optional<index_entry> block_database::last_index_entry()const {
 
       pos -= pos % sizeof(index_entry);
 
-      _blocks.seekg( 0, _block_num_to_pos.end );
-      const std::streampos blocks_size = _blocks.tellg();
       while( pos > 0 )
       {
          pos -= sizeof(index_entry);
          _block_num_to_pos.seekg( pos );
          _block_num_to_pos.read( (char*)&e, sizeof(e) );
-         if( _block_num_to_pos.gcount() == sizeof(e) && e.block_size > 0
-                && e.block_pos + static_cast<uint64_t>(e.block_size) <= static_cast<uint64_t>(blocks_size) )
+         if( _block_num_to_pos.gcount() == sizeof(e) && e.block_size > 0 )
             try
             {
-               vector<char> data( e.block_size );
-               _blocks.seekg( e.block_pos );
-               _blocks.read( data.data(), e.block_size );
-               if( _blocks.gcount() == e.block_size )
+               vector<char> data;
+               if( read_block_data( e, data ) )
                {
                   const signed_block block = fc::raw::unpack<signed_block>(data);
                   if( block.id() == e.block_id )
@@ -25,6 +25,7 @@
 #include <graphene/chain/committee_member_object.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/account_object.hpp>
+#include <graphene/chain/hardfork.hpp>
 #include <graphene/protocol/fee_schedule.hpp>
 #include <graphene/protocol/vote.hpp>
 #include <graphene/chain/transaction_evaluation_state.hpp>
@@ -82,6 +83,9 @@ void_result committee_member_update_global_parameters_evaluator::do_evaluate(con
    if( !o.new_parameters.extensions.value.min_bet_multiplier.valid()
         && o.new_parameters.extensions.value.max_bet_multiplier.valid() )
        FC_ASSERT( dgpo->parameters.min_bet_multiplier() < *o.new_parameters.extensions.value.max_bet_multiplier );
+   if( db().head_block_time() < HARDFORK_BMG_SETTLEMENT_TIME )
+      FC_ASSERT( !o.new_parameters.extensions.value.betting_positions_settled_per_block.valid(),
+                 "betting_positions_settled_per_block not allowed before HARDFORK_BMG_SETTLEMENT_TIME" );
 
    return void_result();
 } FC_CAPTURE_AND_RETHROW( (o) ) }
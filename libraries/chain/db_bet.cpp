@@ -28,6 +28,7 @@
 #include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/betting_market_object.hpp>
 #include <graphene/chain/event_object.hpp>
+#include <graphene/chain/hardfork.hpp>
 
 #include <fc/log/logger.hpp>
 
@@ -55,29 +56,32 @@ void database::cancel_bet( const bet_object& bet, bool create_virtual_op )
 
 void database::cancel_all_unmatched_bets_on_betting_market(const betting_market_object& betting_market)
 {
-   const auto& bet_odds_idx = get_index_type<bet_object_index>().indices().get<by_odds>();
-
-   // first, cancel all bets on the active books
-   auto book_itr = bet_odds_idx.lower_bound(std::make_tuple(betting_market.id));
-   auto book_end = bet_odds_idx.upper_bound(std::make_tuple(betting_market.id));
-   while (book_itr != book_end)
-   {
-      auto old_book_itr = book_itr;
-      ++book_itr;
-      cancel_bet(*old_book_itr, true);
-   }
-
-   // then, cancel any delayed bets on that market.  We don't have an index for
-   // that, so walk through all delayed bets
-   book_itr = bet_odds_idx.begin();
-   while (book_itr != bet_odds_idx.end() &&
-          book_itr->end_of_delay)
-   {
-      auto old_book_itr = book_itr;
-      ++book_itr;
-      if (old_book_itr->betting_market_id == betting_market.id)
-         cancel_bet(*old_book_itr, true);
-   }
+   const auto& order_books = get_index_type<primary_index<bet_object_index>>().get_secondary_index<bet_order_book_index>();
+   const bet_order_book_index::market_order_book* book = order_books.get_order_book(betting_market.id);
+   if (!book)
+      return;
+
+   // cancel in the same order by_odds holds the bets: the active book first, backs then lays,
+   // then the delayed bets in the order their delays expire
+   vector<bet_id_type> bets_to_cancel;
+   for (const auto& level : book->back_bets)
+      bets_to_cancel.insert(bets_to_cancel.end(), level.second.bets.begin(), level.second.bets.end());
+   for (const auto& level : book->lay_bets)
+      bets_to_cancel.insert(bets_to_cancel.end(), level.second.bets.begin(), level.second.bets.end());
+
+   vector<const bet_object*> delayed_bets;
+   delayed_bets.reserve(book->delayed_bets.size());
+   for (const bet_id_type& delayed_bet_id : book->delayed_bets)
+      delayed_bets.push_back(&delayed_bet_id(*this));
+   std::sort(delayed_bets.begin(), delayed_bets.end(), [](const bet_object* lhs, const bet_object* rhs) {
+      return compare_bet_by_odds()(*lhs, *rhs);
+   });
+   for (const bet_object* delayed_bet : delayed_bets)
+      bets_to_cancel.push_back(delayed_bet->id);
+
+   // the book is gone once the last bet is canceled, so don't touch it past this point
+   for (const bet_id_type& bet_id : bets_to_cancel)
+      cancel_bet(bet_id(*this), true);
 }
 
 void database::validate_betting_market_group_resolutions(const betting_market_group_object& betting_market_group,
@@ -157,18 +161,129 @@ void database::resolve_betting_market_group(const betting_market_group_object& b
    }
 }
 
-void database::settle_betting_market_group(const betting_market_group_object& betting_market_group)
+namespace {
+
+// we pay the rake fee to the dividend distribution account for the core asset
+fc::optional<account_id_type> get_betting_rake_account(const database& db)
 {
-   fc_ilog(fc::logger::get("betting"), "Settling betting market group ${id}", ("id", betting_market_group.id));
-   // we pay the rake fee to the dividend distribution account for the core asset, go ahead
-   // and look up that account now
    fc::optional<account_id_type> rake_account_id;
-   const asset_object& core_asset_obj = asset_id_type(0)(*this);
+   const asset_object& core_asset_obj = asset_id_type(0)(db);
    if (core_asset_obj.dividend_data_id)
    {
-      const asset_dividend_data_object& core_asset_dividend_data_obj = (*core_asset_obj.dividend_data_id)(*this);
+      const asset_dividend_data_object& core_asset_dividend_data_obj = (*core_asset_obj.dividend_data_id)(db);
       rake_account_id = core_asset_dividend_data_obj.dividend_distribution_account;
    }
+   return rake_account_id;
+}
+
+// pays out one bettor's positions in a betting market group, collecting winnings and fees
+// respecting asset_id, and removes the positions that were paid
+void settle_bettor_positions(database& db,
+                             const betting_market_group_object& betting_market_group,
+                             account_id_type bettor_id,
+                             const std::vector<const betting_market_position_object*>& bettor_positions,
+                             const std::map<betting_market_id_type, betting_market_resolution_type>& resolutions_by_market_id,
+                             const fc::optional<account_id_type>& rake_account_id,
+                             affiliate_payout_helper& payout_helper)
+{
+   uint16_t rake_fee_percentage = db.get_global_properties().parameters.betting_rake_fee_percentage();
+   share_type net_profits;
+   share_type payout_amounts;
+
+   for (const betting_market_position_object* position : bettor_positions)
+   {
+      betting_market_resolution_type resolution;
+      try
+      {
+         resolution = resolutions_by_market_id.at(position->betting_market_id);
+      }
+      catch (std::out_of_range&)
+      {
+         FC_THROW_EXCEPTION(fc::key_not_found_exception, "Unexpected betting market ID, shouldn't happen");
+      }
+
+      ///if (cancel)
+      ///   resolution = betting_market_resolution_type::cancel;
+      ///else
+      ///{
+      ///   // checked in evaluator, should never happen, see above
+      ///   assert(resolutions.count(position->betting_market_id));
+      ///   resolution = resolutions.at(position->betting_market_id);
+      ///}
+
+
+      switch (resolution)
+      {
+         case betting_market_resolution_type::win:
+            {
+               share_type total_payout = position->pay_if_payout_condition + position->pay_if_not_canceled;
+               payout_amounts += total_payout;
+               net_profits += total_payout - position->pay_if_canceled;
+               break;
+            }
+         case betting_market_resolution_type::not_win:
+            {
+               share_type total_payout = position->pay_if_not_payout_condition + position->pay_if_not_canceled;
+               payout_amounts += total_payout;
+               net_profits += total_payout - position->pay_if_canceled;
+               break;
+            }
+         case betting_market_resolution_type::cancel:
+            payout_amounts += position->pay_if_canceled;
+            break;
+         default:
+            continue;
+      }
+      db.remove(*position);
+   }
+
+   // pay the fees to the dividend-distribution account if net profit
+   share_type rake_amount;
+   if (net_profits.value > 0 && rake_account_id)
+   {
+      rake_amount = ((fc::uint128_t(net_profits.value) * rake_fee_percentage + GRAPHENE_100_PERCENT - 1) / GRAPHENE_100_PERCENT);
+      share_type affiliates_share;
+      if (rake_amount.value)
+         affiliates_share = payout_helper.payout( bettor_id, rake_amount );
+      FC_ASSERT( rake_amount.value >= affiliates_share.value );
+      if (rake_amount.value > affiliates_share.value)
+         db.adjust_balance(*rake_account_id, asset(rake_amount - affiliates_share, betting_market_group.asset_id));
+   }
+
+   // pay winning - rake
+   db.adjust_balance(bettor_id, asset(payout_amounts - rake_amount, betting_market_group.asset_id));
+   // [ROL]
+   //fc_idump(fc::logger::get("betting"), (payout_amounts)(net_profits.value)(rake_amount.value));
+
+   db.push_applied_operation(betting_market_group_resolved_operation(bettor_id,
+                             betting_market_group.id,
+                             resolutions_by_market_id,
+                             payout_amounts,
+                             rake_amount));
+}
+
+void remove_betting_market_group(database& db, const betting_market_group_object& betting_market_group)
+{
+   auto& betting_market_index = db.get_index_type<betting_market_object_index>().indices().get<by_betting_market_group_id>();
+   auto betting_market_itr = betting_market_index.lower_bound(betting_market_group.id);
+   while (betting_market_itr != betting_market_index.end() &&  betting_market_itr->group_id == betting_market_group.id) {
+      const betting_market_object& betting_market = *betting_market_itr;
+
+      ++betting_market_itr;
+      fc_dlog(fc::logger::get("betting"), "removing betting market ${id}", ("id", betting_market.id));
+      db.remove(betting_market);
+   }
+
+   fc_dlog(fc::logger::get("betting"), "removing betting market group ${id}", ("id", betting_market_group.id));
+   db.remove(betting_market_group);
+}
+
+} // end anonymous namespace
+
+void database::settle_betting_market_group(const betting_market_group_object& betting_market_group)
+{
+   fc_ilog(fc::logger::get("betting"), "Settling betting market group ${id}", ("id", betting_market_group.id));
+   fc::optional<account_id_type> rake_account_id = get_betting_rake_account(*this);
 
    affiliate_payout_helper payout_helper( *this, betting_market_group );
 
@@ -207,84 +322,8 @@ void database::settle_betting_market_group(const betting_market_group_object& be
 
    // walking through bettors' positions and collecting winings and fees respecting asset_id
    for (const auto& bettor_positions_pair: bettor_positions_map)
-   {
-      uint16_t rake_fee_percentage = get_global_properties().parameters.betting_rake_fee_percentage();
-      share_type net_profits;
-      share_type payout_amounts;
-      account_id_type bettor_id = bettor_positions_pair.first;
-      const std::vector<const betting_market_position_object*>& bettor_positions = bettor_positions_pair.second;
-
-      for (const betting_market_position_object* position : bettor_positions)
-      {
-         betting_market_resolution_type resolution;
-         try
-         {
-            resolution = resolutions_by_market_id.at(position->betting_market_id);
-         }
-         catch (std::out_of_range&)
-         {
-            FC_THROW_EXCEPTION(fc::key_not_found_exception, "Unexpected betting market ID, shouldn't happen");
-         }
-
-         ///if (cancel)
-         ///   resolution = betting_market_resolution_type::cancel;
-         ///else
-         ///{
-         ///   // checked in evaluator, should never happen, see above
-         ///   assert(resolutions.count(position->betting_market_id));
-         ///   resolution = resolutions.at(position->betting_market_id);
-         ///}
-
-
-         switch (resolution)
-         {
-            case betting_market_resolution_type::win:
-               {
-                  share_type total_payout = position->pay_if_payout_condition + position->pay_if_not_canceled;
-                  payout_amounts += total_payout;
-                  net_profits += total_payout - position->pay_if_canceled;
-                  break;
-               }
-            case betting_market_resolution_type::not_win:
-               {
-                  share_type total_payout = position->pay_if_not_payout_condition + position->pay_if_not_canceled;
-                  payout_amounts += total_payout;
-                  net_profits += total_payout - position->pay_if_canceled;
-                  break;
-               }
-            case betting_market_resolution_type::cancel:
-               payout_amounts += position->pay_if_canceled;
-               break;
-            default:
-               continue;
-         }
-         remove(*position);
-      }
-
-      // pay the fees to the dividend-distribution account if net profit
-      share_type rake_amount;
-      if (net_profits.value > 0 && rake_account_id)
-      {
-         rake_amount = ((fc::uint128_t(net_profits.value) * rake_fee_percentage + GRAPHENE_100_PERCENT - 1) / GRAPHENE_100_PERCENT);
-         share_type affiliates_share;
-         if (rake_amount.value)
-            affiliates_share = payout_helper.payout( bettor_id, rake_amount );
-         FC_ASSERT( rake_amount.value >= affiliates_share.value );
-         if (rake_amount.value > affiliates_share.value)
-            adjust_balance(*rake_account_id, asset(rake_amount - affiliates_share, betting_market_group.asset_id));
-      }
-      
-      // pay winning - rake
-      adjust_balance(bettor_id, asset(payout_amounts - rake_amount, betting_market_group.asset_id));
-      // [ROL]
-      //fc_idump(fc::logger::get("betting"), (payout_amounts)(net_profits.value)(rake_amount.value));
-
-      push_applied_operation(betting_market_group_resolved_operation(bettor_id,
-                             betting_market_group.id,
-                             resolutions_by_market_id,
-                             payout_amounts,
-                             rake_amount));
-   }
+      settle_bettor_positions(*this, betting_market_group, bettor_positions_pair.first, bettor_positions_pair.second,
+                              resolutions_by_market_id, rake_account_id, payout_helper);
 
    // At this point, the betting market group will either be in the "graded" or "canceled" state,
    // if it was graded, mark it as settled.  if it's canceled, let it remain canceled.
@@ -296,30 +335,121 @@ void database::settle_betting_market_group(const betting_market_group_object& be
          group.on_settled_event(*this);
       });
 
-   betting_market_itr = betting_market_index.lower_bound(betting_market_group.id);
-   while (betting_market_itr != betting_market_index.end() &&  betting_market_itr->group_id == betting_market_group.id) {
-      const betting_market_object& betting_market = *betting_market_itr;
+   remove_betting_market_group(*this, betting_market_group);
 
-      ++betting_market_itr;
-      fc_dlog(fc::logger::get("betting"), "removing betting market ${id}", ("id", betting_market.id));
-      remove(betting_market);
+   payout_helper.commit();
+}
+
+void database::start_settling_betting_market_group(const betting_market_group_object& betting_market_group)
+{
+   auto& betting_market_index = get_index_type<betting_market_object_index>().indices().get<by_betting_market_group_id>();
+   auto betting_markets_in_group = boost::make_iterator_range(betting_market_index.equal_range(betting_market_group.id));
+
+   // The first time we see a graded group, cancel whatever is left on its books and mark it settled
+   // right away.  "settled" and "canceled" are final states, so nothing can change the group's
+   // resolutions or add positions while its payouts are spread over the next blocks; in particular
+   // the canceled_event its event sends when it is canceled is ignored from then on.
+   if (betting_market_group.get_status() == betting_market_group_status::graded)
+   {
+      fc_ilog(fc::logger::get("betting"), "Settling betting market group ${id}", ("id", betting_market_group.id));
+      for (const betting_market_object& betting_market : betting_markets_in_group)
+         cancel_all_unmatched_bets_on_betting_market(betting_market);
+      modify(betting_market_group, [&](betting_market_group_object& group) {
+         group.on_settled_event(*this);
+      });
+   }
+   else if (betting_market_group.get_status() == betting_market_group_status::canceled)
+   {
+      // markets of a canceled group may still hold unmatched bets the first time we get here;
+      // this is a no-op afterwards
+      for (const betting_market_object& betting_market : betting_markets_in_group)
+         cancel_all_unmatched_bets_on_betting_market(betting_market);
    }
+}
 
-   fc_dlog(fc::logger::get("betting"), "removing betting market group ${id}", ("id", betting_market_group.id));
-   remove(betting_market_group);
+bool database::settle_betting_market_group_incrementally(const betting_market_group_object& betting_market_group,
+                                                         uint32_t& max_positions_to_settle)
+{
+   auto& betting_market_index = get_index_type<betting_market_object_index>().indices().get<by_betting_market_group_id>();
+   auto betting_markets_in_group = boost::make_iterator_range(betting_market_index.equal_range(betting_market_group.id));
+
+   fc::optional<account_id_type> rake_account_id = get_betting_rake_account(*this);
+   affiliate_payout_helper payout_helper( *this, betting_market_group );
+
+   std::map<betting_market_id_type, betting_market_resolution_type> resolutions_by_market_id;
+
+   // Positions of each market are ordered by bettor, so we walk all markets of the group in
+   // lockstep and pay one bettor at a time, lowest account id first.  Paid positions are removed,
+   // which makes the next block's pass pick up exactly where this one stopped.
+   auto& position_index = get_index_type<betting_market_position_index>().indices().get<by_betting_market_bettor>();
+   typedef decltype(position_index.begin()) position_iterator;
+   std::vector<std::pair<position_iterator, betting_market_id_type>> position_cursors;
+   for (const betting_market_object& betting_market : betting_markets_in_group)
+   {
+      FC_ASSERT(betting_market.resolution, "Unexpected error settling betting market ${market_id}: no published resolution",
+                ("market_id", betting_market.id));
+      resolutions_by_market_id.emplace(betting_market.id, *betting_market.resolution);
+      position_cursors.emplace_back(position_index.lower_bound(betting_market.id), betting_market.id);
+   }
+
+   auto cursor_is_done = [&position_index](const std::pair<position_iterator, betting_market_id_type>& cursor) {
+      return cursor.first == position_index.end() || cursor.first->betting_market_id != cursor.second;
+   };
+
+   std::vector<const betting_market_position_object*> bettor_positions;
+   while (max_positions_to_settle > 0)
+   {
+      fc::optional<account_id_type> bettor_id;
+      for (const auto& cursor : position_cursors)
+         if (!cursor_is_done(cursor) && (!bettor_id || cursor.first->bettor_id < *bettor_id))
+            bettor_id = cursor.first->bettor_id;
+      if (!bettor_id)
+         break;
+
+      bettor_positions.clear();
+      for (auto& cursor : position_cursors)
+         if (!cursor_is_done(cursor) && cursor.first->bettor_id == *bettor_id)
+            bettor_positions.push_back(&*cursor.first++);
+
+      settle_bettor_positions(*this, betting_market_group, *bettor_id, bettor_positions,
+                              resolutions_by_market_id, rake_account_id, payout_helper);
+      max_positions_to_settle -= std::min<uint32_t>(max_positions_to_settle, bettor_positions.size());
+   }
 
    payout_helper.commit();
+
+   for (const auto& cursor : position_cursors)
+      if (!cursor_is_done(cursor))
+         return false;
+
+   remove_betting_market_group(*this, betting_market_group);
+   return true;
 }
 
 void database::remove_completed_events()
 {
    const auto& event_index = get_index_type<event_object_index>().indices().get<by_event_status>();
 
+   // a group past its settling time may take several blocks to be paid out, its event has to stay until then
+   const bool settlement_spans_blocks = head_block_time() >= HARDFORK_BMG_SETTLEMENT_TIME;
+   const auto& group_index = get_index_type<betting_market_group_object_index>().indices().get<by_event_id>();
+   auto has_settling_groups = [&](const event_object& event) {
+      if (!settlement_spans_blocks)
+         return false;
+      const event_id_type event_id = event.id;
+      for (auto itr = group_index.lower_bound(event_id); itr != group_index.end() && itr->event_id == event_id; ++itr)
+         if (itr->is_settling(head_block_time()))
+            return true;
+      return false;
+   };
+
    auto canceled_event_iter = event_index.lower_bound(event_status::canceled);
    while (canceled_event_iter != event_index.end() && canceled_event_iter->get_status() == event_status::canceled)
    {
       const event_object& event = *canceled_event_iter;
       ++canceled_event_iter;
+      if (has_settling_groups(event))
+         continue;
       fc_dlog(fc::logger::get("betting"), "removing canceled event ${id}", ("id", event.id));
       remove(event);
    }
@@ -329,6 +459,8 @@ void database::remove_completed_events()
    {
       const event_object& event = *settled_event_iter;
       ++settled_event_iter;
+      if (has_settling_groups(event))
+         continue;
       fc_dlog(fc::logger::get("betting"), "removing settled event ${id}", ("id", event.id));
       remove(event);
    }
@@ -476,7 +608,7 @@ int match_bet(database& db, const bet_object& taker_bet, const bet_object& maker
    share_type maximum_factor = std::min(maximum_taker_factor, maximum_maker_factor);
    share_type maker_amount_to_match = maximum_factor * maker_odds_ratio;
    share_type taker_amount_to_match = maximum_factor * taker_odds_ratio;
-   fc_idump(fc::logger::get("betting"), (maker_amount_to_match)(taker_amount_to_match));
+   fc_ddump(fc::logger::get("betting"), (maker_amount_to_match)(taker_amount_to_match));
 
    // TODO: analyze whether maximum_maker_amount_to_match can ever be zero here 
    assert(maker_amount_to_match != 0);
@@ -609,26 +741,20 @@ bool database::place_bet(const bet_object& new_bet_object)
            ("new_bet", new_bet_object));
    }
 
-   const auto& bet_odds_idx = get_index_type<bet_object_index>().indices().get<by_odds>();
-
+   const auto& order_books = get_index_type<primary_index<bet_object_index>>().get_secondary_index<bet_order_book_index>();
    bet_type bet_type_to_match = new_bet_object.back_or_lay == bet_type::back ? bet_type::lay : bet_type::back;
-   auto book_itr = bet_odds_idx.lower_bound(std::make_tuple(new_bet_object.betting_market_id, bet_type_to_match));
-   auto book_end = bet_odds_idx.upper_bound(std::make_tuple(new_bet_object.betting_market_id, bet_type_to_match, new_bet_object.backer_multiplier));
-
-   // fc_ilog(fc::logger::get("betting"), "");
-   // fc_ilog(fc::logger::get("betting"), "------------  order book ------------------");
-   // for (auto itr = book_itr; itr != book_end; ++itr)
-   //    fc_idump(fc::logger::get("betting"), (*itr));
-   // fc_ilog(fc::logger::get("betting"), "------------  order book ------------------");
 
    int orders_matched_flags = 0;
    bool finished = false;
-   while (!finished && book_itr != book_end)
+   while (!finished)
    {
-      auto old_book_itr = book_itr;
-      ++book_itr;
+      // matching removes or shrinks the bets, so look up the best remaining maker bet each time
+      optional<bet_id_type> maker_bet_id = order_books.get_best_matching_bet(new_bet_object.betting_market_id, bet_type_to_match,
+                                                                            new_bet_object.backer_multiplier);
+      if (!maker_bet_id)
+         break;
 
-      orders_matched_flags = match_bet(*this, new_bet_object, *old_book_itr);
+      orders_matched_flags = match_bet(*this, new_bet_object, (*maker_bet_id)(*this));
 
       // we continue if the maker bet was completely consumed AND the taker bet was not
       finished = orders_matched_flags != 2;
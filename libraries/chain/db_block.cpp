@@ -42,6 +42,7 @@
 #include <graphene/protocol/betting_market.hpp>
 
 #include <fc/crypto/digest.hpp>
+#include <fc/thread/parallel.hpp>
 
 namespace {
 
@@ -85,6 +86,46 @@ namespace {
 
 namespace graphene { namespace chain {
 
+namespace {
+
+   /// Per-transaction hashes of a block, computed once before the block is applied
+   struct block_digests
+   {
+      vector<transaction_id_type> trx_ids;
+      vector<digest_type>         merkle_leaves;
+   };
+
+   /**
+    * Packs and hashes every transaction of @p block at most once for each of the requested digests.
+    * Large blocks are split across the fc worker pool; the hashes are independent of chain state.
+    */
+   block_digests precompute_block_digests( const signed_block& block, bool want_ids, bool want_merkle_leaves )
+   {
+      block_digests result;
+      const size_t trx_count = block.transactions.size();
+      if( trx_count == 0 || !(want_ids || want_merkle_leaves) )
+         return result;
+      if( want_ids )
+         result.trx_ids.resize( trx_count );
+      if( want_merkle_leaves )
+         result.merkle_leaves.resize( trx_count );
+
+      // small blocks are hashed on this thread, handing them to the pool would cost more than it saves
+      const size_t min_transactions_per_range = 64;
+      fc::parallel_for_ranges( trx_count, min_transactions_per_range, [&block, &result]( size_t, size_t begin, size_t end ) {
+         for( size_t i = begin; i < end; ++i )
+         {
+            if( !result.trx_ids.empty() )
+               result.trx_ids[i] = block.transactions[i].id();
+            if( !result.merkle_leaves.empty() )
+               result.merkle_leaves[i] = block.transactions[i].merkle_digest();
+         }
+      });
+      return result;
+   }
+
+}
+
 bool database::is_known_block( const block_id_type& id )const
 {
    return _fork_db.is_known_block(id) || _block_id_to_block.contains(id);
@@ -198,6 +239,8 @@ bool database::_push_block(const signed_block& new_block)
 { try {
    uint32_t skip = get_node_properties().skip_flags;
    const auto now = fc::time_point::now().sec_since_epoch();
+   // hash the header once, the fork database, block store and error path all key on it
+   const block_id_type new_block_id = new_block.id();
 
    if( _fork_db.head() && new_block.timestamp.sec_since_epoch() > now - 86400 )
    {
@@ -207,7 +250,7 @@ bool database::_push_block(const signed_block& new_block)
       if( prev_block->scheduled_witnesses && !(skip&(skip_witness_schedule_check|skip_witness_signature)) )
          verify_signing_witness( new_block, *prev_block );
    }
-   shared_ptr<fork_item> new_head = _fork_db.push_block(new_block);
+   shared_ptr<fork_item> new_head = _fork_db.push_block(new_block, new_block_id);
 
    //If the head block from the longest chain does not build off of the current head, we need to switch forks.
    if( new_head->data.previous != head_block_id() )
@@ -216,8 +259,8 @@ bool database::_push_block(const signed_block& new_block)
       //Only switch forks if new_head is actually higher than head
       if( new_head->data.block_num() > head_block_num() )
       {
-         wlog( "Switching to fork: ${id}", ("id",new_head->data.id()) );
-         auto branches = _fork_db.fetch_branch_from(new_head->data.id(), head_block_id());
+         wlog( "Switching to fork: ${id}", ("id",new_head->id) );
+         auto branches = _fork_db.fetch_branch_from(new_head->id, head_block_id());
 
          // pop blocks until we hit the forked block
          while( head_block_id() != branches.second.back()->data.previous )
@@ -258,7 +301,7 @@ bool database::_push_block(const signed_block& new_block)
                      pop_block();
                   }
 
-                  ilog( "Switching back to fork: ${id}", ("id",branches.second.front()->data.id()) );
+                  ilog( "Switching back to fork: ${id}", ("id",branches.second.front()->id) );
                   // restore all blocks from the good fork
                   for( auto ritr2 = branches.second.rbegin(); ritr2 != branches.second.rend(); ++ritr2 )
                   {
@@ -281,13 +324,14 @@ bool database::_push_block(const signed_block& new_block)
       apply_block(new_block, skip);
       if( new_block.timestamp.sec_since_epoch() > now - 86400 )
          update_witnesses( *new_head );
-      _block_id_to_block.store(new_block.id(), new_block);
+      _block_id_to_block.store(new_block_id, new_block);
       session.commit();
    } catch ( const fc::exception& e ) {
       elog("Failed to push new block:\n${e}", ("e", e.to_detail_string()));
-      _fork_db.remove(new_block.id());
+      _fork_db.remove(new_block_id);
       throw;
    }
+   _block_id_to_block.compact( get_dynamic_global_properties().last_irreversible_block_num );
 
    return false;
 } FC_CAPTURE_AND_RETHROW( (new_block) ) }
@@ -403,6 +447,63 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
    return processed_trx;
 }
 
+transaction_precheck_result database::precheck_transaction( const signed_transaction& trx )const
+{
+   const uint32_t skip = get_node_properties().skip_flags;
+   const chain_parameters& chain_parameters = get_global_properties().parameters;
+
+   // maximum_transaction_size is not enforced by the chain, only a transaction that can't fit in a block is hopeless
+   if( fc::raw::pack_size( trx ) > chain_parameters.maximum_block_size )
+      return transaction_precheck_result::oversized;
+
+   if( BOOST_LIKELY(head_block_num() > 0) )
+   {
+      const fc::time_point_sec now = head_block_time();
+      if( trx.expiration < now )
+         return transaction_precheck_result::expired;
+      if( trx.expiration > now + chain_parameters.maximum_time_until_expiration )
+         return transaction_precheck_result::expiration_too_far;
+
+      if( !(skip & skip_tapos_check) )
+      {
+         const block_summary_object* tapos_block_summary = find( block_summary_id_type( trx.ref_block_num ) );
+         if( tapos_block_summary == nullptr || trx.ref_block_prefix != tapos_block_summary->block_id._hash[1].value() )
+            return transaction_precheck_result::tapos_mismatch;
+      }
+   }
+
+   try {
+      trx.validate();
+   } catch( const fc::exception& ) {
+      return transaction_precheck_result::invalid;
+   }
+
+   if( !(skip & skip_transaction_dupe_check) )
+   {
+      const auto& trx_idx = get_index_type<transaction_index>().indices().get<by_trx_id>();
+      if( trx_idx.find( trx.id() ) != trx_idx.end() )
+         return transaction_precheck_result::duplicate;
+   }
+
+   if( !(skip & (skip_transaction_signatures | skip_authority_check) ) )
+   {
+      auto get_active = [this]( account_id_type id ) { return &id(*this).active; };
+      auto get_owner  = [this]( account_id_type id ) { return &id(*this).owner;  };
+      auto get_custom = [this]( account_id_type id, const operation& op ) {
+         return get_account_custom_authorities(id, op);
+      };
+      try {
+         trx.verify_authority( get_chain_id(), get_active, get_owner, get_custom,
+                               MUST_IGNORE_CUSTOM_OP_REQD_AUTHS(head_block_time()),
+                               chain_parameters.max_authority_depth );
+      } catch( const fc::exception& ) {
+         return transaction_precheck_result::missing_authority;
+      }
+   }
+
+   return transaction_precheck_result::accepted;
+}
+
 processed_transaction database::validate_transaction( const signed_transaction& trx )
 {
    auto session = _undo_db.start_undo_session();
@@ -464,11 +565,56 @@ signed_block database::generate_block(
    return result;
 } FC_CAPTURE_AND_RETHROW() }
 
+signed_block database::assemble_block(
+   fc::time_point_sec when,
+   witness_id_type witness_id,
+   const fc::ecc::private_key& block_signing_private_key,
+   uint32_t skip,
+   bool reapply_pending
+   )
+{ try {
+   signed_block result;
+   detail::with_skip_flags( *this, skip, [&]()
+   {
+      result = _assemble_block( when, witness_id, block_signing_private_key );
+      // _assemble_block() has undone the pending transactions; rebuild _pending_tx_session from them
+      // the same way push_block() does, dropping any which no longer apply
+      if( reapply_pending )
+         detail::without_pending_transactions( *this, std::move(_pending_tx), []{} );
+   } );
+   return result;
+} FC_CAPTURE_AND_RETHROW() }
+
+void database::push_assembled_block( const signed_block& block, uint32_t skip )
+{ try {
+   detail::with_skip_flags( *this, skip, [&]()
+   {
+      _push_assembled_block( block );
+   } );
+} FC_CAPTURE_AND_RETHROW() }
+
 signed_block database::_generate_block(
    fc::time_point_sec when,
    witness_id_type witness_id,
    const fc::ecc::private_key& block_signing_private_key
    )
+{
+   try {
+   signed_block pending_block = _assemble_block( when, witness_id, block_signing_private_key );
+
+   if( !(get_node_properties().skip_flags & skip_witness_signature) )
+      pending_block.sign( block_signing_private_key );
+
+   _push_assembled_block( pending_block );
+
+   return pending_block;
+} FC_CAPTURE_AND_RETHROW( (witness_id) ) }
+
+signed_block database::_assemble_block(
+   fc::time_point_sec when,
+   witness_id_type witness_id,
+   const fc::ecc::private_key& block_signing_private_key
+   )
 {
    try {
    uint32_t skip = get_node_properties().skip_flags;
@@ -567,8 +713,12 @@ signed_block database::_generate_block(
    fc::raw::pack( next_enc, pending_block.previous_secret );
    pending_block.next_secret_hash = secret_hash_type::hash(next_enc.result());
 
-   if( !(skip & skip_witness_signature) )
-      pending_block.sign( block_signing_private_key );
+   return pending_block;
+} FC_CAPTURE_AND_RETHROW( (witness_id) ) }
+
+void database::_push_assembled_block( const signed_block& pending_block )
+{
+   uint32_t skip = get_node_properties().skip_flags;
 
    // TODO:  Move this to _push_block() so session is restored.
    if( !(skip & skip_block_size_check) )
@@ -577,9 +727,7 @@ signed_block database::_generate_block(
    }
 
    push_block( pending_block, skip | skip_transaction_signatures ); // skip authority check when pushing self-generated blocks
-
-   return pending_block;
-} FC_CAPTURE_AND_RETHROW( (witness_id) ) }
+}
 
 /**
  * Removes the most recent block from the database and
@@ -664,7 +812,13 @@ void database::_apply_block( const signed_block& next_block )
    uint32_t skip = get_node_properties().skip_flags;
    _applied_ops.clear();
 
-   FC_ASSERT( (skip & skip_merkle_check) || next_block.transaction_merkle_root == next_block.calculate_merkle_root(), "", ("next_block.transaction_merkle_root",next_block.transaction_merkle_root)("calc",next_block.calculate_merkle_root())("next_block",next_block)("id",next_block.id()) );
+   const block_digests digests = precompute_block_digests( next_block, !(skip & skip_transaction_dupe_check),
+                                                           !(skip & skip_merkle_check) );
+   if( !(skip & skip_merkle_check) )
+   {
+      const checksum_type merkle_root = signed_block::calculate_merkle_root( digests.merkle_leaves );
+      FC_ASSERT( next_block.transaction_merkle_root == merkle_root, "", ("next_block.transaction_merkle_root",next_block.transaction_merkle_root)("calc",merkle_root)("next_block",next_block)("id",next_block.id()) );
+   }
 
    const witness_object& signing_witness = validate_block_header(skip, next_block);
    const auto& global_props = get_global_properties();
@@ -687,7 +841,10 @@ void database::_apply_block( const signed_block& next_block )
        * when building a block.
        */
 
-      apply_transaction( trx, skip );
+      if( digests.trx_ids.empty() )
+         _apply_transaction( trx );
+      else
+         _apply_transaction( trx, digests.trx_ids[_current_trx_in_block] );
       // For real operations which are explicitly included in a transaction, virtual_op is 0.
       // For VOPs derived directly from a real op,
       //     use the real op's (block_num,trx_in_block,op_in_trx), virtual_op starts from 1.
@@ -778,6 +935,14 @@ class undo_size_restorer {
 };
 
 processed_transaction database::_apply_transaction(const signed_transaction& trx)
+{
+   uint32_t skip = get_node_properties().skip_flags;
+   if( skip & skip_transaction_dupe_check )
+      return _apply_transaction( trx, optional<transaction_id_type>() );
+   return _apply_transaction( trx, trx.id() );
+}
+
+processed_transaction database::_apply_transaction(const signed_transaction& trx, const optional<transaction_id_type>& trx_id)
 { try {
    uint32_t skip = get_node_properties().skip_flags;
 
@@ -786,12 +951,11 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
 
    auto& trx_idx = get_mutable_index_type<transaction_index>();
    const chain_id_type& chain_id = get_chain_id();
-   transaction_id_type trx_id;
 
    if( !(skip & skip_transaction_dupe_check) )
    {
-      trx_id = trx.id();
-      FC_ASSERT( trx_idx.indices().get<by_trx_id>().find(trx_id) == trx_idx.indices().get<by_trx_id>().end() );
+      FC_ASSERT( trx_id.valid() );
+      FC_ASSERT( trx_idx.indices().get<by_trx_id>().find(*trx_id) == trx_idx.indices().get<by_trx_id>().end() );
    }
 
    transaction_evaluation_state eval_state(this);
@@ -832,8 +996,8 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    //Insert transaction into unique transactions database.
    if( !(skip & skip_transaction_dupe_check) )
    {
-      create<transaction_history_object>([&trx](transaction_history_object& transaction) {
-         transaction.trx_id = trx.id();
+      create<transaction_history_object>([&trx, &trx_id](transaction_history_object& transaction) {
+         transaction.trx_id = *trx_id;
          transaction.trx = trx;
       });
    }
@@ -905,8 +1069,10 @@ const witness_object& database::validate_block_header( uint32_t skip, const sign
 void database::create_block_summary(const signed_block& next_block)
 {
    block_summary_id_type sid(next_block.block_num() & 0xffff );
+   // update_global_dynamic_data() already hashed this block's header
+   const block_id_type& block_id = get_dynamic_global_properties().head_block_id;
    modify( sid(*this), [&](block_summary_object& p) {
-         p.block_id = next_block.id();
+         p.block_id = block_id;
    });
 }
 
@@ -154,10 +154,10 @@ const std::vector<uint32_t> database::get_winner_numbers( asset_id_type for_asse
 
 const account_statistics_object& database::get_account_stats_by_owner( account_id_type owner )const
 {
-   auto& idx = get_index_type<account_stats_index>().indices().get<by_owner>();
-   auto itr = idx.find( owner );
-   FC_ASSERT( itr != idx.end(), "Can not find account statistics object for owner ${a}", ("a",owner) );
-   return *itr;
+   // both hops go through direct indexes instead of walking the by_owner tree
+   const account_object* account = find( owner );
+   FC_ASSERT( account != nullptr, "Can not find account statistics object for owner ${a}", ("a",owner) );
+   return account->statistics( *this );
 }
 
 const witness_schedule_object& database::get_witness_schedule_object()const
@@ -108,6 +108,7 @@
 
 #include <fc/uint128.hpp>
 #include <fc/crypto/digest.hpp>
+#include <fc/thread/parallel.hpp>
 
 #include <boost/algorithm/string.hpp>
 
@@ -335,7 +336,8 @@ void database::initialize_indexes()
    _undo_db.set_max_size( GRAPHENE_MIN_UNDO_HISTORY );
 
    //Protocol object indexes
-   add_index< primary_index<asset_index, 13> >(); // 8192 assets per chunk
+   auto asset_idx = add_index< primary_index<asset_index, 13> >(); // 8192 assets per chunk
+   asset_idx->add_secondary_index<dividend_assets_index>();
    add_index< primary_index<force_settlement_index> >();
 
    auto acnt_index = add_index< primary_index<account_index, 20> >(); // ~1 million accounts per chunk
@@ -352,7 +354,8 @@ void database::initialize_indexes()
    prop_index->add_secondary_index<required_approval_index>();
 
    add_index< primary_index<withdraw_permission_index > >();
-   add_index< primary_index<vesting_balance_index> >();
+   auto vesting_idx = add_index< primary_index<vesting_balance_index> >();
+   vesting_idx->add_secondary_index<vesting_balance_totals_index>();
    add_index< primary_index<worker_index> >();
    add_index< primary_index<balance_index> >();
    add_index< primary_index<blinded_balance_index> >();
@@ -362,12 +365,14 @@ void database::initialize_indexes()
    add_index< primary_index<betting_market_rules_object_index > >();
    add_index< primary_index<betting_market_group_object_index > >();
    add_index< primary_index<betting_market_object_index > >();
-   add_index< primary_index<bet_object_index > >();
+   auto bet_idx = add_index< primary_index<bet_object_index > >();
+   bet_idx->add_secondary_index<bet_order_book_index>();
 
    add_index< primary_index<tournament_index> >();
    auto tournament_details_idx = add_index< primary_index<tournament_details_index> >();
    tournament_details_idx->add_secondary_index<tournament_players_index>();
-   add_index< primary_index<match_index> >();
+   auto match_idx = add_index< primary_index<match_index> >();
+   match_idx->add_secondary_index<tournament_match_changes_index>();
    add_index< primary_index<game_index> >();
    add_index< primary_index<custom_permission_index> >();
    add_index< primary_index<custom_account_authority_index> >();
@@ -391,12 +396,14 @@ void database::initialize_indexes()
 
    auto bal_idx = add_index< primary_index<account_balance_index          > >();
    bal_idx->add_secondary_index<balances_by_account_index>();
+   bal_idx->add_secondary_index<balance_counts_by_asset_index>();
 
-   add_index< primary_index<asset_bitasset_data_index,                 13 > >(); // 8192
+   auto bitasset_idx = add_index< primary_index<asset_bitasset_data_index, 13 > >(); // 8192
+   bitasset_idx->add_secondary_index<bitasset_call_limit_index>();
    add_index< primary_index<asset_dividend_data_object_index              > >();
    add_index< primary_index<simple_index<global_property_object          >> >();
    add_index< primary_index<simple_index<dynamic_global_property_object  >> >();
-   add_index< primary_index<account_stats_index                           > >();
+   add_index< primary_index<account_stats_index,                       20 > >(); // ~1 million per chunk, as for accounts
    add_index< primary_index<simple_index<asset_dynamic_data_object       >> >();
    add_index< primary_index<flat_index<  block_summary_object            >> >();
    add_index< primary_index<simple_index<chain_property_object          > > >();
@@ -422,6 +429,25 @@ void database::initialize_indexes()
 
 }
 
+namespace {
+
+   /**
+    * Calls fn(i) for every i in [0, count), splitting the range across the fc worker pool once it is large
+    * enough to pay for it. fn may only read shared state and write its own slot of a presized output;
+    * the first exception thrown by any range is rethrown on the calling thread.
+    */
+   template<typename Fn>
+   void prepare_in_parallel( size_t count, Fn&& fn )
+   {
+      const size_t min_items_per_range = 1024;
+      fc::parallel_for_ranges( count, min_items_per_range, [&fn]( size_t, size_t begin, size_t end ) {
+         for( size_t i = begin; i < end; ++i )
+            fn( i );
+      });
+   }
+
+}
+
 void database::init_genesis(const genesis_state_type& genesis_state)
 { try {
    FC_ASSERT( genesis_state.initial_timestamp != time_point_sec(), "Must initialize genesis timestamp." );
@@ -433,6 +459,19 @@ void database::init_genesis(const genesis_state_type& genesis_state)
              "initial_active_witnesses is larger than the number of candidate witnesses.");
 
    _undo_db.disable();
+
+   // Genesis objects are built in parallel where they only depend on the genesis state (and on accounts
+   // that already exist), then inserted serially in genesis order so object ids are unchanged.  Building
+   // them is cheap field copying; genesis time goes into the serial inserts and their secondary indexes,
+   // and there are no signatures or authorities to check, so expect little from the parallel part.  The
+   // phase timings logged below show where the time goes.
+   fc::time_point phase_start = fc::time_point::now();
+   auto finish_genesis_phase = [&phase_start]( const char* phase, size_t items ) {
+      const fc::time_point now = fc::time_point::now();
+      ilog( "Genesis: ${phase} (${n}) in ${t} ms", ("phase", phase)("n", items)("t", (now - phase_start).count() / 1000) );
+      phase_start = now;
+   };
+
    struct auth_inhibitor {
       auth_inhibitor(database& db) : db(db), old_flags(db.node_properties().skip_flags)
       { db.node_properties().skip_flags |= skip_authority_check; }
@@ -709,10 +748,13 @@ void database::init_genesis(const genesis_state_type& genesis_state)
       account_id_type account_id(apply_operation(genesis_eval_state, cop).get<object_id_type>());
    }
 
+   finish_genesis_phase( "core objects and bts account placeholders", genesis_state.initial_bts_accounts.size() );
+
    // Create initial accounts
-   for( const auto& account : genesis_state.initial_accounts )
-   {
-      account_create_operation cop;
+   vector<account_create_operation> account_create_ops( genesis_state.initial_accounts.size() );
+   prepare_in_parallel( account_create_ops.size(), [&genesis_state, &account_create_ops]( size_t i ) {
+      const auto& account = genesis_state.initial_accounts[i];
+      account_create_operation& cop = account_create_ops[i];
       cop.name = account.name;
       cop.registrar = GRAPHENE_TEMP_ACCOUNT;
       cop.owner = authority(1, account.owner_key, 1);
@@ -726,7 +768,11 @@ void database::init_genesis(const genesis_state_type& genesis_state)
          cop.active = authority(1, account.active_key, 1);
          cop.options.memo_key = account.active_key;
       }
-      account_id_type account_id(apply_operation(genesis_eval_state, cop).get<object_id_type>());
+   });
+   for( size_t i = 0; i < account_create_ops.size(); ++i )
+   {
+      const auto& account = genesis_state.initial_accounts[i];
+      account_id_type account_id(apply_operation(genesis_eval_state, account_create_ops[i]).get<object_id_type>());
 
       if( account.is_lifetime_member )
       {
@@ -736,6 +782,8 @@ void database::init_genesis(const genesis_state_type& genesis_state)
           apply_operation(genesis_eval_state, op);
       }
    }
+   vector<account_create_operation>().swap( account_create_ops );
+   finish_genesis_phase( "initial accounts", genesis_state.initial_accounts.size() );
 
    // Helper function to get account ID by name
    const auto& accounts_by_name = get_index_type<account_index>().indices().get<by_name>();
@@ -747,9 +795,10 @@ void database::init_genesis(const genesis_state_type& genesis_state)
       return itr->get_id();
    };
 
-   for( const auto& account : genesis_state.initial_bts_accounts )
-   {
-      account_update_operation op;
+   vector<account_update_operation> account_update_ops( genesis_state.initial_bts_accounts.size() );
+   prepare_in_parallel( account_update_ops.size(), [&genesis_state, &account_update_ops, &get_account_id]( size_t i ) {
+      const auto& account = genesis_state.initial_bts_accounts[i];
+      account_update_operation& op = account_update_ops[i];
       op.account = get_account_id(account.name);
 
       authority owner_authority;
@@ -769,9 +818,11 @@ void database::init_genesis(const genesis_state_type& genesis_state)
       active_authority.address_auths = account.active_authority.address_auths;
       
       op.active = std::move(active_authority);
-
+   });
+   for( const account_update_operation& op : account_update_ops )
       apply_operation(genesis_eval_state, op);
-   }
+   vector<account_update_operation>().swap( account_update_ops );
+   finish_genesis_phase( "bts account authorities", genesis_state.initial_bts_accounts.size() );
 
    // Helper function to get asset ID by symbol
    const auto& assets_by_symbol = get_index_type<asset_index>().indices().get<by_symbol>();
@@ -858,78 +909,120 @@ void database::init_genesis(const genesis_state_type& genesis_state)
       });
    }
 
+   finish_genesis_phase( "initial assets", genesis_state.initial_assets.size() );
+
    // Create balances for all bts accounts
-   for( const auto& account : genesis_state.initial_bts_accounts ) {
+   struct prepared_bts_balances
+   {
+      account_id_type                           owner;
+      vector<std::pair<asset, vesting_policy>>  vesting_balances;
+   };
+   vector<prepared_bts_balances> bts_balances( genesis_state.initial_bts_accounts.size() );
+   prepare_in_parallel( bts_balances.size(),
+                        [&genesis_state, &bts_balances, &get_account_id, &get_asset_id]( size_t i ) {
+      const auto& account = genesis_state.initial_bts_accounts[i];
+      prepared_bts_balances& prepared = bts_balances[i];
+      prepared.owner = get_account_id(account.name);
+      if (!account.vesting_balances)
+         return;
+      prepared.vesting_balances.reserve(account.vesting_balances->size());
+      for (const auto& vesting_balance : *account.vesting_balances) {
+         vesting_policy policy;
+         if (vesting_balance.policy_type == "linear") {
+            auto initial_linear_vesting_policy = vesting_balance.policy.as<genesis_state_type::initial_bts_account_type::initial_linear_vesting_policy>( 20 );
+            linear_vesting_policy new_vesting_policy;
+            new_vesting_policy.begin_timestamp = initial_linear_vesting_policy.begin_timestamp;
+            new_vesting_policy.vesting_cliff_seconds = initial_linear_vesting_policy.vesting_cliff_seconds;
+            new_vesting_policy.vesting_duration_seconds = initial_linear_vesting_policy.vesting_duration_seconds;
+            new_vesting_policy.begin_balance = initial_linear_vesting_policy.begin_balance;
+            policy = new_vesting_policy;
+         } else if (vesting_balance.policy_type == "cdd") {
+            auto initial_cdd_vesting_policy = vesting_balance.policy.as<genesis_state_type::initial_bts_account_type::initial_cdd_vesting_policy>( 20 );
+            cdd_vesting_policy new_vesting_policy;
+            new_vesting_policy.vesting_seconds = initial_cdd_vesting_policy.vesting_seconds;
+            new_vesting_policy.coin_seconds_earned = initial_cdd_vesting_policy.coin_seconds_earned;
+            new_vesting_policy.start_claim = initial_cdd_vesting_policy.start_claim;
+            new_vesting_policy.coin_seconds_earned_last_update = initial_cdd_vesting_policy.coin_seconds_earned_last_update;
+            policy = new_vesting_policy;
+         }
+         prepared.vesting_balances.emplace_back(asset(vesting_balance.amount, get_asset_id(vesting_balance.asset_symbol)),
+                                                std::move(policy));
+      }
+   });
+   for( size_t i = 0; i < bts_balances.size(); ++i ) {
+      const auto& account = genesis_state.initial_bts_accounts[i];
+      prepared_bts_balances& prepared = bts_balances[i];
       if (account.core_balance != share_type()) {
          total_supplies[asset_id_type()] += account.core_balance;
 
          create<account_balance_object>([&](account_balance_object& b) {
-            b.owner = get_account_id(account.name);
+            b.owner = prepared.owner;
             b.balance = account.core_balance;
          });
       }
 
       // create any vesting balances for this account
-      if (account.vesting_balances)
-         for (const auto& vesting_balance : *account.vesting_balances) {
-            create<vesting_balance_object>([&](vesting_balance_object& vbo) {
-               vbo.owner = get_account_id(account.name);
-               vbo.balance = asset(vesting_balance.amount, get_asset_id(vesting_balance.asset_symbol));
-               if (vesting_balance.policy_type == "linear") {
-                  auto initial_linear_vesting_policy = vesting_balance.policy.as<genesis_state_type::initial_bts_account_type::initial_linear_vesting_policy>( 20 );
-                  linear_vesting_policy new_vesting_policy;
-                  new_vesting_policy.begin_timestamp = initial_linear_vesting_policy.begin_timestamp;
-                  new_vesting_policy.vesting_cliff_seconds = initial_linear_vesting_policy.vesting_cliff_seconds;
-                  new_vesting_policy.vesting_duration_seconds = initial_linear_vesting_policy.vesting_duration_seconds;
-                  new_vesting_policy.begin_balance = initial_linear_vesting_policy.begin_balance;
-                  vbo.policy = new_vesting_policy;
-               } else if (vesting_balance.policy_type == "cdd") {
-                  auto initial_cdd_vesting_policy = vesting_balance.policy.as<genesis_state_type::initial_bts_account_type::initial_cdd_vesting_policy>( 20 );
-                  cdd_vesting_policy new_vesting_policy;
-                  new_vesting_policy.vesting_seconds = initial_cdd_vesting_policy.vesting_seconds;
-                  new_vesting_policy.coin_seconds_earned = initial_cdd_vesting_policy.coin_seconds_earned;
-                  new_vesting_policy.start_claim = initial_cdd_vesting_policy.start_claim;
-                  new_vesting_policy.coin_seconds_earned_last_update = initial_cdd_vesting_policy.coin_seconds_earned_last_update;
-                  vbo.policy = new_vesting_policy;
-               }
-               total_supplies[get_asset_id(vesting_balance.asset_symbol)] += vesting_balance.amount;
-            });
-         }
+      for (auto& vesting_balance : prepared.vesting_balances) {
+         create<vesting_balance_object>([&](vesting_balance_object& vbo) {
+            vbo.owner = prepared.owner;
+            vbo.balance = vesting_balance.first;
+            vbo.policy = std::move(vesting_balance.second);
+         });
+         total_supplies[vesting_balance.first.asset_id] += vesting_balance.first.amount;
+      }
    }
-
+   vector<prepared_bts_balances>().swap( bts_balances );
+   finish_genesis_phase( "bts account balances", genesis_state.initial_bts_accounts.size() );
 
    // Create initial balances
-   share_type total_allocation;
-   for( const auto& handout : genesis_state.initial_balances )
+   vector<balance_object> initial_balances( genesis_state.initial_balances.size() );
+   prepare_in_parallel( initial_balances.size(), [&genesis_state, &initial_balances, &get_asset_id]( size_t i ) {
+      const auto& handout = genesis_state.initial_balances[i];
+      balance_object& b = initial_balances[i];
+      b.balance = asset(handout.amount, get_asset_id(handout.asset_symbol));
+      b.owner = handout.owner;
+   });
+   for( const balance_object& prepared : initial_balances )
    {
-      const auto asset_id = get_asset_id(handout.asset_symbol);
-      create<balance_object>([&handout,total_allocation,asset_id](balance_object& b) {
-         b.balance = asset(handout.amount, asset_id);
-         b.owner = handout.owner;
+      create<balance_object>([&prepared](balance_object& b) {
+         b.balance = prepared.balance;
+         b.owner = prepared.owner;
       });
 
-      total_supplies[ asset_id ] += handout.amount;
+      total_supplies[ prepared.balance.asset_id ] += prepared.balance.amount;
    }
+   vector<balance_object>().swap( initial_balances );
+   finish_genesis_phase( "initial balances", genesis_state.initial_balances.size() );
 
    // Create initial vesting balances
-   for( const genesis_state_type::initial_vesting_balance_type& vest : genesis_state.initial_vesting_balances )
+   vector<balance_object> initial_vesting_balances( genesis_state.initial_vesting_balances.size() );
+   prepare_in_parallel( initial_vesting_balances.size(),
+                        [&genesis_state, &initial_vesting_balances, &get_asset_id]( size_t i ) {
+      const genesis_state_type::initial_vesting_balance_type& vest = genesis_state.initial_vesting_balances[i];
+      balance_object& b = initial_vesting_balances[i];
+      b.owner = vest.owner;
+      b.balance = asset(vest.amount, get_asset_id(vest.asset_symbol));
+
+      linear_vesting_policy policy;
+      policy.begin_timestamp = vest.begin_timestamp;
+      policy.vesting_cliff_seconds = vest.vesting_cliff_seconds ? *vest.vesting_cliff_seconds : 0;
+      policy.vesting_duration_seconds = vest.vesting_duration_seconds;
+      policy.begin_balance = vest.begin_balance;
+
+      b.vesting_policy = std::move(policy);
+   });
+   for( balance_object& prepared : initial_vesting_balances )
    {
-      const auto asset_id = get_asset_id(vest.asset_symbol);
-      create<balance_object>([&](balance_object& b) {
-         b.owner = vest.owner;
-         b.balance = asset(vest.amount, asset_id);
-
-         linear_vesting_policy policy;
-         policy.begin_timestamp = vest.begin_timestamp;
-         policy.vesting_cliff_seconds = vest.vesting_cliff_seconds ? *vest.vesting_cliff_seconds : 0;
-         policy.vesting_duration_seconds = vest.vesting_duration_seconds;
-         policy.begin_balance = vest.begin_balance;
-
-         b.vesting_policy = std::move(policy);
+      create<balance_object>([&prepared](balance_object& b) {
+         b.owner = prepared.owner;
+         b.balance = prepared.balance;
+         b.vesting_policy = std::move(prepared.vesting_policy);
       });
 
-      total_supplies[ asset_id ] += vest.amount;
+      total_supplies[ prepared.balance.asset_id ] += prepared.balance.amount;
    }
+   vector<balance_object>().swap( initial_vesting_balances );
+   finish_genesis_phase( "initial vesting balances", genesis_state.initial_vesting_balances.size() );
 
    if( total_supplies[ asset_id_type(0) ] > 0 )
    {
@@ -1115,6 +1208,9 @@ void database::init_genesis(const genesis_state_type& genesis_state)
    });
 
    FC_ASSERT( get_index<fba_accumulator_object>().get_next_id() == fba_accumulator_id_type( fba_accumulator_id_count ) );
+   finish_genesis_phase( "supplies, witnesses, committee members and workers",
+                         genesis_state.initial_witness_candidates.size() + genesis_state.initial_committee_candidates.size()
+                         + genesis_state.initial_worker_candidates.size() );
 
    debug_dump();
 
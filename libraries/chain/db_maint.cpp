@@ -47,6 +47,8 @@
 #include <graphene/chain/witness_schedule_object.hpp>
 #include <graphene/chain/worker_object.hpp>
 
+#include <fc/thread/parallel.hpp>
+
 #include <numeric>
 
 namespace graphene { namespace chain {
@@ -1120,7 +1122,9 @@ void create_buyback_orders( database& db )
          continue;
       }
 
-      for( const auto& entry : bal_idx.get_account_balances( buyback_account.id ) )
+      // the orders below may add balances to the account, so walk a copy of its balance table
+      const auto balances = bal_idx.get_account_balances( buyback_account.id );
+      for( const auto& entry : balances )
       {
          const auto* it = entry.second;
          asset_id_type asset_to_sell = it->asset_type;
@@ -1220,16 +1224,10 @@ uint32_t database::get_gpos_current_subperiod()
    const auto now = this->head_block_time();
    auto seconds_since_period_start = now.sec_since_epoch() - period_start.sec_since_epoch();
 
-   // get in what sub period we are
+   // get in what sub period we are, subperiods being numbered from 1
    uint32_t current_subperiod = 0;
-   std::list<uint32_t> period_list(number_of_subperiods);
-   std::iota(period_list.begin(), period_list.end(), 1);
-
-   std::for_each(period_list.begin(), period_list.end(),[&](uint32_t period) {
-      if(seconds_since_period_start >= vesting_subperiod * (period - 1) &&
-            seconds_since_period_start < vesting_subperiod * period)
-         current_subperiod = period;
-   });
+   if(seconds_since_period_start < vesting_subperiod * number_of_subperiods)
+      current_subperiod = seconds_since_period_start / vesting_subperiod + 1;
 
    return current_subperiod;
 }
@@ -1272,11 +1270,8 @@ double database::calculate_vesting_factor(const account_object& stake_account)
    double numerator = number_of_subperiods;
 
    if(current_subperiod > 1) {
-      std::list<uint32_t> subperiod_list(current_subperiod - 1);
-      std::iota(subperiod_list.begin(), subperiod_list.end(), 2);
-      subperiod_list.reverse();
-
-      for(auto subperiod: subperiod_list)
+      // walk back from the current subperiod to the second one
+      for(uint32_t subperiod = current_subperiod; subperiod >= 2; --subperiod)
       {
          numerator--;
 
@@ -1381,7 +1376,7 @@ void schedule_pending_dividend_balances(database& db,
 { try {
    dlog("Processing dividend payments for dividend holder asset type ${holder_asset} at time ${t}",
         ("holder_asset", dividend_holder_asset_obj.symbol)("t", db.head_block_time()));
-   auto balance_by_acc_index = db.get_index_type< primary_index< account_balance_index > >().get_secondary_index< balances_by_account_index >();
+   const auto& balance_by_acc_index = db.get_index_type< primary_index< account_balance_index > >().get_secondary_index< balances_by_account_index >();
    auto current_distribution_account_balance_range =
       //balance_index.indices().get<by_account_asset>().equal_range(boost::make_tuple(dividend_data.dividend_distribution_account));
       balance_by_acc_index.get_account_balances(dividend_data.dividend_distribution_account);
@@ -1400,32 +1395,27 @@ void schedule_pending_dividend_balances(database& db,
    uint64_t distribution_base_fee = gpo.parameters.current_fees->get<asset_dividend_distribution_operation>().distribution_base_fee;
    uint32_t distribution_fee_per_holder = gpo.parameters.current_fees->get<asset_dividend_distribution_operation>().distribution_fee_per_holder;
 
-   std::map<account_id_type, share_type> vesting_amounts;
-
    auto balance_type = vesting_balance_type::normal;
    if(db.head_block_time() >= HARDFORK_GPOS_TIME)
       balance_type = vesting_balance_type::gpos;
 
-   uint32_t holder_account_count = 0;
-
-   // get only once a collection of accounts that hold nonzero vesting balances of the dividend asset
+   // get the collection of vesting balances of the dividend asset, only walked when crediting holders
    auto vesting_balances_begin =
       vesting_index.indices().get<by_asset_balance>().lower_bound(boost::make_tuple(dividend_holder_asset_obj.id, balance_type));
    auto vesting_balances_end =
       vesting_index.indices().get<by_asset_balance>().upper_bound(boost::make_tuple(dividend_holder_asset_obj.id, balance_type, share_type()));
 
-   for (const vesting_balance_object& vesting_balance_obj : boost::make_iterator_range(vesting_balances_begin, vesting_balances_end))
-   {
-        vesting_amounts[vesting_balance_obj.owner] += vesting_balance_obj.balance.amount;
-        ++holder_account_count;
-        dlog("Vesting balance for account: ${owner}, amount: ${amount}",
-             ("owner", vesting_balance_obj.owner(db).name)
-             ("amount", vesting_balance_obj.balance.amount));
-   }
+   // holder counts and vesting totals are maintained as balances change, so they cost nothing to read here
+   const auto vesting_totals = db.get_index_type< primary_index< vesting_balance_index > >()
+                                  .get_secondary_index< vesting_balance_totals_index >()
+                                  .get_totals(dividend_holder_asset_obj.id, balance_type);
+   uint32_t holder_account_count = vesting_totals.balance_objects;
 
    auto current_distribution_account_balance_iter = current_distribution_account_balance_range.begin();
    if(db.head_block_time() < HARDFORK_GPOS_TIME)
-      holder_account_count = std::distance(holder_balances_begin, holder_balances_end);
+      holder_account_count = db.get_index_type< primary_index< account_balance_index > >()
+                               .get_secondary_index< balance_counts_by_asset_index >()
+                               .get_balance_counts(dividend_holder_asset_obj.id).balance_objects;
    // the fee, in BTS, for distributing each asset in the account
    uint64_t total_fee_per_asset_in_core = distribution_base_fee + holder_account_count * (uint64_t)distribution_fee_per_holder;
 
@@ -1439,14 +1429,25 @@ void schedule_pending_dividend_balances(database& db,
    // accounts other than the distribution account (it would be silly to distribute dividends back to
    // the distribution account)
    share_type total_balance_of_dividend_asset;
+   std::map<account_id_type, share_type> vesting_amounts;
+   bool holder_stakes_computed = false;
    if(db.head_block_time() >= HARDFORK_GPOS_TIME && dividend_holder_asset_obj.symbol == GRAPHENE_SYMBOL) { // only core
-      for (const vesting_balance_object &holder_balance_object : boost::make_iterator_range(vesting_balances_begin,
-                                                                                            vesting_balances_end))
-         if (holder_balance_object.owner != dividend_data.dividend_distribution_account) {
-            total_balance_of_dividend_asset += holder_balance_object.balance.amount;
-         }
+      total_balance_of_dividend_asset = vesting_totals.amount;
+      auto distribution_account_vesting_range =
+         vesting_index.indices().get<by_account>().equal_range(dividend_data.dividend_distribution_account);
+      for (const vesting_balance_object &vesting_balance_obj : boost::make_iterator_range(distribution_account_vesting_range.first,
+                                                                                          distribution_account_vesting_range.second))
+         if (vesting_balance_obj.balance.asset_id == dividend_holder_asset_obj.id && vesting_balance_obj.balance_type == balance_type)
+            total_balance_of_dividend_asset -= vesting_balance_obj.balance.amount;
+      holder_stakes_computed = true;
    }
-   else {
+   // otherwise a holder's stake joins their liquid and vesting balances; that needs a walk over all holders,
+   // so it is only done once a payout is actually due.  Crediting doesn't move holders' dividend asset balances.
+   auto compute_holder_stakes = [&]() {
+      if (holder_stakes_computed)
+         return;
+      for (const vesting_balance_object& vesting_balance_obj : boost::make_iterator_range(vesting_balances_begin, vesting_balances_end))
+         vesting_amounts[vesting_balance_obj.owner] += vesting_balance_obj.balance.amount;
       for (const account_balance_object &holder_balance_object : boost::make_iterator_range(holder_balances_begin,
                                                                                             holder_balances_end))
          if (holder_balance_object.owner != dividend_data.dividend_distribution_account) {
@@ -1455,7 +1456,8 @@ void schedule_pending_dividend_balances(database& db,
             if (itr != vesting_amounts.end())
                total_balance_of_dividend_asset += itr->second;
          }
-   }
+      holder_stakes_computed = true;
+   };
    // loop through all of the assets currently or previously held in the distribution account
    while (current_distribution_account_balance_iter != current_distribution_account_balance_range.end() ||
           previous_distribution_account_balance_iter != previous_distribution_account_balance_range.second)
@@ -1574,6 +1576,7 @@ void schedule_pending_dividend_balances(database& db,
                   delta_balance -= total_fee_per_asset_in_payout_asset;
                }
 
+               compute_holder_stakes();
                dlog("There are ${count} holders of the dividend-paying asset, with a total balance of ${total}",
                     ("count", holder_account_count)
                     ("total", total_balance_of_dividend_asset));
@@ -1742,10 +1745,12 @@ void process_dividend_assets(database& db)
    const total_distributed_dividend_balance_object_index& distributed_dividend_balance_index = db.get_index_type<total_distributed_dividend_balance_object_index>();
    const pending_dividend_payout_balance_for_holder_object_index& pending_payout_balance_index = db.get_index_type<pending_dividend_payout_balance_for_holder_object_index>();
 
-   // TODO: switch to iterating over only dividend assets (generalize the by_type index)
-   for( const asset_object& dividend_holder_asset_obj : db.get_index_type<asset_index>().indices() )
-      if (dividend_holder_asset_obj.dividend_data_id)
+   // copied, the payouts below must not disturb the iteration
+   const flat_set<asset_id_type> dividend_assets = db.get_index_type< primary_index< asset_index > >()
+                                   .get_secondary_index< dividend_assets_index >().get_dividend_assets();
+   for( const asset_id_type dividend_holder_asset_id : dividend_assets )
       {
+         const asset_object& dividend_holder_asset_obj = dividend_holder_asset_id(db);
          const asset_dividend_data_object& dividend_data = dividend_holder_asset_obj.dividend_data(db);
          const account_object& dividend_distribution_account_object = dividend_data.dividend_distribution_account(db);
 
@@ -2066,19 +2071,58 @@ void database::perform_chain_maintenance(const signed_block& next_block, const g
       const global_property_object& props;
       std::map<account_id_type, share_type> vesting_amounts;
 
+      /// Once the GPOS ramp-up is over, an account's voting stake only depends on its GPOS vesting balances
+      /// (collected below) and on vote times, none of which account maintenance changes.  The tally can then
+      /// be deferred until after the maintenance pass and spread over several threads.
+      bool defer_tally = false;
+      vector<const account_object*> deferred_accounts;
+
+      struct vote_tally {
+         vector<uint64_t> votes;
+         vector<uint64_t> witness_count_histogram;
+         vector<uint64_t> committee_count_histogram;
+         vector<uint64_t> son_count_histogram;
+         uint64_t total_voting_stake = 0;
+
+         void reset(const global_property_object& props)
+         {
+            votes.assign(props.next_available_vote_id, 0);
+            witness_count_histogram.assign(props.parameters.maximum_witness_count / 2 + 1, 0);
+            committee_count_histogram.assign(props.parameters.maximum_committee_count / 2 + 1, 0);
+            son_count_histogram.assign(props.parameters.maximum_son_count() / 2 + 1, 0);
+            total_voting_stake = 0;
+         }
+
+         void merge(const vote_tally& other)
+         {
+            auto add_to = [](vector<uint64_t>& target, const vector<uint64_t>& source) {
+               for( size_t i = 0; i < target.size(); ++i )
+                  target[i] += source[i];
+            };
+            add_to(votes, other.votes);
+            add_to(witness_count_histogram, other.witness_count_histogram);
+            add_to(committee_count_histogram, other.committee_count_histogram);
+            add_to(son_count_histogram, other.son_count_histogram);
+            total_voting_stake += other.total_voting_stake;
+         }
+      } tally;
+
       vote_tally_helper(database& d, const global_property_object& gpo)
          : d(d), props(gpo)
       {
-         d._vote_tally_buffer.resize(props.next_available_vote_id);
-         d._witness_count_histogram_buffer.resize(props.parameters.maximum_witness_count / 2 + 1);
-         d._committee_count_histogram_buffer.resize(props.parameters.maximum_committee_count / 2 + 1);
-         d._son_count_histogram_buffer.resize(props.parameters.maximum_son_count() / 2 + 1);
-         d._total_voting_stake = 0;
+         // reuse the database's buffers so their storage survives from one maintenance interval to the next
+         tally.votes.swap(d._vote_tally_buffer);
+         tally.witness_count_histogram.swap(d._witness_count_histogram_buffer);
+         tally.committee_count_histogram.swap(d._committee_count_histogram_buffer);
+         tally.son_count_histogram.swap(d._son_count_histogram_buffer);
+         tally.reset(props);
 
          auto balance_type = vesting_balance_type::normal;
          if(d.head_block_time() >= HARDFORK_GPOS_TIME)
             balance_type = vesting_balance_type::gpos;
 
+         defer_tally = d.head_block_time() >= (HARDFORK_GPOS_TIME + props.parameters.gpos_subperiod()/2);
+
          const vesting_balance_index& vesting_index = d.get_index_type<vesting_balance_index>();
 
          auto vesting_balances_begin =
@@ -2099,98 +2143,143 @@ void database::perform_chain_maintenance(const signed_block& next_block, const g
       {
          if( props.parameters.count_non_member_votes || stake_account.is_member(d.head_block_time()) )
          {
-            // There may be a difference between the account whose stake is voting and the one specifying opinions.
-            // Usually they're the same, but if the stake account has specified a voting_account, that account is the one
-            // specifying the opinions.
-            const account_object* opinion_account_ptr =
-                  (stake_account.options.voting_account ==
-                   GRAPHENE_PROXY_TO_SELF_ACCOUNT)? &stake_account
-                                     : d.find(stake_account.options.voting_account);
-
-            if( !opinion_account_ptr ) // skip non-exist account
-               return;
+            if( defer_tally )
+               deferred_accounts.push_back(&stake_account);
+            else
+               tally_account(stake_account, tally);
+         }
+      }
 
-            const account_object& opinion_account = *opinion_account_ptr;
+      /// Adds the stake of one account to @p result.  Only reads the database, so it is safe to call from
+      /// several threads at once while nothing else is modifying it.
+      void tally_account( const account_object& stake_account, vote_tally& result )const
+      {
+         // There may be a difference between the account whose stake is voting and the one specifying opinions.
+         // Usually they're the same, but if the stake account has specified a voting_account, that account is the one
+         // specifying the opinions.
+         const account_object* opinion_account_ptr =
+               (stake_account.options.voting_account ==
+                GRAPHENE_PROXY_TO_SELF_ACCOUNT)? &stake_account
+                                  : d.find(stake_account.options.voting_account);
+
+         if( !opinion_account_ptr ) // skip non-exist account
+            return;
 
-            const auto& stats = stake_account.statistics(d);
-            uint64_t voting_stake = 0;
+         const account_object& opinion_account = *opinion_account_ptr;
 
-            auto itr = vesting_amounts.find(stake_account.id);
-            if (itr != vesting_amounts.end())
-                voting_stake += itr->second.value;
+         const auto& stats = stake_account.statistics(d);
+         uint64_t voting_stake = 0;
 
-            if(d.head_block_time() >= HARDFORK_GPOS_TIME)
-            {
-               if (itr == vesting_amounts.end() && d.head_block_time() >= (HARDFORK_GPOS_TIME + props.parameters.gpos_subperiod()/2))
-                  return;
+         auto itr = vesting_amounts.find(stake_account.id);
+         if (itr != vesting_amounts.end())
+             voting_stake += itr->second.value;
+
+         if(d.head_block_time() >= HARDFORK_GPOS_TIME)
+         {
+            if (itr == vesting_amounts.end() && d.head_block_time() >= (HARDFORK_GPOS_TIME + props.parameters.gpos_subperiod()/2))
+               return;
 
-               auto vesting_factor = d.calculate_vesting_factor(stake_account);
-               voting_stake = (uint64_t)floor(voting_stake * vesting_factor);
+            auto vesting_factor = d.calculate_vesting_factor(stake_account);
+            voting_stake = (uint64_t)floor(voting_stake * vesting_factor);
 
-               //Include votes(based on stake) for the period of gpos_subperiod()/2 as system has zero votes on GPOS activation
-               if(d.head_block_time() < (HARDFORK_GPOS_TIME + props.parameters.gpos_subperiod()/2))
-               {
-                  voting_stake += stats.total_core_in_orders.value
-                                 + (stake_account.cashback_vb.valid() ? (*stake_account.cashback_vb)(d).balance.amount.value : 0)
-                                 + d.get_balance(stake_account.get_id(), asset_id_type()).amount.value;
-               }
-            }
-            else
+            //Include votes(based on stake) for the period of gpos_subperiod()/2 as system has zero votes on GPOS activation
+            if(d.head_block_time() < (HARDFORK_GPOS_TIME + props.parameters.gpos_subperiod()/2))
             {
                voting_stake += stats.total_core_in_orders.value
-                               + (stake_account.cashback_vb.valid() ? (*stake_account.cashback_vb)(d).balance.amount.value : 0)
-                               + d.get_balance(stake_account.get_id(), asset_id_type()).amount.value;
-            }
-
-            for( vote_id_type id : opinion_account.options.votes )
-            {
-               uint32_t offset = id.instance();
-               // if they somehow managed to specify an illegal offset, ignore it.
-               if( offset < d._vote_tally_buffer.size() )
-                  d._vote_tally_buffer[offset] += voting_stake;
+                              + (stake_account.cashback_vb.valid() ? (*stake_account.cashback_vb)(d).balance.amount.value : 0)
+                              + d.get_balance(stake_account.get_id(), asset_id_type()).amount.value;
             }
+         }
+         else
+         {
+            voting_stake += stats.total_core_in_orders.value
+                            + (stake_account.cashback_vb.valid() ? (*stake_account.cashback_vb)(d).balance.amount.value : 0)
+                            + d.get_balance(stake_account.get_id(), asset_id_type()).amount.value;
+         }
 
-            if( opinion_account.options.num_witness <= props.parameters.maximum_witness_count )
-            {
-               uint16_t offset = std::min(size_t(opinion_account.options.num_witness/2),
-                                          d._witness_count_histogram_buffer.size() - 1);
-               // votes for a number greater than maximum_witness_count
-               // are turned into votes for maximum_witness_count.
-               //
-               // in particular, this takes care of the case where a
-               // member was voting for a high number, then the
-               // parameter was lowered.
-               d._witness_count_histogram_buffer[offset] += voting_stake;
-            }
-            if( opinion_account.options.num_committee <= props.parameters.maximum_committee_count )
-            {
-               uint16_t offset = std::min(size_t(opinion_account.options.num_committee/2),
-                                          d._committee_count_histogram_buffer.size() - 1);
-               // votes for a number greater than maximum_committee_count
-               // are turned into votes for maximum_committee_count.
-               //
-               // same rationale as for witnesses
-               d._committee_count_histogram_buffer[offset] += voting_stake;
-            }
-            if( opinion_account.options.num_son <= props.parameters.maximum_son_count() )
-            {
-               uint16_t offset = std::min(size_t(opinion_account.options.num_son/2),
-                                          d._son_count_histogram_buffer.size() - 1);
-               // votes for a number greater than maximum_son_count
-               // are turned into votes for maximum_son_count.
-               //
-               // in particular, this takes care of the case where a
-               // member was voting for a high number, then the
-               // parameter was lowered.
-               d._son_count_histogram_buffer[offset] += voting_stake;
-            }
+         for( vote_id_type id : opinion_account.options.votes )
+         {
+            uint32_t offset = id.instance();
+            // if they somehow managed to specify an illegal offset, ignore it.
+            if( offset < result.votes.size() )
+               result.votes[offset] += voting_stake;
+         }
 
-            d._total_voting_stake += voting_stake;
+         if( opinion_account.options.num_witness <= props.parameters.maximum_witness_count )
+         {
+            uint16_t offset = std::min(size_t(opinion_account.options.num_witness/2),
+                                       result.witness_count_histogram.size() - 1);
+            // votes for a number greater than maximum_witness_count
+            // are turned into votes for maximum_witness_count.
+            //
+            // in particular, this takes care of the case where a
+            // member was voting for a high number, then the
+            // parameter was lowered.
+            result.witness_count_histogram[offset] += voting_stake;
          }
+         if( opinion_account.options.num_committee <= props.parameters.maximum_committee_count )
+         {
+            uint16_t offset = std::min(size_t(opinion_account.options.num_committee/2),
+                                       result.committee_count_histogram.size() - 1);
+            // votes for a number greater than maximum_committee_count
+            // are turned into votes for maximum_committee_count.
+            //
+            // same rationale as for witnesses
+            result.committee_count_histogram[offset] += voting_stake;
+         }
+         if( opinion_account.options.num_son <= props.parameters.maximum_son_count() )
+         {
+            uint16_t offset = std::min(size_t(opinion_account.options.num_son/2),
+                                       result.son_count_histogram.size() - 1);
+            // votes for a number greater than maximum_son_count
+            // are turned into votes for maximum_son_count.
+            //
+            // in particular, this takes care of the case where a
+            // member was voting for a high number, then the
+            // parameter was lowered.
+            result.son_count_histogram[offset] += voting_stake;
+         }
+
+         result.total_voting_stake += voting_stake;
+      }
+
+      /// Tallies the deferred accounts in contiguous ranges in parallel, each into its own buffers which are
+      /// summed at the end.  The sums don't depend on the order of addition, so the result is the same as a
+      /// sequential tally.
+      void tally_deferred_accounts()
+      {
+         const size_t min_accounts_per_range = 4096;
+         const size_t range_count = fc::parallel_range_count(deferred_accounts.size(), min_accounts_per_range);
+
+         // the first range goes straight into the final tally
+         vector<vote_tally> partial_tallies(range_count - 1);
+         for( vote_tally& partial_tally : partial_tallies )
+            partial_tally.reset(props);
+         fc::parallel_for_ranges(deferred_accounts.size(), min_accounts_per_range,
+                                 [this, &partial_tallies](size_t range, size_t begin, size_t end) {
+            vote_tally& result = range == 0 ? tally : partial_tallies[range - 1];
+            for( size_t i = begin; i < end; ++i )
+               tally_account(*deferred_accounts[i], result);
+         });
+
+         for( const vote_tally& partial_tally : partial_tallies )
+            tally.merge(partial_tally);
+      }
+
+      /// Tallies deferred accounts and publishes the result in the database's buffers
+      void finish()
+      {
+         tally_deferred_accounts();
+         d._vote_tally_buffer.swap(tally.votes);
+         d._witness_count_histogram_buffer.swap(tally.witness_count_histogram);
+         d._committee_count_histogram_buffer.swap(tally.committee_count_histogram);
+         d._son_count_histogram_buffer.swap(tally.son_count_histogram);
+         d._total_voting_stake = tally.total_voting_stake;
       }
    } tally_helper(*this, gpo);
 
    perform_account_maintenance( tally_helper );
+   tally_helper.finish();
    struct clear_canary {
       clear_canary(vector<uint64_t>& target): target(target){}
       ~clear_canary() { target.clear(); }
@@ -2272,6 +2361,8 @@ void database::perform_chain_maintenance(const signed_block& next_block, const g
             p.pending_parameters->extensions.value.hbd_asset = p.parameters.extensions.value.hbd_asset;
          if( !p.pending_parameters->extensions.value.hive_asset.valid() )
             p.pending_parameters->extensions.value.hive_asset = p.parameters.extensions.value.hive_asset;
+         if( !p.pending_parameters->extensions.value.betting_positions_settled_per_block.valid() )
+            p.pending_parameters->extensions.value.betting_positions_settled_per_block = p.parameters.extensions.value.betting_positions_settled_per_block;
          p.parameters = std::move(*p.pending_parameters);
          p.pending_parameters.reset();
       }
@@ -213,7 +213,7 @@ void database::open(
 
       object_database::open(data_dir);
 
-      _block_id_to_block.open(data_dir / "database" / "block_num_to_block");
+      _block_id_to_block.open(data_dir / "database" / "block_num_to_block", _compress_block_storage);
 
       if( !find(global_property_id_type()) )
          init_genesis(genesis_loader());
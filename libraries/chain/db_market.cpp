@@ -159,11 +159,16 @@ bool database::apply_order(const limit_order_object& new_order_object, bool allo
    const asset_object& sell_asset = get(new_order_object.amount_for_sale().asset_id);
    const asset_object& receive_asset = get(new_order_object.amount_to_receive().asset_id);
 
-   // Possible optimization: We only need to check calls if both are true:
-   //  - The new order is at the front of the book
-   //  - The new order is below the call limit price
-   bool called_some = check_call_orders(sell_asset, allow_black_swan);
-   called_some |= check_call_orders(receive_asset, allow_black_swan);
+   bool called_some = false;
+   if( head_block_time() < HARDFORK_DEX_CALL_CHECK_TIME )
+   {
+      called_some = check_call_orders(sell_asset, allow_black_swan);
+      called_some |= check_call_orders(receive_asset, allow_black_swan);
+   }
+   // Margin positions are checked whenever the books or the feeds change, so a new order can only call positions
+   // in the asset it sells, and only if it is at the front of the book and at or above the call limit
+   else if( is_front_of_callable_book( new_order_object ) )
+      called_some = check_call_orders(sell_asset, allow_black_swan);
    if( called_some && !find_object(order_id) ) // then we were filled by call order
       return true;
 
@@ -178,19 +183,23 @@ bool database::apply_order(const limit_order_object& new_order_object, bool allo
    auto limit_itr = limit_price_idx.lower_bound(max_price.max());
    auto limit_end = limit_price_idx.upper_bound(max_price);
 
+   bool matched_some = false;
    bool finished = false;
    while( !finished && limit_itr != limit_end )
    {
       auto old_limit_itr = limit_itr;
       ++limit_itr;
+      matched_some = true;
       // match returns 2 when only the old order was fully filled. In this case, we keep matching; otherwise, we stop.
       finished = (match(new_order_object, *old_limit_itr, old_limit_itr->sell_price) != 2);
    }
 
-   //Possible optimization: only check calls if the new order completely filled some old order
-   //Do I need to check both assets?
-   check_call_orders(sell_asset, allow_black_swan);
-   check_call_orders(receive_asset, allow_black_swan);
+   // If nothing matched, the books are exactly as they were when the calls were last checked
+   if( matched_some )
+   {
+      check_call_orders(sell_asset, allow_black_swan);
+      check_call_orders(receive_asset, allow_black_swan);
+   }
 
    const limit_order_object* updated_order_object = find< limit_order_object >( order_id );
    if( updated_order_object == nullptr )
@@ -203,6 +212,22 @@ bool database::apply_order(const limit_order_object& new_order_object, bool allo
    return maybe_cull_small_order( *this, *updated_order_object );
 }
 
+bool database::is_front_of_callable_book( const limit_order_object& order, bool at_call_limit )const
+{
+   const auto& call_limits = get_index_type< primary_index< asset_bitasset_data_index > >()
+                                .get_secondary_index< bitasset_call_limit_index >();
+   const price* call_limit = call_limits.get_call_limit( order.sell_price.base.asset_id );
+   if( call_limit == nullptr || call_limit->quote.asset_id != order.sell_price.quote.asset_id )
+      return false;
+   // the book is sorted from greatest to least, orders below the call limit are never matched against calls
+   if( at_call_limit && order.sell_price < *call_limit )
+      return false;
+
+   const auto& limit_price_idx = get_index_type<limit_order_index>().indices().get<by_price>();
+   auto front = limit_price_idx.lower_bound( price::max( order.sell_price.base.asset_id, order.sell_price.quote.asset_id ) );
+   return front != limit_price_idx.end() && front->id == order.id;
+}
+
 /**
  *  Matches the two orders,
  *
@@ -448,7 +473,9 @@ bool database::check_call_orders( const asset_object& mia, bool enable_black_swa
     // looking for limit orders selling the most USD for the least CORE
     auto max_price = price::max( mia.id, bitasset.options.short_backing_asset );
     // stop when limit orders are selling too little USD for too much CORE
-    auto min_price = bitasset.current_feed.max_short_squeeze_price();
+    const price* call_limit = get_index_type< primary_index< asset_bitasset_data_index > >()
+                                 .get_secondary_index< bitasset_call_limit_index >().get_call_limit( mia.id );
+    auto min_price = call_limit ? *call_limit : bitasset.current_feed.max_short_squeeze_price();
 
     assert( max_price.base.asset_id == min_price.base.asset_id );
     // NOTE limit_price_index is sorted from greatest to least
@@ -583,17 +583,21 @@ void process_finished_matches(database& db)
 {
 }
 
-void process_in_progress_tournaments(database& db)
+void process_in_progress_tournaments(database& db, tournament_match_changes_index& match_changes)
 {
-   auto& start_time_index = db.get_index_type<tournament_index>().indices().get<by_start_time>();
-   auto start_iter = start_time_index.lower_bound(boost::make_tuple(tournament_state::in_progress));
-   while (start_iter != start_time_index.end() &&
-          start_iter->get_state() == tournament_state::in_progress)
+   // check_for_new_matches_to_start only depends on the state of the tournament's matches and
+   // repeating it without any match changes has no effect, so only tournaments whose matches
+   // changed since the last pass need to be visited
+   vector<tournament_id_type> tournaments_to_check(match_changes.tournaments_with_changed_matches.begin(),
+                                                   match_changes.tournaments_with_changed_matches.end());
+   for (const tournament_id_type& tournament_id : tournaments_to_check)
    {
-      auto next_iter = std::next(start_iter);
-      start_iter->check_for_new_matches_to_start(db);
-      start_iter = next_iter;
+      const tournament_object* tournament_obj = db.find(tournament_id);
+      if (tournament_obj && tournament_obj->get_state() == tournament_state::in_progress)
+         tournament_obj->check_for_new_matches_to_start(db);
    }
+   // this also drops the entries added by the checks above, which would find nothing new to do
+   match_changes.tournaments_with_changed_matches.clear();
 }
 
 void cancel_expired_tournaments(database& db)
@@ -676,7 +680,7 @@ void database::update_tournaments()
    process_finished_matches(*this);
    cancel_expired_tournaments(*this);
    start_fully_registered_tournaments(*this);
-   process_in_progress_tournaments(*this);
+   process_in_progress_tournaments(*this, get_mutable_index_type< primary_index<match_index> >().get_secondary_index<tournament_match_changes_index>());
    initiate_next_round_of_matches(*this);
    initiate_next_games(*this);
 }
@@ -700,9 +704,51 @@ void process_settled_betting_markets(database& db, fc::time_point_sec current_bl
    }
 }
 
+betting_market_settlement_statistics process_settled_betting_markets_incrementally(database& db, fc::time_point_sec current_block_time)
+{
+   // same as above, but the payouts done in one block are bounded.  Groups are settled in order of
+   // their settling time; a group that doesn't fit in this block's budget stays at the front of the
+   // queue and is resumed in the next block.
+   fc::time_point start = fc::time_point::now();
+   betting_market_settlement_statistics statistics;
+   statistics.block_num = db.head_block_num();
+
+   const uint32_t max_positions_per_block = db.get_global_properties().parameters.betting_positions_settled_per_block();
+   uint32_t positions_budget = max_positions_per_block;
+
+   const auto& betting_market_group_index = db.get_index_type<betting_market_group_object_index>().indices().get<by_settling_time>();
+   const auto first_due_group = betting_market_group_index.upper_bound(fc::optional<fc::time_point_sec>());
+
+   // every due group reaches its final state now, whatever the budget, so that one waiting for its payouts
+   // can't be canceled through its event after its settling time
+   for (auto iter = first_due_group; iter != betting_market_group_index.end() && *iter->settling_time <= current_block_time; ++iter)
+      db.start_settling_betting_market_group(*iter);
+
+   auto betting_market_group_iter = first_due_group;
+   while (betting_market_group_iter != betting_market_group_index.end() &&
+          *betting_market_group_iter->settling_time <= current_block_time)
+   {
+      auto next_iter = std::next(betting_market_group_iter);
+      if (positions_budget == 0)
+         ++statistics.groups_pending;
+      else if (db.settle_betting_market_group_incrementally(*betting_market_group_iter, positions_budget))
+         ++statistics.groups_settled;
+      else
+         ++statistics.groups_pending;
+      betting_market_group_iter = next_iter;
+   }
+
+   statistics.positions_settled = max_positions_per_block - positions_budget;
+   statistics.settlement_time_us = (fc::time_point::now() - start).count();
+   return statistics;
+}
+
 void database::update_betting_markets(fc::time_point_sec current_block_time)
 {
-   process_settled_betting_markets(*this, current_block_time);
+   if (current_block_time < HARDFORK_BMG_SETTLEMENT_TIME)
+      process_settled_betting_markets(*this, current_block_time);
+   else
+      _betting_market_settlement_statistics = process_settled_betting_markets_incrementally(*this, current_block_time);
    remove_completed_events();
 }
 
@@ -48,6 +48,7 @@ namespace graphene { namespace chain {
    FC_IMPLEMENT_DERIVED_EXCEPTION( unlinkable_block_exception,   chain_exception, 3080000, "unlinkable block" )
    FC_IMPLEMENT_DERIVED_EXCEPTION( black_swan_exception,         chain_exception, 3090000, "black swan" )
    FC_IMPLEMENT_DERIVED_EXCEPTION( plugin_exception,             chain_exception, 3100000, "plugin exception" )
+   FC_IMPLEMENT_DERIVED_EXCEPTION( transaction_rejected_exception, chain_exception, 3110000, "transaction rejected before evaluation" )
 
    FC_IMPLEMENT_DERIVED_EXCEPTION( insufficient_feeds,           chain_exception, 37006, "insufficient feeds" )
 
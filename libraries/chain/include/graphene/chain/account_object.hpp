@@ -26,6 +26,10 @@
 #include <graphene/db/generic_index.hpp>
 #include <graphene/chain/types.hpp>
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/container/flat_set.hpp>
+#include <boost/container/small_vector.hpp>
+
+#include <unordered_map>
 
 namespace graphene { namespace chain {
    class database;
@@ -303,17 +307,6 @@ namespace graphene { namespace chain {
     */
    class account_member_index : public secondary_index
    {
-      /* std::less::operator() is less efficient so using key_compare here.
-       * Let assume that it has two keys key1 and key2 and we want to insert key3.
-       * the insert function needs to first call std::less::operator() with key1 and key3.
-       * Assume std::less::operator()(key1, key3) returns false.
-       * It has to call std::less::operator() again with the keys switched, 
-       * std::less::operator()(key3, key1), to decide whether key1 is equal to key3 or 
-       * key3 is greater than key1. There are two calls to std::less::operator() to make
-       * a decision if the first call returns false.
-       * std::map::insert and std::set used key_compare, 
-       * there would be sufficient information to make the right decision using just one call.
-       */
       class key_compare {
       public:
          inline bool operator()( const public_key_type& a, const public_key_type& b )const
@@ -323,6 +316,23 @@ namespace graphene { namespace chain {
       };
 
       public:
+         /** Accounts referencing a key, account or address.  Nearly always a single account, which is kept inline
+          *  rather than in a separately allocated tree node. */
+         typedef boost::container::flat_set< account_id_type, std::less<account_id_type>,
+                                             boost::container::small_vector<account_id_type, 1> > account_set;
+
+         struct account_hash {
+            size_t operator()( const account_id_type& a )const { return std::hash<uint64_t>()( a.instance.value ); }
+         };
+         /** Keys and addresses come straight from transactions, so they are hashed with a random per-process
+          *  seed; otherwise anyone could pick values that all land in the same bucket. */
+         struct key_hash {
+            size_t operator()( const public_key_type& k )const;
+         };
+         struct address_hash {
+            size_t operator()( const address& a )const;
+         };
+
          virtual void object_loaded( const object& obj ) override;
          virtual void object_created( const object& obj ) override;
          virtual void object_removed( const object& obj ) override;
@@ -331,20 +341,21 @@ namespace graphene { namespace chain {
 
 
          /** given an account or key, map it to the set of accounts that reference it in an active or owner authority */
-         map< account_id_type, set<account_id_type> > account_to_account_memberships;
-         map< public_key_type, set<account_id_type>, key_compare > account_to_key_memberships;
+         std::unordered_map< account_id_type, account_set, account_hash > account_to_account_memberships;
+         std::unordered_map< public_key_type, account_set, key_hash >     account_to_key_memberships;
          /** some accounts use address authorities in the genesis block */
-         map< address, set<account_id_type> >         account_to_address_memberships;
+         std::unordered_map< address, account_set, address_hash >         account_to_address_memberships;
 
 
       protected:
-         set<account_id_type>  get_account_members( const account_object& a )const;
-         set<public_key_type, key_compare>  get_key_members( const account_object& a )const;
-         set<address>          get_address_members( const account_object& a )const;
-
-         set<account_id_type>  before_account_members;
-         set<public_key_type, key_compare>  before_key_members;
-         set<address>          before_address_members;
+         /** members are returned sorted and without duplicates, ready to be diffed against each other */
+         void get_account_members( const account_object& a, vector<account_id_type>& result )const;
+         void get_key_members( const account_object& a, vector<public_key_type>& result )const;
+         void get_address_members( const account_object& a, vector<address>& result )const;
+
+         vector<account_id_type>  before_account_members;
+         vector<public_key_type>  before_key_members;
+         vector<address>          before_address_members;
    };
 
 
@@ -403,17 +414,41 @@ namespace graphene { namespace chain {
          virtual void about_to_modify( const object& before ) override;
          virtual void object_modified( const object& after  ) override;
 
-         const map< asset_id_type, const account_balance_object* >& get_account_balances( const account_id_type& acct )const;
+         /** Adding or removing a balance of the account invalidates iterators into the returned table */
+         const flat_map< asset_id_type, const account_balance_object* >& get_account_balances( const account_id_type& acct )const;
          const account_balance_object* get_account_balance( const account_id_type& acct, const asset_id_type& asset )const;
 
       private:
          static const uint8_t  bits;
          static const uint64_t mask;
 
-         /** Maps each account to its balance objects */
-         vector< vector< map< asset_id_type, const account_balance_object* > > > balances;
+         /** Maps each account to its balance objects; accounts hold few assets, so a sorted table beats a tree */
+         vector< vector< flat_map< asset_id_type, const account_balance_object* > > > balances;
          std::stack< object_id_type > ids_being_modified;
    };
+
+   /**
+    *  @brief This secondary index counts the balance objects of each asset as balances change,
+    *         so holder counts are known without walking the balances.
+    */
+   class balance_counts_by_asset_index : public secondary_index
+   {
+      public:
+         struct balance_counts
+         {
+            /** All balance objects of the asset, including emptied ones */
+            uint64_t balance_objects = 0;
+         };
+
+         virtual void object_loaded( const object& obj ) override;
+         virtual void object_created( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+
+         balance_counts get_balance_counts( const asset_id_type& asset )const;
+
+      private:
+         flat_map< asset_id_type, balance_counts > counts;
+   };
    
    struct by_asset_balance;
    struct by_maintenance_flag;
@@ -303,6 +303,30 @@ namespace graphene { namespace chain {
    //typedef flat_index<asset_bitasset_data_object> asset_bitasset_data_index;
    typedef generic_index<asset_bitasset_data_object, asset_bitasset_data_object_multi_index_type> asset_bitasset_data_index;
 
+   /**
+    *  @brief This secondary index caches the call limit of every market-issued asset whose margin positions can
+    *         currently be called, so the market engine can tell whether a limit order might trigger margin calls
+    *         without recomputing the max short squeeze price of the feed.
+    */
+   class bitasset_call_limit_index : public secondary_index
+   {
+      public:
+         virtual void object_loaded( const object& obj ) override;
+         virtual void object_created( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         /**
+          *  @return the max short squeeze price of the current feed of @p mia, which limit orders selling @p mia
+          *          must reach to be matched against margin positions, or nullptr if its positions can't be called
+          *          (no feed, prediction market or globally settled)
+          */
+         const price* get_call_limit( asset_id_type mia )const;
+
+      private:
+         flat_map< asset_id_type, price > call_limits;
+   };
+
    // used to sort active_lotteries index
    struct lottery_asset_comparer
    {
@@ -366,6 +390,25 @@ namespace graphene { namespace chain {
    > asset_object_multi_index_type;
    typedef generic_index<asset_object, asset_object_multi_index_type> asset_index;
 
+   /**
+    *  @brief This secondary index tracks the assets which pay dividends, so the maintenance
+    *         interval visits them without scanning every asset.
+    */
+   class dividend_assets_index : public secondary_index
+   {
+      public:
+         virtual void object_loaded( const object& obj ) override;
+         virtual void object_created( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         /** Assets with dividend data, in id order */
+         const flat_set< asset_id_type >& get_dividend_assets()const { return dividend_assets; }
+
+      private:
+         flat_set< asset_id_type > dividend_assets;
+   };
+
 
    /**
     *  @brief contains properties that only apply to dividend-paying assets
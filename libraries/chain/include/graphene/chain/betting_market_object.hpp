@@ -31,8 +31,10 @@
 #include <graphene/db/generic_index.hpp>
 
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/functional/hash.hpp>
 
 #include <sstream>
+#include <unordered_map>
 
 namespace graphene { namespace chain {
    class betting_market_object;
@@ -104,6 +106,11 @@ class betting_market_group_object : public graphene::db::abstract_object< bettin
 
       betting_market_group_status get_status() const;
 
+      /// after HARDFORK_BMG_SETTLEMENT_TIME, a group past its settling time may take several blocks to be paid out
+      bool is_settling(fc::time_point_sec now) const {
+        return settling_time.valid() && *settling_time <= now;
+      }
+
       // serialization functions:
       // for serializing to raw, go through a temporary sstream object to avoid
       // having to implement serialization in the header file
@@ -609,6 +616,53 @@ typedef multi_index_container<
       ordered_unique< tag<by_bettor_and_odds>, identity<bet_object>, compare_bet_by_bettor_then_odds > > > bet_object_multi_index_type;
 typedef generic_index<bet_object, bet_object_multi_index_type> bet_object_index;
 
+/**
+ *  @brief This secondary index keeps the open bets of each betting market as an order book
+ *
+ *  Each side of a market maps odds to the bets waiting at those odds, in the order by_odds would
+ *  match them (oldest bet id first), along with their total amount.  Delayed bets are kept aside
+ *  until their delay expires.  Matching walks this instead of by_odds, which holds the books of
+ *  every market behind all delayed bets.
+ */
+class bet_order_book_index : public secondary_index
+{
+   public:
+      struct price_level
+      {
+         share_type            total_amount_to_bet;
+         flat_set<bet_id_type> bets;
+      };
+      /// back bets match lowest odds first, lay bets highest odds first
+      typedef std::map<bet_multiplier_type, price_level>                                    back_price_levels;
+      typedef std::map<bet_multiplier_type, price_level, std::greater<bet_multiplier_type>> lay_price_levels;
+
+      struct market_order_book
+      {
+         back_price_levels     back_bets;
+         lay_price_levels      lay_bets;
+         flat_set<bet_id_type> delayed_bets;
+      };
+
+      virtual void object_loaded( const object& obj ) override;
+      virtual void object_created( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after  ) override;
+
+      /** @return the order book of the market, or nullptr if it has no open bets */
+      const market_order_book* get_order_book( betting_market_id_type betting_market_id )const;
+
+      /** @return the next bet on the maker side of the market that a bet at taker_multiplier would match, if any */
+      optional<bet_id_type> get_best_matching_bet( betting_market_id_type betting_market_id, bet_type maker_side,
+                                                   bet_multiplier_type taker_multiplier )const;
+
+   private:
+      void add_bet( const bet_object& bet );
+      void remove_bet( const bet_object& bet );
+
+      std::unordered_map< betting_market_id_type, market_order_book, boost::hash<betting_market_id_type> > order_books;
+};
+
 struct by_bettor_betting_market{};
 struct by_betting_market_bettor{};
 typedef multi_index_container<
@@ -629,6 +683,19 @@ typedef multi_index_container<
 
 typedef generic_index<betting_market_position_object, betting_market_position_multi_index_type> betting_market_position_index;
 
+/**
+ * Betting market group settlement work done while applying the most recent block.
+ * This is only kept in memory for monitoring and is not part of the chain state.
+ */
+struct betting_market_settlement_statistics
+{
+   uint32_t block_num = 0;
+   uint32_t groups_settled = 0;     ///< groups fully paid out and removed in this block
+   uint32_t groups_pending = 0;     ///< groups past their settling time still awaiting payouts after this block
+   uint32_t positions_settled = 0;  ///< betting market positions paid out in this block
+   int64_t  settlement_time_us = 0; ///< time spent on settlement while applying this block
+};
+
 
 template<typename Stream>
 inline Stream& operator<<( Stream& s, const betting_market_object& betting_market_obj )
@@ -733,3 +800,5 @@ FC_REFLECT_DERIVED( graphene::chain::bet_object, (graphene::db::object), (bettor
 
 FC_REFLECT_DERIVED( graphene::chain::betting_market_position_object, (graphene::db::object), (bettor_id)(betting_market_id)(pay_if_payout_condition)(pay_if_not_payout_condition)(pay_if_canceled)(pay_if_not_canceled)(fees_collected) )
 
+FC_REFLECT( graphene::chain::betting_market_settlement_statistics, (block_num)(groups_settled)(groups_pending)(positions_settled)(settlement_time_us) )
+
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <fc/filesystem.hpp>
+
+#include <cstdint>
+
+namespace graphene { namespace chain { namespace block_archive {
+
+   /**
+    * A block archive is a header followed by any number of chunks of consecutive raw-packed blocks, each chunk
+    * compressed with zlib and carrying its own checksum and the ids it starts after and ends with, so that chunks
+    * can be decompressed and verified independently; consecutive chunks must link up.
+    *
+    * Verification only proves that an archive is intact and internally consistent: every block links to its
+    * predecessor and matches its merkle root. Witness signatures and the witness schedule are not checked, as that
+    * takes the chain state, and a node replays imported blocks without checking signatures either. An archive from
+    * an untrusted source can therefore carry any chain, only import archives from a source you trust.
+    */
+
+   /// Writes blocks [first_block, last_block] of the block database in @p blocks_dir to @p archive_path,
+   /// compressing up to @p chunks_in_parallel chunks at once. A @p last_block of 0 means the last stored block.
+   void export_blocks( const fc::path& blocks_dir, const fc::path& archive_path, uint32_t first_block,
+                       uint32_t last_block, uint32_t blocks_per_chunk, uint32_t chunks_in_parallel );
+
+   /// Checks the integrity of the archive at @p archive_path, see above
+   /// @return the number of the last block in the archive
+   uint32_t verify_archive( const fc::path& archive_path, uint32_t chunks_in_parallel );
+
+   /// Verifies the archive at @p archive_path and appends the blocks which extend the block database in
+   /// @p blocks_dir to it. The blocks are not authenticated, see above.
+   /// @return the number of the last block in the block database
+   uint32_t import_blocks( const fc::path& blocks_dir, const fc::path& archive_path, uint32_t chunks_in_parallel );
+
+} } } // graphene::chain::block_archive
@@ -23,6 +23,7 @@
  */
 #pragma once
 #include <fstream>
+#include <future>
 #include <graphene/protocol/block.hpp>
 
 #include <fc/filesystem.hpp>
@@ -31,10 +32,16 @@ namespace graphene { namespace chain {
    struct index_entry;
    using namespace graphene::protocol;
 
+   /**
+    * Stores blocks by number and id. The index holds one fixed-size entry per block number; the blocks themselves
+    * live either in the single legacy "blocks" file or, with segment storage enabled, in per-segment files of
+    * consecutive block numbers. Segments that are entirely irreversible are zlib compressed in the background,
+    * including any of their blocks still in the legacy file, which is deleted once it no longer holds any.
+    */
    class block_database 
    {
       public:
-         void open( const fc::path& dbdir );
+         void open( const fc::path& dbdir, bool segment_storage = false );
          bool is_open()const;
          void flush();
          void close();
@@ -50,12 +57,42 @@ namespace graphene { namespace chain {
          optional<block_id_type> last_id()const;
 	 
          void set_replay_mode(bool mode);
+
+         /**
+          * With segment storage enabled, finishes a completed background compression and starts compressing the
+          * oldest uncompressed segment if all of its blocks are at or below last_irreversible_block_num.
+          */
+         void compact( uint32_t last_irreversible_block_num );
       private:
          bool replay_mode = false;
 
          optional<index_entry> last_index_entry()const;
+         bool read_block_data( const index_entry& e, vector<char>& data )const;
+         bool read_compressed_block_data( uint32_t segment, uint32_t block_num, vector<char>& data )const;
+         std::fstream& segment_blocks_for_write( uint32_t segment );
+         std::istream& segment_blocks_for_read( uint32_t segment )const;
+         void finish_compaction();
+
          fc::path _index_filename;
+         fc::path _blocks_filename;
          mutable std::fstream _blocks;
          mutable std::fstream _block_num_to_pos;
+
+         fc::path _segments_dir;
+         bool _segment_storage = false;
+         bool _compaction_enabled = false;
+         uint32_t _compressed_segments = 0;              ///< segments [0, _compressed_segments) are compressed
+         optional<uint64_t> _legacy_block_count;         ///< block numbers that may still be in the legacy file
+
+         mutable std::fstream _segment_blocks;           ///< segment new blocks are appended to
+         optional<uint32_t> _segment_blocks_num;
+         mutable std::ifstream _read_segment_blocks;     ///< other uncompressed segment being read
+         mutable optional<uint32_t> _read_segment_blocks_num;
+
+         mutable optional<uint32_t> _cached_segment_num; ///< most recently read compressed segment, decompressed
+         mutable vector<std::pair<uint64_t, uint32_t>> _cached_segment_blocks;
+         mutable std::string _cached_segment_payload;
+
+         std::future<void> _compaction;
    };
 } }
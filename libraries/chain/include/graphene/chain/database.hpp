@@ -66,6 +66,19 @@ namespace graphene { namespace chain {
 
    struct budget_record;
 
+   /** Outcome of database::precheck_transaction */
+   enum class transaction_precheck_result : uint8_t
+   {
+      accepted,
+      oversized,           ///< larger than maximum_block_size, so no block could ever include it
+      expired,
+      expiration_too_far,  ///< expires later than maximum_time_until_expiration from now
+      tapos_mismatch,      ///< does not reference a block of our chain
+      invalid,             ///< fails transaction or operation validation
+      duplicate,
+      missing_authority    ///< signatures do not satisfy the required authorities
+   };
+
    /**
     *   @class database
     *   @brief tracks the blockchain state in an extensible manner
@@ -160,6 +173,15 @@ namespace graphene { namespace chain {
          bool _push_block( const signed_block& b );
          processed_transaction _push_transaction( const signed_transaction& trx );
 
+         /**
+          *  Runs the checks of _apply_transaction that do not need its operations to be evaluated, cheapest
+          *  first, without opening an undo session or capturing the transaction in exceptions.  This lets
+          *  junk transactions received from the network be turned away cheaply before push_transaction.
+          *  The signature keys recovered for the authority check are cached in @p trx, so pushing the same
+          *  transaction afterwards does not recover them again.
+          */
+         transaction_precheck_result precheck_transaction( const signed_transaction& trx )const;
+
          ///@throws fc::exception if the proposed transaction fails to apply.
          processed_transaction push_proposal( const proposal_object& proposal );
 
@@ -175,6 +197,29 @@ namespace graphene { namespace chain {
             const fc::ecc::private_key& block_signing_private_key
             );
 
+         /**
+          * Builds the block for the given slot from the pending transactions without signing or pushing it;
+          * generate_block() is assemble_block(), signing and push_assembled_block(). Assembly discards the
+          * pending transaction state; with @p reapply_pending the pending transactions are applied again
+          * afterwards, so that transactions pushed before the block are validated against them. Without it
+          * the state is only rebuilt by the next pushed block, so the block must be pushed straight away.
+          */
+         signed_block assemble_block(
+            const fc::time_point_sec when,
+            witness_id_type witness_id,
+            const fc::ecc::private_key& block_signing_private_key,
+            uint32_t skip,
+            bool reapply_pending = true
+            );
+         /// Pushes a block built by assemble_block() and signed by the caller
+         void push_assembled_block( const signed_block& block, uint32_t skip );
+         signed_block _assemble_block(
+            const fc::time_point_sec when,
+            witness_id_type witness_id,
+            const fc::ecc::private_key& block_signing_private_key
+            );
+         void _push_assembled_block( const signed_block& block );
+
          void pop_block();
          void clear_pending();
 
@@ -475,6 +520,16 @@ namespace graphene { namespace chain {
           */
          bool apply_order(const limit_order_object& new_order_object, bool allow_black_swan = true);
 
+         /**
+          * @return true if @p order sells a market-issued asset whose positions can be called for its backing asset,
+          *         no other order on its book is ahead of it and, if @p at_call_limit is set, it is priced at or
+          *         above the call limit; false otherwise
+          *
+          * Only such an order can be matched against margin positions. The best offer of the book also holds off
+          * a black swan, so removing an order may call positions whenever it was at the front of the book.
+          */
+         bool is_front_of_callable_book( const limit_order_object& order, bool at_call_limit = true )const;
+
          /**
           * Matches the two orders,
           *
@@ -507,6 +562,18 @@ namespace graphene { namespace chain {
          void resolve_betting_market_group(const betting_market_group_object& betting_market_group,
                                            const std::map<betting_market_id_type, betting_market_resolution_type>& resolutions);
          void settle_betting_market_group(const betting_market_group_object& betting_market_group);
+         /// Moves a betting market group whose settling time has passed to its final state, before any payouts
+         void start_settling_betting_market_group(const betting_market_group_object& betting_market_group);
+         /**
+          * @brief Pay out part of a betting market group whose settling time has passed
+          * @param max_positions_to_settle budget of positions to pay out, decreased by the work done
+          * The group must have been passed to start_settling_betting_market_group() first.
+          * @return true if the group is fully settled and has been removed
+          *
+          * Bettors are paid whole, so the budget may be overrun by the number of markets in the group.
+          */
+         bool settle_betting_market_group_incrementally(const betting_market_group_object& betting_market_group,
+                                                        uint32_t& max_positions_to_settle);
          void remove_completed_events();
          /**
           * @brief Process a new bet
@@ -553,6 +620,11 @@ namespace graphene { namespace chain {
           */
          /// Enable or disable tracking of votes of standby witnesses and committee members
          inline void enable_standby_votes_tracking(bool enable)  { _track_standby_votes = enable; }
+         /// Store blocks in segment files and compress irreversible segments; must be set before open()
+         inline void enable_block_storage_compression(bool enable)  { _compress_block_storage = enable; }
+         /// Betting market group settlement work done by the most recently applied block
+         const betting_market_settlement_statistics& get_betting_market_settlement_statistics()const
+         { return _betting_market_settlement_statistics; }
    protected:
          //Mark pop_undo() as protected -- we do not want outside calling pop_undo(); it should call pop_block() instead
          void pop_undo() { object_database::pop_undo(); }
@@ -577,6 +649,9 @@ namespace graphene { namespace chain {
       private:
          void                  _apply_block( const signed_block& next_block );
          processed_transaction _apply_transaction( const signed_transaction& trx );
+         /// @param trx_id id of @p trx when already computed; required unless the dupe check is skipped
+         processed_transaction _apply_transaction( const signed_transaction& trx,
+                                                   const optional<transaction_id_type>& trx_id );
       
          ///Steps involved in applying a new block
          ///@{
@@ -680,6 +755,11 @@ namespace graphene { namespace chain {
          /// Set it to true to provide accurate data to API clients, set to false to have better performance.
          bool                              _track_standby_votes = true;
 
+         /// Whether to store blocks in segments and compress the irreversible ones.
+         bool                              _compress_block_storage = false;
+
+         betting_market_settlement_statistics _betting_market_settlement_statistics;
+
          fc::hash_ctr_rng<secret_hash_type, 20> _random_number_generator;
          bool                              _slow_replays = false;
 
@@ -725,3 +805,7 @@ namespace graphene { namespace chain {
    }
 
 } }
+
+FC_REFLECT_ENUM( graphene::chain::transaction_precheck_result,
+                 (accepted)(oversized)(expired)(expiration_too_far)(tapos_mismatch)(invalid)(duplicate)
+                 (missing_authority) )
@@ -123,6 +123,7 @@ namespace graphene { namespace chain {
    FC_DECLARE_DERIVED_EXCEPTION( unlinkable_block_exception,        chain_exception, 3080000 )
    FC_DECLARE_DERIVED_EXCEPTION( black_swan_exception,              chain_exception, 3090000 )
    FC_DECLARE_DERIVED_EXCEPTION( plugin_exception,                  chain_exception, 3100000 )
+   FC_DECLARE_DERIVED_EXCEPTION( transaction_rejected_exception,    chain_exception, 3110000 )
 
    FC_DECLARE_DERIVED_EXCEPTION( insufficient_feeds,                chain_exception, 37006 )
 
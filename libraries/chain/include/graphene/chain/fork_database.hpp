@@ -41,6 +41,8 @@ namespace graphene { namespace chain {
    {
       fork_item( signed_block d )
       :num(d.block_num()),id(d.id()),data( std::move(d) ){}
+      fork_item( signed_block d, const block_id_type& block_id )
+      :num(d.block_num()),id(block_id),data( std::move(d) ){}
 
       block_id_type previous_id()const { return data.previous; }
 
@@ -93,6 +95,8 @@ namespace graphene { namespace chain {
           *  @return the new head block ( the longest fork )
           */
          shared_ptr<fork_item>            push_block(const signed_block& b);
+         /// As above, for callers which already computed the id of @p b
+         shared_ptr<fork_item>            push_block(const signed_block& b, const block_id_type& id);
          shared_ptr<fork_item>            head()const { return _head; }
          void                             pop_block();
 
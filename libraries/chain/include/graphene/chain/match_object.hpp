@@ -111,6 +111,24 @@ namespace graphene { namespace chain {
    > match_object_multi_index_type;
    typedef generic_index<match_object, match_object_multi_index_type> match_index;
 
+   /**
+    *  @brief This secondary index records which tournaments have had a match created or
+    *  modified since the tournaments were last checked for new matches to start, so the
+    *  per-block tournament update only has to visit those tournaments instead of every
+    *  tournament in progress.  Undoing a change to a match also modifies it, so the set
+    *  remains a superset of the tournaments that need checking across forks.
+    */
+   class tournament_match_changes_index : public secondary_index
+   {
+      public:
+         virtual void object_loaded( const object& obj ) override;
+         virtual void object_created( const object& obj ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         /** tournaments with match changes not yet seen by check_for_new_matches_to_start */
+         flat_set<tournament_id_type> tournaments_with_changed_matches;
+   };
+
    template<typename Stream>
    inline Stream& operator<<( Stream& s, const match_object& match_obj )
    { 
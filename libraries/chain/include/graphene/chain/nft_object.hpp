@@ -5,6 +5,8 @@
 #include <graphene/db/object.hpp>
 #include <graphene/db/generic_index.hpp>
 
+#include <boost/multi_index/ranked_index.hpp>
+
 namespace graphene { namespace chain {
    using namespace graphene::db;
 
@@ -141,22 +143,23 @@ namespace graphene { namespace chain {
    struct by_metadata_and_owner;
    struct by_owner;
    struct by_owner_and_id;
+   // the ranked indices answer "the n-th token of a collection (and owner)" and range sizes in O(log n)
    using nft_multi_index_type = multi_index_container<
       nft_object,
       indexed_by<
          ordered_unique< tag<by_id>,
             member<object, object_id_type, &object::id>
          >,
-         ordered_non_unique< tag<by_metadata>,
+         ranked_non_unique< tag<by_metadata>,
             member<nft_object, nft_metadata_id_type, &nft_object::nft_metadata_id>
          >,
-         ordered_non_unique< tag<by_metadata_and_owner>,
+         ranked_non_unique< tag<by_metadata_and_owner>,
             composite_key<nft_object,
                member<nft_object, nft_metadata_id_type, &nft_object::nft_metadata_id>,
                member<nft_object, account_id_type, &nft_object::owner>
             >
          >,
-         ordered_non_unique< tag<by_owner>,
+         ranked_non_unique< tag<by_owner>,
             member<nft_object, account_id_type, &nft_object::owner>
          >,
          ordered_unique< tag<by_owner_and_id>,
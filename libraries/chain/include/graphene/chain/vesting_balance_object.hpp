@@ -243,6 +243,36 @@ namespace graphene { namespace chain {
     */
    typedef generic_index<vesting_balance_object, vesting_balance_multi_index_type> vesting_balance_index;
 
+   /**
+    *  @brief This secondary index keeps the number and total amount of the vesting balances of
+    *         each asset and balance type up to date as the balances change.
+    */
+   class vesting_balance_totals_index : public secondary_index
+   {
+      public:
+         struct vesting_totals
+         {
+            uint64_t   balance_objects = 0;
+            share_type amount;
+         };
+
+         virtual void object_loaded( const object& obj ) override;
+         virtual void object_created( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void about_to_modify( const object& before ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         vesting_totals get_totals( const asset_id_type& asset, vesting_balance_type balance_type )const;
+
+      private:
+         typedef std::pair< asset_id_type, vesting_balance_type > totals_key;
+
+         void add( const vesting_balance_object& vbo, int64_t sign );
+
+         flat_map< totals_key, vesting_totals > totals;
+         std::stack< std::pair< totals_key, share_type > > balances_being_modified;
+   };
+
 } } // graphene::chain
 
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::vesting_balance_object)
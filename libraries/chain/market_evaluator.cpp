@@ -119,12 +119,20 @@ asset limit_order_cancel_evaluator::do_apply(const limit_order_cancel_operation&
    auto quote_asset = _order->sell_price.quote.asset_id;
    auto refunded = _order->amount_for_sale();
 
-   d.cancel_order(*_order, false /* don't create a virtual op*/);
-
-   // Possible optimization: order can be called by canceling a limit order iff the canceled order was at the top of the book.
-   // Do I need to check calls in both assets?
-   d.check_call_orders(base_asset(d));
-   d.check_call_orders(quote_asset(d));
+   if( d.head_block_time() < HARDFORK_DEX_CALL_CHECK_TIME )
+   {
+      d.cancel_order(*_order, false /* don't create a virtual op*/);
+      d.check_call_orders(base_asset(d));
+      d.check_call_orders(quote_asset(d));
+   }
+   else
+   {
+      // cancelling an order can only call positions if it was the best offer in front of them
+      bool was_front = d.is_front_of_callable_book( *_order, false );
+      d.cancel_order(*_order, false /* don't create a virtual op*/);
+      if( was_front )
+         d.check_call_orders(base_asset(d));
+   }
 
    return refunded;
 } FC_CAPTURE_AND_RETHROW( (o) ) }
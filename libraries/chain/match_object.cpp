@@ -348,6 +348,23 @@ namespace graphene { namespace chain {
    {
       my->state_machine.process_event(game_complete(db, game));
    }
+   void tournament_match_changes_index::object_loaded(const object& obj)
+   {
+      object_created(obj);
+   }
+
+   void tournament_match_changes_index::object_created(const object& obj)
+   {
+      assert( dynamic_cast<const match_object*>(&obj) ); // for debug only
+      const match_object& match = static_cast<const match_object&>(obj);
+      tournaments_with_changed_matches.insert(match.tournament_id);
+   }
+
+   void tournament_match_changes_index::object_modified(const object& after)
+   {
+      object_created(after);
+   }
+
 #if 0
    game_id_type match_object::start_next_game(database& db, match_id_type match_id)
    {
@@ -24,7 +24,7 @@ namespace graphene
             share_type current_supply;
             const auto &idx_lottery_by_md = db.get_index_type<nft_index>().indices().get<by_metadata>();
             auto lottery_range = idx_lottery_by_md.equal_range(id);
-            current_supply = std::distance(lottery_range.first, lottery_range.second);
+            current_supply = idx_lottery_by_md.rank(lottery_range.second) - idx_lottery_by_md.rank(lottery_range.first);
             return current_supply;
         }
 
@@ -44,7 +44,11 @@ struct proposal_operation_hardfork_visitor
    template<typename T>
    void operator()(const T &v) const {}
 
-   void operator()(const committee_member_update_global_parameters_operation &op) const {}
+   void operator()(const committee_member_update_global_parameters_operation &op) const {
+      if (block_time < HARDFORK_BMG_SETTLEMENT_TIME)
+         FC_ASSERT( !op.new_parameters.extensions.value.betting_positions_settled_per_block.valid(),
+                    "betting_positions_settled_per_block not allowed yet!" );
+   }
 
    void operator()(const graphene::chain::tournament_payout_operation &o) const {
       // TODO: move check into tournament_payout_operation::validate after HARDFORK_999_TIME
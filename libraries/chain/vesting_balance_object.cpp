@@ -276,6 +276,52 @@ asset vesting_balance_object::get_allowed_withdraw(const time_point_sec& now)con
    return policy.visit(get_allowed_withdraw_visitor(balance, now, amount));
 }
 
+void vesting_balance_totals_index::object_loaded( const object& obj )
+{
+   object_created(obj);
+}
+
+void vesting_balance_totals_index::object_created( const object& obj )
+{
+   add( dynamic_cast< const vesting_balance_object& >( obj ), 1 );
+}
+
+void vesting_balance_totals_index::object_removed( const object& obj )
+{
+   add( dynamic_cast< const vesting_balance_object& >( obj ), -1 );
+}
+
+void vesting_balance_totals_index::about_to_modify( const object& before )
+{
+   const auto& vbo = dynamic_cast< const vesting_balance_object& >( before );
+   balances_being_modified.emplace( totals_key( vbo.balance.asset_id, vbo.balance_type ), vbo.balance.amount );
+}
+
+void vesting_balance_totals_index::object_modified( const object& after  )
+{
+   const auto& before = balances_being_modified.top();
+   auto& t = totals[before.first];
+   --t.balance_objects;
+   t.amount -= before.second;
+   balances_being_modified.pop();
+   add( dynamic_cast< const vesting_balance_object& >( after ), 1 );
+}
+
+void vesting_balance_totals_index::add( const vesting_balance_object& vbo, int64_t sign )
+{
+   auto& t = totals[totals_key( vbo.balance.asset_id, vbo.balance_type )];
+   t.balance_objects += sign;
+   t.amount += sign * vbo.balance.amount.value;
+}
+
+vesting_balance_totals_index::vesting_totals vesting_balance_totals_index::get_totals( const asset_id_type& asset,
+                                                                                     vesting_balance_type balance_type )const
+{
+   const auto itr = totals.find( totals_key( asset, balance_type ) );
+   if( itr == totals.end() ) return vesting_totals();
+   return itr->second;
+}
+
 } } // graphene::chain
 
 GRAPHENE_EXTERNAL_SERIALIZATION( /*not extern*/, graphene::chain::linear_vesting_policy )
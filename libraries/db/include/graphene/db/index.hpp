@@ -193,6 +193,17 @@ namespace graphene { namespace db {
             FC_THROW_EXCEPTION( fc::assert_exception, "invalid index type" );
          }
 
+         template<typename T>
+         T& get_secondary_index()
+         {
+            for( const auto& item : _sindex )
+            {
+               T* result = dynamic_cast<T*>(item.get());
+               if( result != nullptr ) return *result;
+            }
+            FC_THROW_EXCEPTION( fc::assert_exception, "invalid index type" );
+         }
+
          void delete_secondary_index(const secondary_index& secondary) {
              auto itr = std::find_if(_sindex.begin(), _sindex.end(),
                                      [&secondary](const auto& ptr) { return &secondary == ptr.get(); });
@@ -406,6 +417,15 @@ namespace graphene { namespace db {
          }
 
 
+         /** Used by undo to restore a removed object, secondary indexes see it created again */
+         virtual const object&  insert( object&& obj )override
+         {
+            const auto& result = DerivedIndex::insert( std::move( obj ) );
+            for( const auto& item : _sindex )
+               item->object_created( result );
+            return result;
+         }
+
          virtual const object&  create(const std::function<void(object&)>& constructor )override
          {
             const auto& result = DerivedIndex::create( constructor );
@@ -6,5 +6,6 @@ namespace fc
 {
 
 std::string zlib_compress(const std::string& in);
+std::string zlib_decompress(const std::string& in);
 
 } // namespace fc
@@ -19,11 +19,28 @@ class file_appender : public appender {
             microseconds                       rotation_interval;
             microseconds                       rotation_limit;
             uint32_t                           max_object_depth = FC_MAX_LOG_OBJECT_DEPTH;
+            /// format and write messages on a background thread instead of the logging one
+            bool                               async = false;
+            /// capacity of the async message ring, rounded up to a power of two
+            uint32_t                           async_queue_size = 8192;
+            /// when the ring is full, wait for the writer instead of dropping the message
+            bool                               async_block_when_full = false;
          };
+
+         /// counters of the async mode, all zero in synchronous mode
+         struct async_stats {
+            uint64_t                           queued = 0;
+            uint64_t                           written = 0;
+            uint64_t                           dropped = 0;
+            uint64_t                           blocked = 0;
+         };
+
          file_appender( const variant& args );
          ~file_appender();
          virtual void log( const log_message& m )override;
 
+         async_stats get_async_stats()const;
+
       private:
          class impl;
          std::unique_ptr<impl> my;
@@ -32,4 +49,6 @@ class file_appender : public appender {
 
 #include <fc/reflect/reflect.hpp>
 FC_REFLECT( fc::file_appender::config,
-            (format)(filename)(flush)(rotate)(rotation_interval)(rotation_limit)(max_object_depth) )
+            (format)(filename)(flush)(rotate)(rotation_interval)(rotation_limit)(max_object_depth)
+            (async)(async_queue_size)(async_block_when_full) )
+FC_REFLECT( fc::file_appender::async_stats, (queued)(written)(dropped)(blocked) )
@@ -7,7 +7,10 @@
 #include <fc/network/http/connection.hpp>
 #include <fc/signals.hpp>
 
-namespace fc { namespace http {
+namespace fc {
+   class ostream;
+
+namespace http {
    namespace detail {
       class websocket_server_impl;
       class websocket_tls_server_impl;
@@ -22,6 +25,11 @@ namespace fc { namespace http {
       public:
          virtual ~websocket_connection(){}
          virtual void send_message( const std::string& message ) = 0;
+         /**
+          * Sends the message written to the stream by @p write_message. Implementations may send the beginning of
+          * a long message while the rest is still being written, the default one builds the message first.
+          */
+         virtual void stream_message( const std::function<void(fc::ostream&)>& write_message );
          virtual void close( int64_t code, const std::string& reason  ){};
          void on_message( const std::string& message ) { _on_message(message); }
          fc::http::reply on_http( const std::string& message ) { return _on_http(message); }
@@ -48,6 +56,18 @@ namespace fc { namespace http {
 
    typedef std::function<void(const websocket_connection_ptr&)> on_connection_handler;
 
+   /** How a websocket server compresses and frames the messages it sends */
+   struct websocket_send_options
+   {
+      /// Accept the permessage-deflate extension when a client offers it
+      bool   enable_deflate = true;
+      /// Messages shorter than this are sent uncompressed even if permessage-deflate was negotiated
+      size_t deflate_min_size = 0;
+      /// Streamed messages which are not compressed are sent in frames of at most this many bytes,
+      /// 0 sends every message in a single frame
+      size_t max_frame_size = 0;
+   };
+
    // TODO websocket_tls_server and websocket_server have almost the same interface and implementation,
    //      better refactor to remove duplicate code and to avoid undesired or unnecessary differences
    class websocket_server
@@ -57,6 +77,8 @@ namespace fc { namespace http {
          ~websocket_server();
 
          void on_connection( const on_connection_handler& handler);
+         /// Applies to the connections accepted afterwards
+         void set_send_options( const websocket_send_options& options );
          void listen( uint16_t port );
          void listen( const fc::ip::endpoint& ep );
          uint16_t get_listening_port();
@@ -82,6 +104,8 @@ namespace fc { namespace http {
          ~websocket_tls_server();
 
          void on_connection( const on_connection_handler& handler);
+         /// Applies to the connections accepted afterwards
+         void set_send_options( const websocket_send_options& options );
          void listen( uint16_t port );
          void listen( const fc::ip::endpoint& ep );
          uint16_t get_listening_port();
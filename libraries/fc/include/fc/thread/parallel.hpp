@@ -30,6 +30,12 @@
 
 #include <boost/atomic/atomic.hpp>
 
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <thread>
+#include <vector>
+
 namespace fc {
 
    namespace detail {
@@ -104,4 +110,66 @@ namespace fc {
       detail::get_worker_pool().post( tsk.get() );
       return r;
    }
+
+   /**
+    *  @return the number of ranges parallel_for_ranges() splits <code>count</code> items into: one per
+    *  available thread, but none with fewer than <code>min_per_range</code> items, and at least one
+    */
+   inline size_t parallel_range_count( size_t count, size_t min_per_range )
+   {
+      const size_t max_ranges = count / std::max<size_t>( 1, min_per_range );
+      if( max_ranges <= 1 )
+         return 1;
+      detail::get_worker_pool(); // sizes the pool
+      // the calling thread takes one range, the worker pool the others
+      const size_t threads = std::min<size_t>( std::max( 1u, std::thread::hardware_concurrency() ),
+                                               asio::default_io_service_scope::get_num_threads() + 1u );
+      return std::max<size_t>( 1, std::min( threads, max_ranges ) );
+   }
+
+   /**
+    *  Splits [0, count) into parallel_range_count( count, min_per_range ) consecutive ranges and calls
+    *  <code>f( range, begin, end )</code> for each of them, the first on the calling thread and the others in
+    *  the worker pool.
+    *
+    *  Unlike waiting on the futures of do_parallel, this blocks the calling thread until every range is done
+    *  without yielding, so no other task of the calling fc::thread can run in between.  The first exception
+    *  thrown by <code>f</code> is rethrown once all ranges have finished.
+    */
+   template<typename Functor>
+   void parallel_for_ranges( size_t count, size_t min_per_range, Functor&& f )
+   {
+      const size_t ranges = parallel_range_count( count, min_per_range );
+      const size_t range_size = ranges > 1 ? ( count + ranges - 1 ) / ranges : count;
+      if( ranges == 1 )
+      {
+         f( size_t(0), size_t(0), count );
+         return;
+      }
+
+      std::vector< std::exception_ptr > errors( ranges );
+      std::vector< std::future<void> > done;
+      done.reserve( ranges - 1 );
+      for( size_t range = 1; range < ranges; ++range )
+      {
+         const size_t begin = std::min( count, range * range_size );
+         const size_t end = std::min( count, begin + range_size );
+         auto range_done = std::make_shared< std::promise<void> >();
+         done.push_back( range_done->get_future() );
+         std::exception_ptr* error = &errors[range];
+         do_parallel( [&f, range, begin, end, error, range_done]() {
+            try { f( range, begin, end ); }
+            catch( ... ) { *error = std::current_exception(); }
+            range_done->set_value();
+         }, "parallel_for_ranges" );
+      }
+      try { f( size_t(0), size_t(0), std::min( count, range_size ) ); }
+      catch( ... ) { errors[0] = std::current_exception(); }
+
+      for( std::future<void>& range_done : done )
+         range_done.wait();
+      for( const std::exception_ptr& error : errors )
+         if( error )
+            std::rethrow_exception( error );
+   }
 }
@@ -92,7 +92,32 @@ namespace fc {
       boost::atomic<int32_t>        _retain_count;
   };
 
+  /** Counters of the task object pool, summed over all threads */
+  struct task_allocation_stats {
+     uint64_t allocated = 0; ///< task objects allocated from the heap
+     uint64_t recycled  = 0; ///< task objects placed in memory of a previously freed task
+  };
+  task_allocation_stats get_task_allocation_stats();
+
+  /** How many freed task objects of each size class a thread keeps for reuse, 256 by default */
+  void set_task_pool_limit( uint32_t limit );
+
   namespace detail {
+    void* allocate_task( size_t size );
+    void  free_task( void* p, size_t size );
+
+    /** Allocates tasks, together with their shared_ptr control block, from a per-thread free list */
+    template<typename T>
+    struct task_allocator {
+      typedef T value_type;
+      task_allocator() = default;
+      template<typename U> task_allocator( const task_allocator<U>& ) {}
+      T*   allocate( size_t n ) { return static_cast<T*>( allocate_task( n * sizeof(T) ) ); }
+      void deallocate( T* p, size_t n ) { free_task( p, n * sizeof(T) ); }
+      template<typename U> bool operator==( const task_allocator<U>& )const { return true; }
+      template<typename U> bool operator!=( const task_allocator<U>& )const { return false; }
+    };
+
     template<typename T>
     struct functor_destructor {
       static void destroy( void* v ) { ((T*)v)->~T(); }
@@ -114,6 +139,7 @@ namespace fc {
 
   template<typename R,uint64_t FunctorSize=64>
   class task : virtual public task_base, virtual public promise<R> {
+      struct construct_tag {};
     public:
       typedef std::shared_ptr<task<R,FunctorSize>> ptr;
 
@@ -122,12 +148,13 @@ namespace fc {
       template<typename Functor>
       static ptr create( Functor&& f, const char* desc )
       {
-         return ptr( new task<R,FunctorSize>( std::move(f), desc ) );
+         return std::allocate_shared< task<R,FunctorSize> >( detail::task_allocator< task<R,FunctorSize> >(),
+                                                              construct_tag(), std::move(f), desc );
       }
       virtual void cancel(const char* reason FC_CANCELATION_REASON_DEFAULT_ARG) override { task_base::cancel(reason); }
-    private:
+      /// only reachable through create(), public so that allocate_shared can construct the task
       template<typename Functor>
-      task( Functor&& f, const char* desc ):promise_base(desc), task_base(&_functor), promise<R>(desc) {
+      task( construct_tag, Functor&& f, const char* desc ):promise_base(desc), task_base(&_functor), promise<R>(desc) {
         typedef typename std::remove_const_t< std::remove_reference_t<Functor> > FunctorType;
         static_assert( sizeof(f) <= sizeof(_functor), "sizeof(Functor) is larger than FunctorSize" );
         new ((char*)&_functor) FunctorType( std::forward<Functor>(f) );
@@ -137,11 +164,13 @@ namespace fc {
         _run_functor  = &detail::functor_run<FunctorType>::run;
       }
 
+    private:
       alignas(double) char _functor[FunctorSize];
   };
 
   template<uint64_t FunctorSize>
   class task<void,FunctorSize> : public task_base, public promise<void> {
+      struct construct_tag {};
     public:
       typedef std::shared_ptr<task<void,FunctorSize>> ptr;
 
@@ -150,12 +179,13 @@ namespace fc {
       template<typename Functor>
       static ptr create( Functor&& f, const char* desc )
       {
-         return ptr( new task<void,FunctorSize>( std::move(f), desc ) );
+         return std::allocate_shared< task<void,FunctorSize> >( detail::task_allocator< task<void,FunctorSize> >(),
+                                                                 construct_tag(), std::move(f), desc );
       }
       virtual void cancel(const char* reason FC_CANCELATION_REASON_DEFAULT_ARG) override { task_base::cancel(reason); }
-    private:
+      /// only reachable through create(), public so that allocate_shared can construct the task
       template<typename Functor>
-      task( Functor&& f, const char* desc ):promise_base(desc), task_base(&_functor), promise<void>(desc) {
+      task( construct_tag, Functor&& f, const char* desc ):promise_base(desc), task_base(&_functor), promise<void>(desc) {
         typedef typename std::remove_const_t< std::remove_reference_t<Functor> > FunctorType;
         static_assert( sizeof(f) <= sizeof(_functor), "sizeof(Functor) is larger than FunctorSize"  );
         new ((char*)&_functor) FunctorType( std::forward<Functor>(f) );
@@ -165,6 +195,7 @@ namespace fc {
         _run_functor  = &detail::void_functor_run<FunctorType>::run;
       }
 
+    private:
       alignas(double) char _functor[FunctorSize];
   };
 
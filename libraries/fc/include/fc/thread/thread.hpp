@@ -38,6 +38,15 @@ namespace fc {
 
   class thread {
     public:
+      /** Context (coroutine stack) counters of a thread, for diagnostics */
+      struct context_stats {
+         uint64_t contexts_created  = 0; ///< contexts allocated along with their stack
+         uint64_t context_pool_hits = 0; ///< times an idle context was reused instead of allocating one
+         uint64_t context_switches  = 0;
+         uint64_t contexts_released = 0; ///< idle contexts freed because of the idle context limit
+         uint32_t idle_contexts     = 0; ///< contexts currently waiting to be reused
+      };
+
       thread( const std::string& name = "", thread_idle_notifier* notifier = 0 );
       thread( thread&& m ) = delete;
       thread& operator=(thread&& t ) = delete;
@@ -144,6 +153,16 @@ namespace fc {
       bool is_current()const;
      
       priority current_priority()const;
+
+      /** May be called from any thread; the counters are updated by this thread without synchronization */
+      context_stats get_context_stats()const;
+
+      /**
+       *  Idle contexts are kept for reuse so that new tasks do not allocate a stack.  Contexts beyond
+       *  @p limit are freed when the thread next goes idle; unlimited by default.
+       */
+      void set_idle_context_limit( uint32_t limit );
+
       ~thread();
 
        template<typename T1, typename T2>
@@ -1,4 +1,5 @@
 #include <fc/compress/zlib.hpp>
+#include <fc/exception/exception.hpp>
 
 #include "miniz.c"
 
@@ -12,4 +13,21 @@ namespace fc
     free(compressed_message);
     return result;
   }
+
+  std::string zlib_decompress(const std::string& in)
+  {
+    size_t decompressed_message_length;
+    char* decompressed_message = (char*)tinfl_decompress_mem_to_heap(in.c_str(), in.size(), &decompressed_message_length, TINFL_FLAG_PARSE_ZLIB_HEADER);
+    if (decompressed_message == nullptr)
+    {
+      // a null buffer is also returned for a valid stream that inflates to nothing
+      char empty;
+      FC_ASSERT(tinfl_decompress_mem_to_mem(&empty, 0, in.c_str(), in.size(), TINFL_FLAG_PARSE_ZLIB_HEADER) == 0,
+                "zlib data is corrupt");
+      return std::string();
+    }
+    std::string result(decompressed_message, decompressed_message_length);
+    free(decompressed_message);
+    return result;
+  }
 }
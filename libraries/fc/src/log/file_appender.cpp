@@ -1,18 +1,98 @@
 #include <fc/exception/exception.hpp>
 #include <fc/io/fstream.hpp>
 #include <fc/log/file_appender.hpp>
+#include <fc/optional.hpp>
 #include <fc/reflect/variant.hpp>
 #include <fc/thread/scoped_lock.hpp>
 #include <fc/thread/thread.hpp>
 #include <fc/variant.hpp>
 #include <boost/thread/mutex.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iomanip>
+#include <mutex>
 #include <queue>
 #include <sstream>
 #include <iostream>
+#include <thread>
 
 namespace fc {
 
+   /**
+    * Bounded multi-producer, single-consumer ring of log messages.  Producers claim a slot with a CAS on the
+    * enqueue position and publish it through the slot sequence, so logging threads never take a lock.
+    */
+   class log_message_ring
+   {
+      public:
+         explicit log_message_ring( uint32_t capacity )
+         {
+            size_t size = 2;
+            while( size < capacity )
+               size <<= 1;
+            _mask = size - 1;
+            _slots.reset( new slot[size] );
+            for( size_t i = 0; i < size; ++i )
+               _slots[i].sequence.store( i, std::memory_order_relaxed );
+         }
+
+         bool try_push( const log_message& m )
+         {
+            uint64_t pos = _enqueue_pos.load( std::memory_order_relaxed );
+            for(;;)
+            {
+               slot& s = _slots[pos & _mask];
+               const int64_t diff = int64_t( s.sequence.load( std::memory_order_acquire ) ) - int64_t( pos );
+               if( diff == 0 )
+               {
+                  if( _enqueue_pos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+                  {
+                     s.message = m;
+                     s.sequence.store( pos + 1, std::memory_order_release );
+                     return true;
+                  }
+               }
+               else if( diff < 0 )
+                  return false;
+               else
+                  pos = _enqueue_pos.load( std::memory_order_relaxed );
+            }
+         }
+
+         /// only called by the writer thread
+         bool try_pop( log_message& m )
+         {
+            slot& s = _slots[_dequeue_pos & _mask];
+            if( int64_t( s.sequence.load( std::memory_order_acquire ) ) - int64_t( _dequeue_pos + 1 ) < 0 )
+               return false;
+            m = *s.message;
+            s.message.reset();
+            s.sequence.store( _dequeue_pos + _mask + 1, std::memory_order_release );
+            ++_dequeue_pos;
+            return true;
+         }
+
+         /// only called by the writer thread
+         bool empty()const
+         {
+            const slot& s = _slots[_dequeue_pos & _mask];
+            return int64_t( s.sequence.load( std::memory_order_acquire ) ) - int64_t( _dequeue_pos + 1 ) < 0;
+         }
+
+      private:
+         struct slot
+         {
+            std::atomic<uint64_t>   sequence;
+            optional<log_message>   message;
+         };
+
+         std::unique_ptr<slot[]>    _slots;
+         uint64_t                   _mask = 0;
+         std::atomic<uint64_t>      _enqueue_pos{ 0 };
+         uint64_t                   _dequeue_pos = 0;
+   };
+
    class file_appender::impl
    {
       public:
@@ -20,12 +100,24 @@ namespace fc {
          ofstream                   out;
          boost::mutex               slock;
 
+         std::unique_ptr<log_message_ring> queue;
+         std::atomic<uint64_t>      queued{ 0 };
+         std::atomic<uint64_t>      written{ 0 };
+         std::atomic<uint64_t>      dropped{ 0 };
+         std::atomic<uint64_t>      blocked{ 0 };
+
       private:
          future<void>               _deletion_task;
          boost::atomic<int64_t>     _current_file_number;
          const int64_t              _interval_seconds;
          time_point                 _next_file_time;
 
+         std::thread                _writer;
+         std::mutex                 _wakeup_mutex;
+         std::condition_variable    _wakeup;
+         std::atomic<bool>          _writer_idle{ false };
+         std::atomic<bool>          _stopping{ false };
+
       public:
          impl( const config& c) : cfg( c ), _interval_seconds( cfg.rotation_interval.to_seconds() )
          {
@@ -48,10 +140,22 @@ namespace fc {
             {
                std::cerr << "error opening log file: " << cfg.filename.preferred_string() << "\n";
             }
+
+            if( cfg.async )
+            {
+               queue.reset( new log_message_ring( cfg.async_queue_size ) );
+               _writer = std::thread( [this]() { write_loop(); } );
+            }
          }
 
          ~impl()
          {
+            if( _writer.joinable() )
+            {
+               _stopping.store( true );
+               wake_writer();
+               _writer.join();
+            }
             try
             {
               _deletion_task.cancel_and_wait("file_appender is destructing");
@@ -61,6 +165,117 @@ namespace fc {
             }
          }
 
+         void enqueue( const log_message& m )
+         {
+            if( !queue->try_push( m ) )
+            {
+               if( !cfg.async_block_when_full )
+               {
+                  dropped.fetch_add( 1, std::memory_order_relaxed );
+                  return;
+               }
+               blocked.fetch_add( 1, std::memory_order_relaxed );
+               do
+               {
+                  wake_writer();
+                  std::this_thread::yield();
+               } while( !queue->try_push( m ) );
+            }
+            queued.fetch_add( 1, std::memory_order_relaxed );
+            if( _writer_idle.load() )
+               wake_writer();
+         }
+
+         std::string format_line( const log_message& m )const
+         {
+            std::stringstream line;
+            line << string(m.get_context().get_timestamp()) << " ";
+            line << std::setw( 21 ) << (m.get_context().get_thread_name().substr(0,9) + string(":") + m.get_context().get_task_name()).c_str() << " ";
+
+            string method_name = m.get_context().get_method();
+            // strip all leading scopes...
+            if( method_name.size() )
+            {
+               uint32_t p = 0;
+               for( uint32_t i = 0;i < method_name.size(); ++i )
+               {
+                   if( method_name[i] == ':' ) p = i;
+               }
+
+               if( method_name[p] == ':' )
+                 ++p;
+               line << std::setw( 20 ) << m.get_context().get_method().substr(p,20).c_str() <<" ";
+            }
+
+            line << "] ";
+            std::string message = fc::format_string( m.get_format(), m.get_data(), cfg.max_object_depth );
+            line << message.c_str();
+            line << "\t\t\t" << m.get_context().get_file() << ":" << m.get_context().get_line_number() << "\n";
+            return line.str();
+         }
+
+      private:
+         void wake_writer()
+         {
+            {
+               std::lock_guard<std::mutex> lock( _wakeup_mutex );
+            }
+            _wakeup.notify_one();
+         }
+
+         /// Drains the ring on the writer thread; the file is flushed once per batch rather than once per line
+         void write_loop()
+         {
+            uint64_t reported_drops = 0;
+            log_message m;
+            for(;;)
+            {
+               bool wrote = false;
+               while( queue->try_pop( m ) )
+               {
+                  if( !wrote )
+                     rotate_files();
+                  const std::string line = format_line( m );
+                  {
+                     fc::scoped_lock<boost::mutex> lock( slock );
+                     out << line;
+                  }
+                  written.fetch_add( 1, std::memory_order_relaxed );
+                  wrote = true;
+               }
+
+               const uint64_t drops = dropped.load( std::memory_order_relaxed );
+               if( drops != reported_drops )
+               {
+                  fc::scoped_lock<boost::mutex> lock( slock );
+                  out << string( time_point::now() ) << " " << ( drops - reported_drops )
+                      << " log messages were dropped because the async log queue was full\n";
+                  reported_drops = drops;
+                  wrote = true;
+               }
+
+               if( wrote && cfg.flush )
+               {
+                  fc::scoped_lock<boost::mutex> lock( slock );
+                  out.flush();
+               }
+
+               if( _stopping.load() && queue->empty() )
+                  break;
+
+               std::unique_lock<std::mutex> lock( _wakeup_mutex );
+               _writer_idle.store( true );
+               _wakeup.wait_for( lock, std::chrono::milliseconds( 100 ),
+                                 [this]() { return _stopping.load() || !queue->empty(); } );
+               _writer_idle.store( false );
+            }
+
+            fc::scoped_lock<boost::mutex> lock( slock );
+            out.flush();
+         }
+
+      public:
+
          void rotate_files( bool initializing = false )
          {
              if( !cfg.rotate ) return;
@@ -156,37 +371,31 @@ namespace fc {
    // MS THREAD METHOD  MESSAGE \t\t\t File:Line
    void file_appender::log( const log_message& m )
    {
-      my->rotate_files();
-
-      std::stringstream line;
-      line << string(m.get_context().get_timestamp()) << " ";
-      line << std::setw( 21 ) << (m.get_context().get_thread_name().substr(0,9) + string(":") + m.get_context().get_task_name()).c_str() << " ";
-
-      string method_name = m.get_context().get_method();
-      // strip all leading scopes...
-      if( method_name.size() )
+      if( my->queue )
       {
-         uint32_t p = 0;
-         for( uint32_t i = 0;i < method_name.size(); ++i )
-         {
-             if( method_name[i] == ':' ) p = i;
-         }
-
-         if( method_name[p] == ':' )
-           ++p;
-         line << std::setw( 20 ) << m.get_context().get_method().substr(p,20).c_str() <<" ";
+         my->enqueue( m );
+         return;
       }
 
-      line << "] ";
-      std::string message = fc::format_string( m.get_format(), m.get_data(), my->cfg.max_object_depth );
-      line << message.c_str();
+      my->rotate_files();
 
+      const std::string line = my->format_line( m );
       {
         fc::scoped_lock<boost::mutex> lock( my->slock );
-        my->out << line.str() << "\t\t\t" << m.get_context().get_file() << ":" << m.get_context().get_line_number() << "\n";
+        my->out << line;
         if( my->cfg.flush )
           my->out.flush();
       }
    }
 
+   file_appender::async_stats file_appender::get_async_stats()const
+   {
+      async_stats stats;
+      stats.queued = my->queued.load( std::memory_order_relaxed );
+      stats.written = my->written.load( std::memory_order_relaxed );
+      stats.dropped = my->dropped.load( std::memory_order_relaxed );
+      stats.blocked = my->blocked.load( std::memory_order_relaxed );
+      return stats;
+   }
+
 } // fc
@@ -13,6 +13,7 @@
 #endif
 
 #include <fc/io/json.hpp>
+#include <fc/io/sstream.hpp>
 #include <fc/optional.hpp>
 #include <fc/reflect/variant.hpp>
 #include <fc/rpc/websocket_api.hpp>
@@ -183,9 +184,14 @@ namespace fc { namespace http {
       class websocket_connection_impl : public websocket_connection
       {
          public:
-            websocket_connection_impl( T con ) : _ws_connection(con)
+            websocket_connection_impl( T con, const websocket_send_options& send_options = websocket_send_options() )
+               : _ws_connection(con), _send_options(send_options)
             {
                _remote_endpoint = con->get_remote_endpoint();
+               // the handshake response lists the extensions in use, whichever side we are
+               _deflate = _send_options.enable_deflate
+                          && con->get_response_header( "Sec-WebSocket-Extensions" ).find( "permessage-deflate" )
+                             != std::string::npos;
             }
 
             virtual ~websocket_connection_impl()
@@ -196,8 +202,30 @@ namespace fc { namespace http {
             {
                ilog( "[OUT] ${remote_endpoint} ${msg}",
                      ("remote_endpoint",_remote_endpoint) ("msg",message) );
-               auto ec = _ws_connection->send( message );
-               FC_ASSERT( !ec, "websocket send failed: ${msg}", ("msg",ec.message() ) );
+               send_frame( message, websocketpp::frame::opcode::text, true );
+            }
+
+            virtual void stream_message( const std::function<void(fc::ostream&)>& write_message )override
+            {
+               // permessage-deflate compresses whole messages only
+               if( _deflate || _send_options.max_frame_size == 0 )
+                  return websocket_connection::stream_message( write_message );
+
+               frame_stream out( *this );
+               try
+               {
+                  write_message( out );
+                  out.finish();
+               }
+               catch( ... )
+               {
+                  // the peer can't tell a truncated message from a complete one
+                  if( out.frames_sent() > 0 )
+                     close( websocketpp::close::status::internal_endpoint_error, "failed to write message" );
+                  throw;
+               }
+               ilog( "[OUT] ${remote_endpoint} ${bytes} bytes in ${frames} frames",
+                     ("remote_endpoint",_remote_endpoint) ("bytes",out.bytes_sent()) ("frames",out.frames_sent()) );
             }
             virtual void close( int64_t code, const std::string& reason  )override
             {
@@ -209,15 +237,94 @@ namespace fc { namespace http {
               return _ws_connection->get_request_header(key);
             }
 
-            T _ws_connection;
+            void send_frame( const std::string& payload, websocketpp::frame::opcode::value op, bool fin )
+            {
+               auto msg = _ws_connection->get_message( op, payload.size() );
+               msg->append_payload( payload );
+               msg->set_fin( fin );
+               msg->set_compressed( _deflate && fin && op != websocketpp::frame::opcode::continuation
+                                    && payload.size() >= _send_options.deflate_min_size );
+               auto ec = _ws_connection->send( msg );
+               FC_ASSERT( !ec, "websocket send failed: ${msg}", ("msg",ec.message() ) );
+            }
+
+            /// Sends what is written to it as a fragmented text message, a frame whenever max_frame_size bytes
+            /// are buffered
+            class frame_stream : public fc::ostream
+            {
+               public:
+                  frame_stream( websocket_connection_impl& con ) : _con(con) {}
+
+                  virtual size_t writesome( const char* buf, size_t len )override
+                  {
+                     _buffer.append( buf, len );
+                     // keep the tail buffered, the last frame is only known when the message is finished
+                     if( _buffer.size() > 2 * _con._send_options.max_frame_size )
+                        send_full_frames();
+                     return len;
+                  }
+                  virtual size_t writesome( const std::shared_ptr<const char>& buf, size_t len, size_t offset )override
+                  {
+                     return writesome( buf.get() + offset, len );
+                  }
+                  virtual void close()override {}
+                  virtual void flush()override {}
+
+                  void finish()
+                  {
+                     send_full_frames();
+                     send( _buffer, true );
+                     _buffer.clear();
+                  }
+
+                  uint32_t frames_sent()const { return _frames_sent; }
+                  size_t   bytes_sent()const  { return _bytes_sent; }
+
+               private:
+                  void send_full_frames()
+                  {
+                     const size_t frame_size = _con._send_options.max_frame_size;
+                     size_t start = 0;
+                     while( _buffer.size() - start > frame_size )
+                     {
+                        size_t end = start + frame_size;
+                        // don't split a UTF-8 sequence between frames
+                        while( end > start && ( _buffer[end] & 0xC0 ) == 0x80 )
+                           --end;
+                        if( end == start )
+                           end = start + frame_size;
+                        send( _buffer.substr( start, end - start ), false );
+                        start = end;
+                     }
+                     _buffer.erase( 0, start );
+                  }
+
+                  void send( const std::string& payload, bool fin )
+                  {
+                     _con.send_frame( payload, _frames_sent == 0 ? websocketpp::frame::opcode::text
+                                                                 : websocketpp::frame::opcode::continuation, fin );
+                     ++_frames_sent;
+                     _bytes_sent += payload.size();
+                  }
+
+                  websocket_connection_impl& _con;
+                  std::string                _buffer;
+                  uint32_t                   _frames_sent = 0;
+                  size_t                     _bytes_sent = 0;
+            };
+
+            T                      _ws_connection;
+            websocket_send_options _send_options;
+            bool                   _deflate = false; ///< Whether permessage-deflate is in use
       };
 
       template<typename T>
       class possibly_proxied_websocket_connection : public websocket_connection_impl<T>
       {
          public:
-            possibly_proxied_websocket_connection( T con, const std::string& forward_header_key )
-               : websocket_connection_impl<T>(con)
+            possibly_proxied_websocket_connection( T con, const std::string& forward_header_key,
+                                                   const websocket_send_options& send_options )
+               : websocket_connection_impl<T>(con, send_options)
             {
                // By calling the parent's constructor, _remote_endpoint has been initialized.
                // Now try to extract remote address from the header, if found, overwrite it
@@ -252,10 +359,17 @@ namespace fc { namespace http {
                   _server_thread.async( [this, hdl](){
                      auto new_con = std::make_shared<possibly_proxied_websocket_connection<
                               typename websocketpp::server<T>::connection_ptr>>( _server.get_con_from_hdl(hdl),
-                                                                                 _forward_header_key );
+                                                                                 _forward_header_key,
+                                                                                 _send_options );
                      _on_connection( _connections[hdl] = new_con );
                   }).wait();
                });
+               _server.set_validate_handler( [this]( connection_hdl hdl ){
+                  // the extension was negotiated already, not confirming it keeps the client from using it
+                  if( !_send_options.enable_deflate )
+                     _server.get_con_from_hdl(hdl)->remove_header( "Sec-WebSocket-Extensions" );
+                  return true;
+               });
                _server.set_message_handler( [this]( connection_hdl hdl,
                               typename websocketpp::server<T>::message_ptr msg ){
                   _server_thread.async( [this,hdl,msg](){
@@ -292,7 +406,8 @@ namespace fc { namespace http {
                   _server_thread.async( [this,hdl](){
                      auto con = _server.get_con_from_hdl(hdl);
                      auto current_con = std::make_shared<possibly_proxied_websocket_connection<
-                              typename websocketpp::server<T>::connection_ptr>>( con, _forward_header_key );
+                              typename websocketpp::server<T>::connection_ptr>>( con, _forward_header_key,
+                                                                                 _send_options );
                      _on_connection( current_con );
 
                      con->defer_http_response(); // Note: this can tie up resources if send_http_response() is not
@@ -398,6 +513,7 @@ namespace fc { namespace http {
             fc::promise<void>::ptr   _server_socket_closed; ///< Promise to wait for the server socket to be closed
             uint32_t                 _pending_messages = 0; ///< Number of messages not processed, for rate limiting
             std::string              _forward_header_key; ///< A header like "X-Forwarded-For" (XFF) with data IP:port
+            websocket_send_options   _send_options; ///< How accepted connections send messages
       };
 
       class websocket_server_impl : public generic_websocket_server_impl<asio_with_stub_log>
@@ -629,6 +745,13 @@ namespace fc { namespace http {
 
    } // namespace detail
 
+   void websocket_connection::stream_message( const std::function<void(fc::ostream&)>& write_message )
+   {
+      fc::stringstream out;
+      write_message( out );
+      send_message( out.str() );
+   }
+
    websocket_server::websocket_server( const std::string& forward_header_key )
          :my( new detail::websocket_server_impl( forward_header_key ) ) {}
    websocket_server::~websocket_server(){}
@@ -638,6 +761,11 @@ namespace fc { namespace http {
       my->_on_connection = handler;
    }
 
+   void websocket_server::set_send_options( const websocket_send_options& options )
+   {
+      my->_send_options = options;
+   }
+
    void websocket_server::listen( uint16_t port )
    {
       my->_server.listen(port);
@@ -683,6 +811,11 @@ namespace fc { namespace http {
       my->_on_connection = handler;
    }
 
+   void websocket_tls_server::set_send_options( const websocket_send_options& options )
+   {
+      my->_send_options = options;
+   }
+
    void websocket_tls_server::listen( uint16_t port )
    {
       my->_server.listen(port);
@@ -53,8 +53,13 @@ websocket_api_connection::websocket_api_connection( const std::shared_ptr<fc::ht
    _connection->on_message_handler( [this]( const std::string& msg ){
        response reply = on_message(msg);
        if( _connection && ( reply.id || reply.result || reply.error || reply.jsonrpc ) )
-          _connection->send_message( fc::json::to_string( reply, fc::json::stringify_large_ints_and_doubles,
-                                                          _max_conversion_depth ) );
+       {
+          // large results are streamed to the connection rather than serialized to a string first
+          const variant reply_var( reply, _max_conversion_depth );
+          _connection->stream_message( [this,&reply_var]( fc::ostream& out ) {
+             fc::json::to_stream( out, reply_var, fc::json::stringify_large_ints_and_doubles, _max_conversion_depth );
+          } );
+       }
    } );
    _connection->on_http_handler( [this]( const std::string& msg ){
        response reply = on_message(msg);
@@ -113,11 +118,13 @@ void websocket_api_connection::send_notice(
    uint64_t callback_id,
    variants args /* = variants() */ )
 {
-   if( !_connection ) // defensive check
+   // notices are queued, the connection may have closed since; keep it alive while sending
+   const auto connection = _connection;
+   if( !connection )
       return;
 
    fc::rpc::request req{ optional<uint64_t>(), "notice", { callback_id, std::move(args) } };
-   _connection->send_message( fc::json::to_string( fc::variant( req, _max_conversion_depth ),
+   connection->send_message( fc::json::to_string( fc::variant( req, _max_conversion_depth ),
                                                    fc::json::stringify_large_ints_and_doubles,
                                                    _max_conversion_depth ) );
 }
@@ -8,12 +8,105 @@
 #include <fc/log/logger.hpp>
 #include <boost/exception/all.hpp>
 
+#include <vector>
+
 #ifdef _MSC_VER
 # include <fc/thread/thread.hpp>
 # include <Windows.h>
 #endif
 
 namespace fc {
+  namespace {
+    // task objects are cached in size classes of 64 bytes, up to 2 KB
+    const size_t task_size_granularity = 64;
+    const size_t task_size_classes = 32;
+
+    boost::atomic<uint32_t> task_pool_limit( 256 );
+    boost::atomic<uint64_t> tasks_allocated( 0 );
+    boost::atomic<uint64_t> tasks_recycled( 0 );
+
+    struct task_block_cache
+    {
+      std::vector<void*> free_blocks[task_size_classes];
+
+      ~task_block_cache()
+      {
+        for( auto& blocks : free_blocks )
+          for( void* block : blocks )
+            ::operator delete( block );
+      }
+    };
+
+    // trivially destructible, so it can still be read while other thread_locals are being destroyed
+    thread_local bool task_block_cache_destroyed = false;
+
+    struct task_block_cache_owner
+    {
+      task_block_cache cache;
+      ~task_block_cache_owner() { task_block_cache_destroyed = true; }
+    };
+
+    task_block_cache* get_task_block_cache()
+    {
+      if( task_block_cache_destroyed )
+        return nullptr;
+      thread_local task_block_cache_owner owner;
+      return &owner.cache;
+    }
+  }
+
+  namespace detail {
+    void* allocate_task( size_t size )
+    {
+      const size_t size_class = ( size - 1 ) / task_size_granularity;
+      if( size_class >= task_size_classes )
+      {
+        tasks_allocated.fetch_add( 1, boost::memory_order_relaxed );
+        return ::operator new( size );
+      }
+      task_block_cache* cache = get_task_block_cache();
+      if( cache && !cache->free_blocks[size_class].empty() )
+      {
+        void* block = cache->free_blocks[size_class].back();
+        cache->free_blocks[size_class].pop_back();
+        tasks_recycled.fetch_add( 1, boost::memory_order_relaxed );
+        return block;
+      }
+      tasks_allocated.fetch_add( 1, boost::memory_order_relaxed );
+      return ::operator new( ( size_class + 1 ) * task_size_granularity );
+    }
+
+    // a task is often freed on another thread than the one that allocated it, its block then
+    // joins the free list of the freeing thread
+    void free_task( void* p, size_t size )
+    {
+      const size_t size_class = ( size - 1 ) / task_size_granularity;
+      if( size_class < task_size_classes )
+      {
+        task_block_cache* cache = get_task_block_cache();
+        if( cache && cache->free_blocks[size_class].size() < task_pool_limit.load( boost::memory_order_relaxed ) )
+        {
+          cache->free_blocks[size_class].push_back( p );
+          return;
+        }
+      }
+      ::operator delete( p );
+    }
+  }
+
+  task_allocation_stats get_task_allocation_stats()
+  {
+    task_allocation_stats stats;
+    stats.allocated = tasks_allocated.load( boost::memory_order_relaxed );
+    stats.recycled = tasks_recycled.load( boost::memory_order_relaxed );
+    return stats;
+  }
+
+  void set_task_pool_limit( uint32_t limit )
+  {
+    task_pool_limit.store( limit, boost::memory_order_relaxed );
+  }
+
   task_base::task_base(void* func)
   :
   promise_base("task_base"),
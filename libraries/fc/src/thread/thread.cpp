@@ -228,6 +228,9 @@ namespace fc {
       my->add_context_to_ready_list( cur );
       cur = n;
     }
+    my->pt_head = nullptr;
+    my->pt_count = 0;
+    my->idle_contexts.store( 0 );
 
     // mark all ready tasks (should be everyone)... as canceled
     for (fc::context* ready_context : my->ready_heap)
@@ -274,6 +277,22 @@ namespace fc {
       return priority();
    }
 
+   thread::context_stats thread::get_context_stats()const
+   {
+      context_stats stats;
+      stats.contexts_created  = my->contexts_created.load( boost::memory_order_relaxed );
+      stats.context_pool_hits = my->context_pool_hits.load( boost::memory_order_relaxed );
+      stats.context_switches  = my->context_switches.load( boost::memory_order_relaxed );
+      stats.contexts_released = my->contexts_released.load( boost::memory_order_relaxed );
+      stats.idle_contexts     = my->idle_contexts.load( boost::memory_order_relaxed );
+      return stats;
+   }
+
+   void thread::set_idle_context_limit( uint32_t limit )
+   {
+      my->idle_context_limit.store( limit, boost::memory_order_relaxed );
+   }
+
    void thread::yield(bool reschedule)
    {
       my->check_fiber_exceptions();
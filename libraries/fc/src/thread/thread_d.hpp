@@ -7,6 +7,7 @@
 #include <boost/thread.hpp>
 #include <boost/atomic.hpp>
 
+#include <limits>
 #include <sstream>
 #include <vector>
 
@@ -106,6 +107,15 @@ namespace fc {
            fc::context*             current;     // the currently-executing task in this thread
 
            fc::context*             pt_head;     // list of contexts that can be reused for new tasks
+           uint32_t                 pt_count = 0; // number of contexts in the pt_head list
+           boost::atomic<uint32_t>  idle_context_limit{ std::numeric_limits<uint32_t>::max() };
+
+           // diagnostics; written only by this thread, so the increments need no atomic read-modify-write
+           boost::atomic<uint64_t>  contexts_created{ 0 };
+           boost::atomic<uint64_t>  context_pool_hits{ 0 };
+           boost::atomic<uint64_t>  context_switches{ 0 };
+           boost::atomic<uint64_t>  contexts_released{ 0 };
+           boost::atomic<uint32_t>  idle_contexts{ 0 };
 
            std::vector<fc::context*> ready_heap; // priority heap of contexts that are ready to run
 
@@ -177,10 +187,16 @@ namespace fc {
               blocked = c;
            }
 
+           static void count( boost::atomic<uint64_t>& counter )
+           {
+              counter.store( counter.load( boost::memory_order_relaxed ) + 1, boost::memory_order_relaxed );
+           }
+
            void pt_push_back(fc::context* c) 
            {
               c->next = pt_head;
               pt_head = c;
+              idle_contexts.store( ++pt_count, boost::memory_order_relaxed );
               /* 
               fc::context* n = pt_head;
               int i = 0;
@@ -429,6 +445,7 @@ namespace fc {
                 }
                 // slog( "jump to %p from %p", next, prev );
                 // fc_dlog( logger::get("fc_context"), "from ${from} to ${to}", ( "from", int64_t(prev) )( "to", int64_t(next) ) ); 
+                count( context_switches );
 #if BOOST_VERSION >= 106100
                 auto p = context_pair{nullptr, prev};
                 auto t = bc::jump_fcontext( next->my_context, &p );
@@ -452,14 +469,17 @@ namespace fc {
                   // grab cached context
                   next = pt_head;
                   pt_head = pt_head->next;
+                  idle_contexts.store( --pt_count, boost::memory_order_relaxed );
                   next->next = 0;
                   next->reinitialize();
+                  count( context_pool_hits );
                 } 
                 else 
                 { 
                   // create new context.
                   next = new fc::context( &thread_d::start_process_tasks, stack_alloc,
                                           &fc::thread::current() );
+                  count( contexts_created );
                 }
 
                 current = next;
@@ -471,6 +491,7 @@ namespace fc {
 
                 // slog( "jump to %p from %p", next, prev );
                 // fc_dlog( logger::get("fc_context"), "from ${from} to ${to}", ( "from", int64_t(prev) )( "to", int64_t(next) ) );
+                count( context_switches );
 #if BOOST_VERSION >= 106100
                 auto p = context_pair{this, prev};
                 auto t = bc::jump_fcontext( next->my_context, &p );
@@ -548,6 +569,37 @@ namespace fc {
              return false;
            }
 
+           /**
+            *  Releases idle contexts, and their stacks, beyond idle_context_limit.  A context parked in
+            *  process_tasks() is unwound the way quit() does it: it is canceled and resumed, so that it throws
+            *  out of process_tasks() and puts itself on the free list.  The thread's own context runs
+            *  process_tasks() on the OS stack under exec() and has no stack_alloc, it is never released.
+            *  @return whether contexts were readied to unwind, process_tasks() has to run them before idling
+            */
+           bool trim_idle_contexts()
+           {
+              const uint32_t limit = idle_context_limit.load( boost::memory_order_relaxed );
+              bool trimmed = false;
+              fc::context** link = &pt_head;
+              while( pt_count > limit && *link )
+              {
+                 fc::context* c = *link;
+                 if( !c->stack_alloc )
+                 {
+                    link = &c->next;
+                    continue;
+                 }
+                 *link = c->next;
+                 c->next = nullptr;
+                 idle_contexts.store( --pt_count, boost::memory_order_relaxed );
+                 c->canceled = true;
+                 add_context_to_ready_list( c );
+                 count( contexts_released );
+                 trimmed = true;
+              }
+              return trimmed;
+           }
+
            void clear_free_list() 
            {
               for( uint32_t i = 0; i < free_list.size(); ++i ) 
@@ -597,6 +649,8 @@ namespace fc {
                 if( process_canceled_tasks() ) 
                   continue;
 
+                if( trim_idle_contexts() )
+                  continue;
                 clear_free_list();
 
                 { // lock scope
@@ -69,4 +69,48 @@ BOOST_AUTO_TEST_CASE(log_reboot)
     BOOST_TEST_MESSAGE("Loop complete");
 }
 
+BOOST_AUTO_TEST_CASE(async_file_appender)
+{
+    fc::temp_directory dir;
+    fc::file_appender::config conf;
+    conf.filename = dir.path() / "async.log";
+    conf.async = true;
+    conf.async_queue_size = 4;
+    conf.async_block_when_full = true;
+
+    const int count = 1000;
+    {
+        fc::file_appender appender( fc::variant(conf, 200) );
+        for( int i = 0; i < count; i++ )
+        {
+            fc::log_context ctx(fc::log_level::all, "my_file.cpp", i, "my_method()");
+            appender.log( fc::log_message( ctx, "message ${i}", fc::mutable_variant_object()("i", i) ) );
+        }
+        const auto stats = appender.get_async_stats();
+        BOOST_CHECK_EQUAL( stats.queued, count );
+        BOOST_CHECK_EQUAL( stats.dropped, 0 );
+    } // the writer drains the queue before the appender is gone
+
+    std::string contents;
+    fc::read_file_contents( conf.filename, contents );
+    size_t pos = 0;
+    for( int i = 0; i < count; i++ )
+    {
+        pos = contents.find( "message " + std::to_string(i) + "\t", pos );
+        BOOST_REQUIRE( pos != std::string::npos );
+    }
+
+    conf.filename = dir.path() / "dropping.log";
+    conf.async_block_when_full = false;
+    fc::file_appender appender( fc::variant(conf, 200) );
+    for( int i = 0; i < count; i++ )
+    {
+        fc::log_context ctx(fc::log_level::all, "my_file.cpp", i, "my_method()");
+        appender.log( fc::log_message( ctx, "message ${i}", fc::mutable_variant_object()("i", i) ) );
+    }
+    const auto stats = appender.get_async_stats();
+    BOOST_CHECK_EQUAL( stats.queued + stats.dropped, count );
+    BOOST_CHECK_EQUAL( stats.blocked, 0 );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
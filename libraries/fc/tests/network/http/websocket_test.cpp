@@ -1,6 +1,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <fc/network/http/websocket.hpp>
+#include <fc/io/iostream.hpp>
 
 #include <iostream>
 #include <fc/log/logger.hpp>
@@ -162,4 +163,48 @@ BOOST_AUTO_TEST_CASE(websocket_test_with_proxy_header)
     l.set_log_level(old_log_level);
 }
 
+BOOST_AUTO_TEST_CASE(websocket_stream_message_test)
+{
+    fc::http::websocket_client client;
+    fc::http::websocket_connection_ptr c_conn;
+    {
+        fc::http::websocket_send_options send_options;
+        send_options.enable_deflate = false;
+        send_options.max_frame_size = 16;
+
+        fc::http::websocket_server server;
+        server.set_send_options( send_options );
+        server.on_connection([&]( const fc::http::websocket_connection_ptr& c ){
+                fc::http::websocket_connection* con = c.get();
+                con->on_message_handler([con](const std::string& s){
+                    // multi-byte characters straddle the frame boundaries
+                    con->stream_message([&s]( fc::ostream& out ){
+                        out.write( "echo:", 5 );
+                        for( int i = 0; i < 10; ++i )
+                        {
+                            out.write( " \xc3\xa9", 3 );
+                            out.write( s.data(), s.size() );
+                        }
+                    });
+                });
+            });
+
+        server.listen( 0 );
+        server.start_accept();
+
+        std::string echo;
+        std::string expected = "echo:";
+        for( int i = 0; i < 10; ++i )
+            expected += " \xc3\xa9hello world";
+
+        c_conn = client.connect( "ws://localhost:" + fc::to_string(server.get_listening_port()) );
+        c_conn->on_message_handler([&](const std::string& s){
+                    echo = s;
+                });
+        c_conn->send_message( "hello world" );
+        fc::usleep( fc::milliseconds(100) );
+        BOOST_CHECK_EQUAL( expected, echo );
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -33,6 +33,8 @@
 #include <fc/thread/parallel.hpp>
 #include <fc/time.hpp>
 
+#include <atomic>
+
 #include <iostream>
 
 namespace fc { namespace test {
@@ -344,4 +346,43 @@ BOOST_AUTO_TEST_CASE( serial_valve )
    }
 }
 
+BOOST_AUTO_TEST_CASE( parallel_for_ranges )
+{
+   // too few items to split
+   size_t calls = 0;
+   fc::parallel_for_ranges( 10, 100, [&calls] ( size_t range, size_t begin, size_t end ) {
+      BOOST_CHECK_EQUAL( 0u, range );
+      BOOST_CHECK_EQUAL( 0u, begin );
+      BOOST_CHECK_EQUAL( 10u, end );
+      ++calls;
+   });
+   BOOST_CHECK_EQUAL( 1u, calls );
+
+   // every item is visited once, each range by one thread
+   const size_t count = 100000;
+   const size_t ranges = fc::parallel_range_count( count, 1000 );
+   std::vector<uint32_t> visits( count );
+   std::vector<uint32_t> range_calls( ranges );
+   fc::parallel_for_ranges( count, 1000, [&visits,&range_calls] ( size_t range, size_t begin, size_t end ) {
+      ++range_calls[range];
+      for( size_t i = begin; i < end; ++i )
+         ++visits[i];
+   });
+   for( uint32_t c : range_calls )
+      BOOST_CHECK_EQUAL( 1u, c );
+   BOOST_CHECK( std::all_of( visits.begin(), visits.end(), [] ( uint32_t v ) { return v == 1; } ) );
+
+   // a failing range is reported once all ranges are done
+   if( ranges > 1 )
+   {
+      std::atomic<size_t> done( 0 );
+      BOOST_CHECK_THROW( fc::parallel_for_ranges( count, 1000, [&done,ranges] ( size_t range, size_t, size_t ) {
+         if( range == ranges - 1 )
+            FC_THROW( "failed" );
+         ++done;
+      }), fc::exception );
+      BOOST_CHECK_EQUAL( ranges - 1, done.load() );
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,8 @@
 #include <fc/asio.hpp>
 
 #include <iostream>
+#include <memory>
+#include <vector>
 
 using namespace fc;
 
@@ -156,4 +158,59 @@ BOOST_AUTO_TEST_CASE( yield_with_mutex )
    BOOST_CHECK_EQUAL(0u, my_mutable);
 }
 
+BOOST_AUTO_TEST_CASE(reuses_contexts_and_tasks)
+{
+    fc::thread thread("my");
+    const auto before = fc::get_task_allocation_stats();
+    thread.async([]{
+       // waiting parks this context, so each task runs on another one taken from the pool
+       for( int i = 0; i < 100; ++i )
+          fc::async([]{}).wait();
+    }).wait();
+    const auto after = fc::get_task_allocation_stats();
+    BOOST_CHECK_GE( after.recycled - before.recycled, 90u );
+
+    const auto stats = thread.get_context_stats();
+    BOOST_CHECK_LE( stats.contexts_created, 2u );
+    BOOST_CHECK_GE( stats.context_pool_hits, 90u );
+
+    // tasks that sleep need a context each, the idle ones are freed down to the limit afterwards
+    thread.set_idle_context_limit( 1 );
+    std::vector<fc::future<void>> sleepers;
+    for( int i = 0; i < 10; ++i )
+       sleepers.push_back( thread.async([]{ fc::usleep( fc::milliseconds(10) ); }) );
+    for( auto& f : sleepers )
+       f.wait();
+    thread.async([]{}).wait();
+    fc::usleep( fc::milliseconds(10) );
+    const auto trimmed = thread.get_context_stats();
+    BOOST_CHECK_LE( trimmed.idle_contexts, 1u );
+    BOOST_CHECK_GE( trimmed.contexts_released, 5u );
+}
+
+BOOST_AUTO_TEST_CASE(trim_keeps_thread_context)
+{
+    auto thread = std::make_unique<fc::thread>("trimmed");
+    thread->set_idle_context_limit( 0 );
+    // the sleepers wake while the thread's own context idles, which parks it to run them
+    for( int round = 0; round < 5; ++round )
+    {
+       std::vector<fc::future<void>> sleepers;
+       for( int i = 0; i < 10; ++i )
+          sleepers.push_back( thread->async([]{ fc::usleep( fc::milliseconds(5) ); }) );
+       for( auto& f : sleepers )
+          f.wait();
+       thread->async([]{}).wait();
+       fc::usleep( fc::milliseconds(5) );
+    }
+    const auto stats = thread->get_context_stats();
+    // only the thread's own context may be left parked
+    BOOST_CHECK_LE( stats.idle_contexts, 1u );
+    BOOST_CHECK_GE( stats.contexts_released, 5u );
+    // the thread still runs tasks and quits, its exec() frame was not abandoned
+    BOOST_CHECK_EQUAL( thread->async([]{ return 42; }).wait(), 42 );
+    thread->quit();
+    thread.reset();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -22,6 +22,9 @@
  * THE SOFTWARE.
  */
 #include <graphene/net/core_messages.hpp>
+#include <graphene/net/message.hpp>
+
+#include <fc/io/raw.hpp>
 
 
 namespace graphene { namespace net {
@@ -45,6 +48,25 @@ namespace graphene { namespace net {
   const core_message_type_enum check_firewall_reply_message::type            = core_message_type_enum::check_firewall_reply_message_type;
   const core_message_type_enum get_current_connections_request_message::type = core_message_type_enum::get_current_connections_request_message_type;
   const core_message_type_enum get_current_connections_reply_message::type   = core_message_type_enum::get_current_connections_reply_message_type;
+  const core_message_type_enum compact_block_message::type                   = core_message_type_enum::compact_block_message_type;
+  const core_message_type_enum fetch_compact_block_transactions_message::type = core_message_type_enum::fetch_compact_block_transactions_message_type;
+  const core_message_type_enum compact_block_transactions_message::type      = core_message_type_enum::compact_block_transactions_message_type;
+
+  compact_block_message::compact_block_message(const block_message& block_message_to_compact, const item_hash_t& block_message_hash) :
+    block_message_hash(block_message_hash),
+    header(block_message_to_compact.block),
+    block_id(block_message_to_compact.block_id)
+  {
+    transactions.reserve(block_message_to_compact.block.transactions.size());
+    for (const processed_transaction& transaction : block_message_to_compact.block.transactions)
+    {
+      // hash the transaction exactly as it was relayed, so the receiver can find it in its message cache
+      compact_block_transaction compact_transaction;
+      compact_transaction.transaction_message_id = message(trx_message(transaction)).id();
+      compact_transaction.operation_results = transaction.operation_results;
+      transactions.push_back(std::move(compact_transaction));
+    }
+  }
 
 } } // graphene::net
 
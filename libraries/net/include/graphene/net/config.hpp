@@ -71,6 +71,13 @@
  */
 #define GRAPHENE_NET_MESSAGE_CACHE_DURATION_IN_BLOCKS        5
 
+/**
+ * Advertised in the hello message.  Peers that both advertise it request
+ * blocks from each other during normal operation as compact blocks (header
+ * plus ids of the relayed transactions) instead of full blocks.
+ */
+#define GRAPHENE_NET_COMPACT_BLOCK_RELAY_VERSION             1
+
 /**
  * We prevent a peer from offering us a list of blocks which, if we fetched them
  * all, would result in a blockchain that extended into the future.
@@ -84,6 +91,27 @@
 
 #define GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING      200
 
+/**
+ * During sync, the number of blocks requested from a peer at once is sized from that
+ * peer's measured delivery rate so the whole request arrives within this many
+ * milliseconds.  This must stay comfortably below the one second we allow a peer
+ * to answer a request before we give up on it.
+ */
+#define GRAPHENE_NET_SYNC_REQUEST_TARGET_DURATION_MS         400
+
+/**
+ * Lower bound on the adaptive per-peer sync request size, so slow or unmeasured
+ * peers still make progress.
+ */
+#define GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING      10
+
+/**
+ * Upper bound on the adaptive per-peer sync request size.  Until a peer has been
+ * measured it is asked for GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING blocks at a
+ * time; a fast peer's window may grow past that up to this many blocks.
+ */
+#define GRAPHENE_NET_MAX_SYNC_REQUEST_WINDOW                 1000
+
 /**
  * During normal operation, how many items will be fetched from each
  * peer at a time.  This will only come into play when the network
@@ -107,6 +135,16 @@
 
 #define GRAPHENE_NET_MAX_TRX_PER_SECOND                      1000
 
+/**
+ * A peer that relays this many transactions we reject within the window
+ * below is not asked for transactions for a while.  Some rejections are
+ * normal, e.g. transactions that expired while propagating, so this is
+ * meant to catch peers relaying junk.
+ */
+#define GRAPHENE_NET_MAX_REJECTED_TRX_PER_WINDOW             100
+#define GRAPHENE_NET_REJECTED_TRX_WINDOW_SECONDS             60
+#define GRAPHENE_NET_REJECTED_TRX_INHIBIT_SECONDS            60
+
 #define GRAPHENE_NET_MAX_NESTED_OBJECTS                      (250)
 
 #define MAXIMUM_PEERDB_SIZE 1000
@@ -44,6 +44,9 @@ namespace graphene { namespace net {
   using graphene::protocol::block_id_type;
   using graphene::protocol::transaction_id_type;
   using graphene::protocol::signed_block;
+  using graphene::protocol::signed_block_header;
+  using graphene::protocol::processed_transaction;
+  using graphene::protocol::operation_result;
 
   typedef fc::ecc::public_key_data node_id_t;
   typedef fc::ripemd160 item_hash_t;
@@ -86,6 +89,9 @@ namespace graphene { namespace net {
     check_firewall_reply_message_type            = 5015,
     get_current_connections_request_message_type = 5016,
     get_current_connections_reply_message_type   = 5017,
+    compact_block_message_type                   = 5018,
+    fetch_compact_block_transactions_message_type = 5019,
+    compact_block_transactions_message_type      = 5020,
     core_message_type_last                       = 5099
   };
 
@@ -400,6 +406,64 @@ namespace graphene { namespace net {
     std::vector<current_connection_data> current_connections;
   };
 
+  /**
+   * A transaction in a compact block, identified by the id of the trx_message
+   * it was relayed in.  The operation results are carried along because they
+   * are part of the serialized block but not of the relayed transaction.
+   */
+  struct compact_block_transaction
+  {
+    item_hash_t                    transaction_message_id;
+    std::vector<operation_result>  operation_results;
+  };
+
+  /**
+   * Sent in place of a block_message to peers that requested the block as a
+   * compact_block_message_type item.  The receiver rebuilds the block from
+   * the transactions in its message cache and asks for whatever is missing
+   * with a fetch_compact_block_transactions_message.
+   */
+  struct compact_block_message
+  {
+    static const core_message_type_enum type;
+
+    item_hash_t                            block_message_hash; // the item hash the block was requested by
+    signed_block_header                    header;
+    block_id_type                          block_id;
+    std::vector<compact_block_transaction> transactions;
+
+    compact_block_message() {}
+    compact_block_message(const block_message& block_message_to_compact, const item_hash_t& block_message_hash);
+  };
+
+  struct fetch_compact_block_transactions_message
+  {
+    static const core_message_type_enum type;
+
+    block_id_type         block_id;
+    std::vector<uint32_t> transaction_indexes; // positions in the block of the transactions we're missing
+
+    fetch_compact_block_transactions_message() {}
+    fetch_compact_block_transactions_message(const block_id_type& block_id, std::vector<uint32_t> transaction_indexes) :
+      block_id(block_id),
+      transaction_indexes(std::move(transaction_indexes))
+    {}
+  };
+
+  /** The reply to fetch_compact_block_transactions_message, empty if the block is not available */
+  struct compact_block_transactions_message
+  {
+    static const core_message_type_enum type;
+
+    block_id_type                      block_id;
+    std::vector<processed_transaction> transactions;
+
+    compact_block_transactions_message() {}
+    explicit compact_block_transactions_message(const block_id_type& block_id) :
+      block_id(block_id)
+    {}
+  };
+
 
 } } // graphene::net
 
@@ -424,6 +488,9 @@ FC_REFLECT_ENUM( graphene::net::core_message_type_enum,
                  (check_firewall_reply_message_type)
                  (get_current_connections_request_message_type)
                  (get_current_connections_reply_message_type)
+                 (compact_block_message_type)
+                 (fetch_compact_block_transactions_message_type)
+                 (compact_block_transactions_message_type)
                  (core_message_type_last) )
 
 FC_REFLECT( graphene::net::trx_message, (trx) )
@@ -508,6 +575,10 @@ FC_REFLECT(graphene::net::get_current_connections_reply_message, (upload_rate_on
                                                             (upload_rate_one_hour)
                                                             (download_rate_one_hour)
                                                             (current_connections))
+FC_REFLECT(graphene::net::compact_block_transaction, (transaction_message_id)(operation_results))
+FC_REFLECT(graphene::net::compact_block_message, (block_message_hash)(header)(block_id)(transactions))
+FC_REFLECT(graphene::net::fetch_compact_block_transactions_message, (block_id)(transaction_indexes))
+FC_REFLECT(graphene::net::compact_block_transactions_message, (block_id)(transactions))
 
 #include <unordered_map>
 #include <fc/crypto/city.hpp>
@@ -204,6 +204,7 @@ namespace graphene { namespace net
       fc::optional<fc::time_point_sec> fc_git_revision_unix_timestamp;
       fc::optional<std::string> platform;
       fc::optional<uint32_t> bitness;
+      bool             supports_compact_blocks = false; /// true if the peer advertised compact block relay in its hello
 
       // for inbound connections, these fields record what the peer sent us in
       // its hello message.  For outbound, they record what we sent the peer
@@ -227,6 +228,11 @@ namespace graphene { namespace net
       item_hash_t last_block_delegate_has_seen; /// the hash of the last block  this peer has told us about that the peer knows
       fc::time_point_sec last_block_time_delegate_has_seen;
       bool inhibit_fetching_sync_blocks = false;
+      fc::time_point last_sync_block_received_time; /// when we last received a sync block we had requested from this peer
+      fc::microseconds average_sync_block_interval; /// smoothed time between two sync blocks arriving from this peer, 0 until measured
+      double sync_blocks_per_second = 0.; /// rate at which this peer delivers the sync blocks we request, the inverse of average_sync_block_interval, 0 until measured or seeded
+      bool sync_rate_measured = false; /// whether sync_blocks_per_second includes a measurement from this connection, not just the seed
+      fc::microseconds average_sync_block_latency; /// smoothed delay between requesting a sync block and receiving it
       /// @}
 
       /// non-synchronization state data
@@ -250,12 +256,28 @@ namespace graphene { namespace net
       timestamped_items_set_type inventory_advertised_to_peer;
 
       item_to_time_map_type items_requested_from_peer;  /// items we've requested from this peer during normal operation.  fetch from another peer if this peer disconnects
+
+      /// a block this peer sent us as a compact_block_message that we're still missing transactions for
+      struct partial_compact_block
+      {
+        item_hash_t           block_message_hash;
+        signed_block          block;
+        std::vector<uint32_t> missing_transaction_indexes;
+      };
+      fc::optional<partial_compact_block> compact_block_being_reconstructed;
       /// @}
 
       // if they're flooding us with transactions, we set this to avoid fetching for a few seconds to let the
       // blockchain catch up
       fc::time_point transaction_fetching_inhibited_until;
 
+      /// transactions from this peer the client accepted or rejected
+      uint32_t transactions_accepted = 0;
+      uint32_t transactions_rejected = 0;
+      /// rejections since recent_rejections_since, used to stop fetching transactions from peers relaying junk
+      uint32_t recent_transaction_rejections = 0;
+      fc::time_point recent_transaction_rejections_since;
+
       uint32_t last_known_fork_block_number = 0;
 
       fc::future<void> accept_or_connect_task_done;
@@ -302,6 +324,8 @@ namespace graphene { namespace net
       bool is_currently_handling_message() const;
 
       bool is_transaction_fetching_inhibited() const;
+      void record_sync_block_received(const fc::time_point& request_time, const fc::time_point& now = fc::time_point::now());
+      unsigned get_sync_request_window(unsigned unmeasured_window, unsigned maximum_window) const;
       fc::sha512 get_shared_secret() const;
       void clear_old_inventory();
       bool is_inventory_advertised_to_us_list_full_for_transactions() const;
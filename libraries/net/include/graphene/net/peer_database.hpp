@@ -54,9 +54,21 @@ namespace graphene { namespace net {
     uint32_t                          number_of_failed_connection_attempts;
     fc::optional<fc::exception>       last_error;
 
+    /// measured quality of the peer, carried across connections and restarts
+    /// @{
+    uint32_t                          number_of_failed_handshakes;
+    uint32_t                          average_round_trip_delay_ms; /// 0 if never measured
+    uint32_t                          average_sync_blocks_per_second; /// 0 if we never synced from this peer
+    uint32_t                          total_connected_seconds;
+    /// @}
+
     potential_peer_record() :
       number_of_successful_connection_attempts(0),
-    number_of_failed_connection_attempts(0){}
+    number_of_failed_connection_attempts(0),
+      number_of_failed_handshakes(0),
+      average_round_trip_delay_ms(0),
+      average_sync_blocks_per_second(0),
+      total_connected_seconds(0){}
 
     potential_peer_record(fc::ip::endpoint endpoint,
                           fc::time_point_sec last_seen_time = fc::time_point_sec(),
@@ -65,8 +77,23 @@ namespace graphene { namespace net {
       last_seen_time(last_seen_time),
       last_connection_disposition(last_connection_disposition),
       number_of_successful_connection_attempts(0),
-      number_of_failed_connection_attempts(0)
+      number_of_failed_connection_attempts(0),
+      number_of_failed_handshakes(0),
+      average_round_trip_delay_ms(0),
+      average_sync_blocks_per_second(0),
+      total_connected_seconds(0)
     {}  
+
+    /**
+     * Rates how desirable this peer is to connect to and sync from, in [0, 1].  Combines how
+     * reliably we've been able to connect and handshake, how long we've stayed connected, and
+     * the latency and block throughput we measured; unmeasured values get a neutral rating.
+     */
+    double score() const;
+
+    /** Folds the measurements from a finished connection into the running averages */
+    void record_connection_quality( const fc::microseconds& round_trip_delay, double sync_blocks_per_second,
+                                    const fc::microseconds& connected_duration );
   };
 
   namespace detail
@@ -179,6 +179,7 @@ namespace graphene { namespace net {
       void cache_message( const message& message_to_cache, const message_hash_type& hash_of_message_to_cache,
                         const message_propagation_data& propagation_data, const fc::uint160_t& message_content_hash );
       message get_message( const message_hash_type& hash_of_message_to_lookup );
+      const message* find_message( const message_hash_type& hash_of_message_to_lookup ) const;
       message_propagation_data get_message_propagation_data( const fc::uint160_t& hash_of_message_contents_to_lookup ) const;
       size_t size() const { return _message_cache.size(); }
     };
@@ -212,6 +213,15 @@ namespace graphene { namespace net {
       FC_THROW_EXCEPTION(  fc::key_not_found_exception, "Requested message not in cache" );
     }
 
+    const message* blockchain_tied_message_cache::find_message( const message_hash_type& hash_of_message_to_lookup ) const
+    {
+      message_cache_container::index<message_hash_index>::type::const_iterator iter =
+         _message_cache.get<message_hash_index>().find(hash_of_message_to_lookup );
+      if( iter != _message_cache.get<message_hash_index>().end() )
+        return &iter->message_body;
+      return nullptr;
+    }
+
     message_propagation_data blockchain_tied_message_cache::get_message_propagation_data( const fc::uint160_t& hash_of_message_contents_to_lookup ) const
     {
       if( hash_of_message_contents_to_lookup != fc::uint160_t() )
@@ -417,7 +427,7 @@ namespace graphene { namespace net { namespace detail {
       fc::sha256           _chain_id;
 
 #define NODE_CONFIGURATION_FILENAME      "node_config.json"
-#define POTENTIAL_PEER_DATABASE_FILENAME "peers.json"
+#define POTENTIAL_PEER_DATABASE_FILENAME "peers.dat"
       fc::path             _node_configuration_directory;
       node_configuration   _node_configuration;
 
@@ -453,6 +463,7 @@ namespace graphene { namespace net { namespace detail {
       active_sync_requests_map              _active_sync_requests; /// list of sync blocks we've asked for from peers but have not yet received
       std::list<graphene::net::block_message> _new_received_sync_items; /// list of sync blocks we've just received but haven't yet tried to process
       std::list<graphene::net::block_message> _received_sync_items; /// list of sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain
+      std::unordered_set<item_hash_t>         _received_sync_item_ids; /// ids of all blocks in _new_received_sync_items and _received_sync_items, for fast lookup
       // @}
 
       fc::future<void> _process_backlog_of_sync_blocks_done;
@@ -532,6 +543,15 @@ namespace graphene { namespace net { namespace detail {
 
       blockchain_tied_message_cache _message_cache; /// cache message we have received and might be required to provide to other peers via inventory requests
 
+      /// the compact form of the last block a peer requested from us, the other peers will usually want the same one
+      fc::optional<compact_block_message> _most_recent_compact_block;
+      /// compact block relay statistics, reported by network_get_info()
+      /// @{
+      uint32_t _compact_blocks_received = 0;
+      uint32_t _compact_block_transactions_fetched = 0;
+      uint32_t _compact_block_fallbacks = 0;
+      /// @}
+
       fc::rate_limiting_group _rate_limiter;
 
       uint32_t _last_reported_number_of_connections; // number of connections last reported to the client (to avoid sending duplicate messages)
@@ -578,6 +598,8 @@ namespace graphene { namespace net { namespace detail {
       unsigned _maximum_number_of_blocks_to_handle_at_one_time;
       unsigned _maximum_number_of_sync_blocks_to_prefetch;
       unsigned _maximum_blocks_per_peer_during_syncing;
+      /// the most sync blocks a fast peer can be asked for at once, however quickly it delivers
+      unsigned _maximum_sync_request_window;
 
       std::list<fc::future<void> > _handle_message_calls_in_progress;
 
@@ -592,6 +614,8 @@ namespace graphene { namespace net { namespace detail {
       bool have_already_received_sync_item( const item_hash_t& item_hash );
       void request_sync_item_from_peer( const peer_connection_ptr& peer, const item_hash_t& item_to_request );
       void request_sync_items_from_peer( const peer_connection_ptr& peer, const std::vector<item_hash_t>& items_to_request );
+      unsigned get_sync_request_window_for_peer( const peer_connection_ptr& peer ) const;
+      bool can_accept_sync_request( const peer_connection_ptr& peer ) const;
       void fetch_sync_items_loop();
       void trigger_fetch_sync_items_loop();
 
@@ -687,9 +711,18 @@ namespace graphene { namespace net { namespace detail {
       void trigger_process_backlog_of_sync_blocks();
       void process_block_during_sync(peer_connection* originating_peer, const graphene::net::block_message& block_message, const message_hash_type& message_hash);
       void process_block_during_normal_operation(peer_connection* originating_peer, const graphene::net::block_message& block_message, const message_hash_type& message_hash);
-      void process_block_message(peer_connection* originating_peer, const message& message_to_process, const message_hash_type& message_hash);
+      void process_block_message(peer_connection* originating_peer, const graphene::net::block_message& block_message_to_process, const message_hash_type& message_hash);
+
+      fc::optional<compact_block_message> get_compact_block_message(const item_hash_t& block_message_hash);
+      void on_compact_block_message(peer_connection* originating_peer, const compact_block_message& compact_block_message_received);
+      void on_fetch_compact_block_transactions_message(peer_connection* originating_peer,
+                                                       const fetch_compact_block_transactions_message& fetch_compact_block_transactions_message_received);
+      void on_compact_block_transactions_message(peer_connection* originating_peer,
+                                                 const compact_block_transactions_message& compact_block_transactions_message_received);
+      void process_reconstructed_compact_block(peer_connection* originating_peer, const item_hash_t& block_message_hash, const signed_block& block);
 
       void process_ordinary_message(peer_connection* originating_peer, const message& message_to_process, const message_hash_type& message_hash);
+      void record_rejected_transaction(peer_connection* originating_peer);
 
       void start_synchronizing();
       void start_synchronizing_with_peer(const peer_connection_ptr& peer);
@@ -827,7 +860,8 @@ namespace graphene { namespace net { namespace detail {
       _node_is_shutting_down(false),
       _maximum_number_of_blocks_to_handle_at_one_time(MAXIMUM_NUMBER_OF_BLOCKS_TO_HANDLE_AT_ONE_TIME),
       _maximum_number_of_sync_blocks_to_prefetch(MAXIMUM_NUMBER_OF_BLOCKS_TO_PREFETCH),
-      _maximum_blocks_per_peer_during_syncing(GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING)
+      _maximum_blocks_per_peer_during_syncing(GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING),
+      _maximum_sync_request_window(GRAPHENE_NET_MAX_SYNC_REQUEST_WINDOW)
     {
       _rate_limiter.set_actual_rate_time_constant(fc::seconds(2));
       fc::rand_bytes((char*) _node_id.data(), (int)_node_id.size());
@@ -923,8 +957,10 @@ namespace graphene { namespace net { namespace detail {
             bool initiated_connection_this_pass = false;
             _potential_peer_database_updated = false;
 
+            // gather every peer we're allowed to try right now, then try the best-scoring ones first
+            std::vector<std::pair<double, fc::ip::endpoint> > candidates;
             for (peer_database::iterator iter = _potential_peer_db.begin();
-                 iter != _potential_peer_db.end() && is_wanting_new_connections();
+                 iter != _potential_peer_db.end();
                  ++iter)
             {
               fc::microseconds delay_until_retry = fc::seconds((iter->number_of_failed_connection_attempts + 1) * _peer_connection_retry_timeout);
@@ -934,10 +970,19 @@ namespace graphene { namespace net { namespace detail {
                     iter->last_connection_disposition != last_connection_rejected &&
                     iter->last_connection_disposition != last_connection_handshaking_failed) ||
                    (fc::time_point::now() - iter->last_connection_attempt_time) > delay_until_retry))
-              {
-                connect_to_endpoint(iter->endpoint);
-                initiated_connection_this_pass = true;
-              }
+                candidates.emplace_back(iter->score(), iter->endpoint);
+            }
+            std::stable_sort(candidates.begin(), candidates.end(),
+                             [](const std::pair<double, fc::ip::endpoint>& a, const std::pair<double, fc::ip::endpoint>& b) {
+                                return a.first > b.first;
+                             });
+
+            for (auto iter = candidates.begin(); iter != candidates.end() && is_wanting_new_connections(); ++iter)
+            {
+              if (is_connection_to_endpoint_in_progress(iter->second))
+                continue;
+              connect_to_endpoint(iter->second);
+              initiated_connection_this_pass = true;
             }
 
             if (!initiated_connection_this_pass && !_potential_peer_database_updated)
@@ -993,10 +1038,7 @@ namespace graphene { namespace net { namespace detail {
     bool node_impl::have_already_received_sync_item( const item_hash_t& item_hash )
     {
       VERIFY_CORRECT_THREAD();
-      return std::find_if(_received_sync_items.begin(), _received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _received_sync_items.end() ||
-             std::find_if(_new_received_sync_items.begin(), _new_received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _new_received_sync_items.end();                          ;
+      return _received_sync_item_ids.find(item_hash) != _received_sync_item_ids.end();
     }
 
     void node_impl::request_sync_item_from_peer( const peer_connection_ptr& peer, const item_hash_t& item_to_request )
@@ -1024,6 +1066,24 @@ namespace graphene { namespace net { namespace detail {
       peer->send_message(fetch_items_message(graphene::net::block_message_type, items_to_request));
     }
 
+    unsigned node_impl::get_sync_request_window_for_peer( const peer_connection_ptr& peer ) const
+    {
+      VERIFY_CORRECT_THREAD();
+      // a single request can't be larger than everything we're willing to buffer
+      return peer->get_sync_request_window( _maximum_blocks_per_peer_during_syncing,
+                                            std::min( _maximum_sync_request_window, _maximum_number_of_sync_blocks_to_prefetch ) );
+    }
+
+    bool node_impl::can_accept_sync_request( const peer_connection_ptr& peer ) const
+    {
+      VERIFY_CORRECT_THREAD();
+      // instead of waiting for a peer to go completely idle, top up its outstanding sync requests
+      // once half of its window has arrived so the peer always has blocks in flight to us
+      return peer->items_requested_from_peer.empty() &&
+             !peer->item_ids_requested_from_peer &&
+             peer->sync_items_requested_from_peer.size() <= get_sync_request_window_for_peer( peer ) / 2;
+    }
+
     void node_impl::fetch_sync_items_loop()
     {
       VERIFY_CORRECT_THREAD();
@@ -1040,14 +1100,26 @@ namespace graphene { namespace net { namespace detail {
             ASSERT_TASK_NOT_PREEMPTED();
             std::set<item_hash_t> sync_items_to_request;
 
-            // for each idle peer that we're syncing with
+            // visit the peers that deliver fastest first, so the blocks we need soonest (the ones at the
+            // front of each peer's list) are striped onto the quickest connections
+            std::vector<peer_connection_ptr> syncing_peers;
             for( const peer_connection_ptr& peer : _active_connections )
+              if( peer->we_need_sync_items_from_peer && !peer->inhibit_fetching_sync_blocks )
+                syncing_peers.push_back( peer );
+            std::stable_sort( syncing_peers.begin(), syncing_peers.end(),
+                              []( const peer_connection_ptr& a, const peer_connection_ptr& b ) {
+                                 return a->sync_blocks_per_second > b->sync_blocks_per_second;
+                              } );
+
+            // for each peer that we're syncing with and that has room in its request window
+            for( const peer_connection_ptr& peer : syncing_peers )
             {
-              if( peer->we_need_sync_items_from_peer &&
-                  sync_item_requests_to_send.find(peer) == sync_item_requests_to_send.end() && // if we've already scheduled a request for this peer, don't consider scheduling another
-                  peer->idle() )
+              if( sync_item_requests_to_send.find(peer) == sync_item_requests_to_send.end() && // if we've already scheduled a request for this peer, don't consider scheduling another
+                  can_accept_sync_request(peer) )
               {
-                if (!peer->inhibit_fetching_sync_blocks)
+                unsigned window = get_sync_request_window_for_peer(peer);
+                unsigned items_to_request_from_peer = window - std::min<unsigned>(window, peer->sync_items_requested_from_peer.size());
+                if (items_to_request_from_peer > 0)
                 {
                   // loop through the items it has that we don't yet have on our blockchain
                   for( unsigned i = 0; i < peer->ids_of_items_to_get.size(); ++i )
@@ -1061,7 +1133,7 @@ namespace graphene { namespace net { namespace detail {
                       // then schedule a request from this peer
                       sync_item_requests_to_send[peer].push_back(item_to_potentially_request);
                       sync_items_to_request.insert( item_to_potentially_request );
-                      if (sync_item_requests_to_send[peer].size() >= _maximum_blocks_per_peer_during_syncing)
+                      if (sync_item_requests_to_send[peer].size() >= items_to_request_from_peer)
                         break;
                     }
                   }
@@ -1196,11 +1268,16 @@ namespace graphene { namespace net { namespace detail {
             items_to_fetch_by_type[item.item_type].push_back(item.item_hash);
           for (auto& items_by_type : items_to_fetch_by_type)
           {
+            // ask peers that support it for new blocks in compact form.  We still track the
+            // request as a block item, the reply is turned back into a block_message when it arrives
+            uint32_t item_type_to_request = items_by_type.first;
+            if (item_type_to_request == graphene::net::block_message_type && peer_and_items.peer->supports_compact_blocks)
+              item_type_to_request = graphene::net::compact_block_message_type;
             dlog("requesting ${count} items of type ${type} from peer ${endpoint}: ${hashes}",
-                 ("count", items_by_type.second.size())("type", (uint32_t)items_by_type.first)
+                 ("count", items_by_type.second.size())("type", item_type_to_request)
                  ("endpoint", peer_and_items.peer->get_remote_endpoint())
                  ("hashes", items_by_type.second));
-            peer_and_items.peer->send_message(fetch_items_message(items_by_type.first,
+            peer_and_items.peer->send_message(fetch_items_message(item_type_to_request,
                                                                   items_by_type.second));
           }
         }
@@ -1808,7 +1885,16 @@ namespace graphene { namespace net { namespace detail {
         on_closing_connection_message(originating_peer, received_message.as<closing_connection_message>());
         break;
       case core_message_type_enum::block_message_type:
-        process_block_message(originating_peer, received_message, message_hash);
+        process_block_message(originating_peer, received_message.as<graphene::net::block_message>(), message_hash);
+        break;
+      case core_message_type_enum::compact_block_message_type:
+        on_compact_block_message(originating_peer, received_message.as<compact_block_message>());
+        break;
+      case core_message_type_enum::fetch_compact_block_transactions_message_type:
+        on_fetch_compact_block_transactions_message(originating_peer, received_message.as<fetch_compact_block_transactions_message>());
+        break;
+      case core_message_type_enum::compact_block_transactions_message_type:
+        on_compact_block_transactions_message(originating_peer, received_message.as<compact_block_transactions_message>());
         break;
       case core_message_type_enum::current_time_request_message_type:
         on_current_time_request_message(originating_peer, received_message.as<current_time_request_message>());
@@ -1860,6 +1946,7 @@ namespace graphene { namespace net { namespace detail {
       user_data["platform"] = "other";
 #endif
       user_data["bitness"] = sizeof(void*) * 8;
+      user_data["compact_block_relay_version"] = GRAPHENE_NET_COMPACT_BLOCK_RELAY_VERSION;
 
       user_data["node_id"] = fc::variant( _node_id, 1 );
 
@@ -1893,6 +1980,8 @@ namespace graphene { namespace net { namespace detail {
         originating_peer->node_id = user_data["node_id"].as<node_id_t>(1);
       if (user_data.contains("last_known_fork_block_number"))
         originating_peer->last_known_fork_block_number = user_data["last_known_fork_block_number"].as<uint32_t>(1);
+      if (user_data.contains("compact_block_relay_version"))
+        originating_peer->supports_compact_blocks = user_data["compact_block_relay_version"].as<uint32_t>(1) >= GRAPHENE_NET_COMPACT_BLOCK_RELAY_VERSION;
     }
 
     void node_impl::on_hello_message( peer_connection* originating_peer, const hello_message& hello_message_received )
@@ -2771,6 +2860,23 @@ namespace graphene { namespace net { namespace detail {
            ("type", fetch_items_message_received.item_type)
            ("endpoint", originating_peer->get_remote_endpoint()));
 
+      if (fetch_items_message_received.item_type == compact_block_message_type)
+      {
+        for (const item_hash_t& item_hash : fetch_items_message_received.items_to_fetch)
+        {
+          fc::optional<compact_block_message> compact_block = get_compact_block_message(item_hash);
+          if (compact_block)
+          {
+            originating_peer->last_block_delegate_has_seen = compact_block->block_id;
+            originating_peer->last_block_time_delegate_has_seen = compact_block->header.timestamp;
+            originating_peer->send_message(message(*compact_block));
+          }
+          else
+            originating_peer->send_message(item_not_available_message(item_id(block_message_type, item_hash)));
+        }
+        return;
+      }
+
       fc::optional<message> last_block_message_sent;
 
       std::list<message> reply_messages;
@@ -2830,6 +2936,150 @@ namespace graphene { namespace net { namespace detail {
       }
     }
 
+    fc::optional<compact_block_message> node_impl::get_compact_block_message(const item_hash_t& block_message_hash)
+    {
+      VERIFY_CORRECT_THREAD();
+      if (_most_recent_compact_block && _most_recent_compact_block->block_message_hash == block_message_hash)
+        return _most_recent_compact_block;
+
+      message block_message_to_compact = get_message_for_item(item_id(block_message_type, block_message_hash));
+      if (block_message_to_compact.msg_type != block_message_type)
+        return fc::optional<compact_block_message>();
+      _most_recent_compact_block = compact_block_message(block_message_to_compact.as<graphene::net::block_message>(), block_message_hash);
+      return _most_recent_compact_block;
+    }
+
+    void node_impl::on_compact_block_message(peer_connection* originating_peer, const compact_block_message& compact_block_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      if (originating_peer->items_requested_from_peer.find(item_id(block_message_type, compact_block_message_received.block_message_hash)) ==
+          originating_peer->items_requested_from_peer.end())
+      {
+        wlog("received a compact block ${block_id} I didn't ask for from peer ${endpoint}, ignoring it",
+             ("block_id", compact_block_message_received.block_id)
+             ("endpoint", originating_peer->get_remote_endpoint()));
+        return;
+      }
+      ++_compact_blocks_received;
+
+      // fill in every transaction we already received through normal transaction relay
+      peer_connection::partial_compact_block partial_block;
+      partial_block.block_message_hash = compact_block_message_received.block_message_hash;
+      static_cast<signed_block_header&>(partial_block.block) = compact_block_message_received.header;
+      partial_block.block.transactions.reserve(compact_block_message_received.transactions.size());
+      for (uint32_t i = 0; i < compact_block_message_received.transactions.size(); ++i)
+      {
+        const compact_block_transaction& compact_transaction = compact_block_message_received.transactions[i];
+        const message* cached_message = _message_cache.find_message(compact_transaction.transaction_message_id);
+        if (cached_message && cached_message->msg_type == trx_message_type)
+        {
+          partial_block.block.transactions.emplace_back(cached_message->as<trx_message>().trx);
+          partial_block.block.transactions.back().operation_results = compact_transaction.operation_results;
+        }
+        else
+        {
+          partial_block.block.transactions.emplace_back();
+          partial_block.missing_transaction_indexes.push_back(i);
+        }
+      }
+
+      if (partial_block.missing_transaction_indexes.empty())
+      {
+        process_reconstructed_compact_block(originating_peer, partial_block.block_message_hash, partial_block.block);
+        return;
+      }
+
+      dlog("missing ${count} of ${total} transactions in compact block ${block_id}, requesting them from peer ${endpoint}",
+           ("count", partial_block.missing_transaction_indexes.size())
+           ("total", partial_block.block.transactions.size())
+           ("block_id", compact_block_message_received.block_id)
+           ("endpoint", originating_peer->get_remote_endpoint()));
+      _compact_block_transactions_fetched += partial_block.missing_transaction_indexes.size();
+      originating_peer->send_message(fetch_compact_block_transactions_message(compact_block_message_received.block_id,
+                                                                              partial_block.missing_transaction_indexes));
+      originating_peer->compact_block_being_reconstructed = std::move(partial_block);
+    }
+
+    void node_impl::on_fetch_compact_block_transactions_message(peer_connection* originating_peer,
+                                                                const fetch_compact_block_transactions_message& fetch_compact_block_transactions_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      const block_id_type& block_id = fetch_compact_block_transactions_message_received.block_id;
+      compact_block_transactions_message reply(block_id);
+      try
+      {
+        graphene::net::block_message requested_block = _delegate->get_item(item_id(block_message_type, block_id)).as<graphene::net::block_message>();
+        reply.transactions.reserve(fetch_compact_block_transactions_message_received.transaction_indexes.size());
+        for (uint32_t index : fetch_compact_block_transactions_message_received.transaction_indexes)
+        {
+          if (index >= requested_block.block.transactions.size())
+          {
+            reply.transactions.clear();
+            break;
+          }
+          reply.transactions.push_back(std::move(requested_block.block.transactions[index]));
+        }
+      }
+      catch (const fc::canceled_exception&)
+      {
+        throw;
+      }
+      catch (const fc::exception&)
+      {
+        dlog("peer ${endpoint} asked for transactions from block ${block_id}, which we don't have",
+             ("endpoint", originating_peer->get_remote_endpoint())("block_id", block_id));
+      }
+      // an empty reply tells the peer to fetch the full block instead
+      originating_peer->send_message(reply);
+    }
+
+    void node_impl::on_compact_block_transactions_message(peer_connection* originating_peer,
+                                                          const compact_block_transactions_message& compact_block_transactions_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      if (!originating_peer->compact_block_being_reconstructed ||
+          originating_peer->compact_block_being_reconstructed->block.id() != compact_block_transactions_message_received.block_id)
+      {
+        dlog("received transactions for compact block ${block_id} from peer ${endpoint}, but I'm not waiting for them",
+             ("block_id", compact_block_transactions_message_received.block_id)
+             ("endpoint", originating_peer->get_remote_endpoint()));
+        return;
+      }
+      peer_connection::partial_compact_block partial_block = std::move(*originating_peer->compact_block_being_reconstructed);
+      originating_peer->compact_block_being_reconstructed.reset();
+
+      const std::vector<processed_transaction>& transactions = compact_block_transactions_message_received.transactions;
+      if (transactions.size() != partial_block.missing_transaction_indexes.size())
+      {
+        ++_compact_block_fallbacks;
+        originating_peer->send_message(fetch_items_message(block_message_type, std::vector<item_hash_t>{partial_block.block_message_hash}));
+        return;
+      }
+      for (size_t i = 0; i < transactions.size(); ++i)
+        partial_block.block.transactions[partial_block.missing_transaction_indexes[i]] = transactions[i];
+      process_reconstructed_compact_block(originating_peer, partial_block.block_message_hash, partial_block.block);
+    }
+
+    void node_impl::process_reconstructed_compact_block(peer_connection* originating_peer,
+                                                        const item_hash_t& block_message_hash,
+                                                        const signed_block& block)
+    {
+      VERIFY_CORRECT_THREAD();
+      // the hash we requested covers the whole serialized block message, so checking it catches
+      // both a bad reconstruction and a peer sending a compact block that doesn't match its inventory
+      graphene::net::block_message reconstructed_block(block);
+      if (message(reconstructed_block).id() != block_message_hash)
+      {
+        wlog("compact block ${block_id} from peer ${endpoint} does not match the block we requested, fetching the full block",
+             ("block_id", reconstructed_block.block_id)
+             ("endpoint", originating_peer->get_remote_endpoint()));
+        ++_compact_block_fallbacks;
+        originating_peer->send_message(fetch_items_message(block_message_type, std::vector<item_hash_t>{block_message_hash}));
+        return;
+      }
+      process_block_message(originating_peer, reconstructed_block, block_message_hash);
+    }
+
     void node_impl::on_item_not_available_message( peer_connection* originating_peer, const item_not_available_message& item_not_available_message_received )
     {
       VERIFY_CORRECT_THREAD();
@@ -2983,6 +3233,18 @@ namespace graphene { namespace net { namespace detail {
         }
       }
 
+      // a connection that failed before it was established was already counted by connect_to_task
+      if (inbound_endpoint && _handshaking_connections.find(originating_peer_ptr) != _handshaking_connections.end() &&
+          originating_peer->our_state != peer_connection::our_connection_state::disconnected)
+      {
+        fc::optional<potential_peer_record> updated_peer_record = _potential_peer_db.lookup_entry_for_endpoint(*inbound_endpoint);
+        if (updated_peer_record)
+        {
+          ++updated_peer_record->number_of_failed_handshakes;
+          _potential_peer_db.update_entry(*updated_peer_record);
+        }
+      }
+
       _closing_connections.erase(originating_peer_ptr);
       _handshaking_connections.erase(originating_peer_ptr);
       _terminating_connections.erase(originating_peer_ptr);
@@ -2996,6 +3258,11 @@ namespace graphene { namespace net { namespace detail {
           if (updated_peer_record)
           {
             updated_peer_record->last_seen_time = fc::time_point::now();
+            // a rate we only seeded from the database isn't a measurement, it must not feed back into it
+            updated_peer_record->record_connection_quality(originating_peer->round_trip_delay,
+                                                           originating_peer->sync_rate_measured ?
+                                                              originating_peer->sync_blocks_per_second : 0.,
+                                                           fc::time_point::now() - originating_peer->get_connection_time());
             _potential_peer_db.update_entry(*updated_peer_record);
           }
         }
@@ -3274,10 +3541,24 @@ namespace graphene { namespace net { namespace detail {
         dlog("currently ${count} sync items to consider", ("count", _received_sync_items.size()));
 
         block_processed_this_iteration = false;
+
+        // the blocks that could be next on the active chain or one of the forks are the ones at the
+        // front of our peers' lists; gather them once so the scan over the (possibly large, out-of-order)
+        // backlog below doesn't have to visit every peer for every buffered block
+        std::unordered_set<item_hash_t> next_block_ids;
+        for (const peer_connection_ptr& peer : _active_connections)
+        {
+          ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
+          if (!peer->ids_of_items_to_get.empty())
+            next_block_ids.insert(peer->ids_of_items_to_get.front());
+        }
+
         for (auto received_block_iter = _received_sync_items.begin();
              received_block_iter != _received_sync_items.end();
              ++received_block_iter)
         {
+          if (next_block_ids.find(received_block_iter->block_id) == next_block_ids.end())
+            continue;
 
           // find out if this block is the next block on the active chain or one of the forks
           bool potential_first_block = false;
@@ -3306,6 +3587,7 @@ namespace graphene { namespace net { namespace detail {
                           received_block_iter->block_id) == _most_recent_blocks_accepted.end())
             {
               graphene::net::block_message block_message_to_process = *received_block_iter;
+              _received_sync_item_ids.erase(received_block_iter->block_id);
               _received_sync_items.erase(received_block_iter);
               _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process](){
                 send_sync_block_to_node_delegate(block_message_to_process);
@@ -3380,6 +3662,7 @@ namespace graphene { namespace net { namespace detail {
       // add it to the front of _received_sync_items, then process _received_sync_items to try to
       // pass as many messages as possible to the client.
       _new_received_sync_items.push_front( block_message_to_process );
+      _received_sync_item_ids.insert( block_message_to_process.block_id );
       trigger_process_backlog_of_sync_blocks();
     }
 
@@ -3531,7 +3814,7 @@ namespace graphene { namespace net { namespace detail {
       }
     }
     void node_impl::process_block_message(peer_connection* originating_peer,
-                                          const message& message_to_process,
+                                          const graphene::net::block_message& block_message_to_process,
                                           const message_hash_type& message_hash)
     {
       VERIFY_CORRECT_THREAD();
@@ -3539,7 +3822,6 @@ namespace graphene { namespace net { namespace detail {
       // (it's possible that we request an item during normal operation and then get kicked into sync
       // mode before we receive and process the item.  In that case, we should process the item as a normal
       // item to avoid confusing the sync code)
-      graphene::net::block_message block_message_to_process(message_to_process.as<graphene::net::block_message>());
       auto item_iter = originating_peer->items_requested_from_peer.find(item_id(graphene::net::block_message_type, message_hash));
       if (item_iter != originating_peer->items_requested_from_peer.end())
       {
@@ -3556,6 +3838,7 @@ namespace graphene { namespace net { namespace detail {
                                                                                             block_message_to_process.block_id));
         if (sync_item_iter != originating_peer->sync_items_requested_from_peer.end())
         {
+          originating_peer->record_sync_block_received(sync_item_iter->second);
           originating_peer->sync_items_requested_from_peer.erase(sync_item_iter);
           // if exceptions are throw here after removing the sync item from the list (above),
           // it could leave our sync in a stalled state.  Wrap a try/catch around the rest
@@ -3574,6 +3857,8 @@ namespace graphene { namespace net { namespace detail {
               else
                 trigger_fetch_sync_items_loop();
             }
+            else if (can_accept_sync_request(originating_peer->shared_from_this()))
+              trigger_fetch_sync_items_loop(); // the peer has drained enough of its window to take another request
             return;
           }
           catch (const fc::canceled_exception& e)
@@ -3906,6 +4191,7 @@ namespace graphene { namespace net { namespace detail {
             trx_message transaction_message_to_process = message_to_process.as<trx_message>();
             dlog("passing message containing transaction ${trx} to client", ("trx", transaction_message_to_process.trx.id()));
             _delegate->handle_transaction(transaction_message_to_process);
+            ++originating_peer->transactions_accepted;
           }
           else
             _delegate->handle_message( message_to_process );
@@ -3920,6 +4206,8 @@ namespace graphene { namespace net { namespace detail {
           wlog( "client rejected message sent by peer ${peer}, ${e}", ("peer", originating_peer->get_remote_endpoint() )("e", e) );
           // record it so we don't try to fetch this item again
           _recently_failed_items.insert(peer_connection::timestamped_item_id(item_id(message_to_process.msg_type, message_hash ), fc::time_point::now()));
+          if (message_to_process.msg_type == trx_message_type)
+            record_rejected_transaction(originating_peer);
           return;
         }
 
@@ -3929,6 +4217,28 @@ namespace graphene { namespace net { namespace detail {
       }
     }
 
+    void node_impl::record_rejected_transaction( peer_connection* originating_peer )
+    {
+      VERIFY_CORRECT_THREAD();
+      ++originating_peer->transactions_rejected;
+
+      fc::time_point now = fc::time_point::now();
+      if( now - originating_peer->recent_transaction_rejections_since > fc::seconds( GRAPHENE_NET_REJECTED_TRX_WINDOW_SECONDS ) )
+      {
+        originating_peer->recent_transaction_rejections_since = now;
+        originating_peer->recent_transaction_rejections = 0;
+      }
+      if( ++originating_peer->recent_transaction_rejections >= GRAPHENE_NET_MAX_REJECTED_TRX_PER_WINDOW )
+      {
+        wlog( "peer ${peer} relayed ${n} transactions we rejected within ${w} seconds, not fetching transactions from it for ${s} seconds",
+              ("peer", originating_peer->get_remote_endpoint())("n", originating_peer->recent_transaction_rejections)
+              ("w", GRAPHENE_NET_REJECTED_TRX_WINDOW_SECONDS)("s", GRAPHENE_NET_REJECTED_TRX_INHIBIT_SECONDS) );
+        originating_peer->transaction_fetching_inhibited_until = now + fc::seconds( GRAPHENE_NET_REJECTED_TRX_INHIBIT_SECONDS );
+        originating_peer->recent_transaction_rejections_since = now;
+        originating_peer->recent_transaction_rejections = 0;
+      }
+    }
+
     void node_impl::start_synchronizing_with_peer( const peer_connection_ptr& peer )
     {
       VERIFY_CORRECT_THREAD();
@@ -3952,6 +4262,17 @@ namespace graphene { namespace net { namespace detail {
       VERIFY_CORRECT_THREAD();
       peer->send_message(current_time_request_message(),
                          offsetof(current_time_request_message, request_sent_time));
+
+      // if we've synced from this peer before, start from the rate we measured last time so it's
+      // favored (or not) from the first sync request
+      fc::optional<fc::ip::endpoint> inbound_endpoint = peer->get_endpoint_for_connecting();
+      if (inbound_endpoint)
+      {
+        fc::optional<potential_peer_record> peer_record = _potential_peer_db.lookup_entry_for_endpoint(*inbound_endpoint);
+        if (peer_record && peer_record->average_sync_blocks_per_second)
+          peer->sync_blocks_per_second = peer_record->average_sync_blocks_per_second;
+      }
+
       start_synchronizing_with_peer( peer );
       if( _active_connections.size() != _last_reported_number_of_connections )
       {
@@ -4775,6 +5096,7 @@ namespace graphene { namespace net { namespace detail {
       ilog( "node._active_sync_requests size: ${size}", ("size", _active_sync_requests.size() ) );
       ilog( "node._received_sync_items size: ${size}", ("size", _received_sync_items.size() ) );
       ilog( "node._new_received_sync_items size: ${size}", ("size", _new_received_sync_items.size() ) );
+      ilog( "node._received_sync_item_ids size: ${size}", ("size", _received_sync_item_ids.size() ) );
       ilog( "node._items_to_fetch size: ${size}", ("size", _items_to_fetch.size() ) );
       ilog( "node._new_inventory size: ${size}", ("size", _new_inventory.size() ) );
       ilog( "node._message_cache size: ${size}", ("size", _message_cache.size() ) );
@@ -4900,7 +5222,10 @@ namespace graphene { namespace net { namespace detail {
         peer_details["inbound"] = peer->direction == peer_connection_direction::inbound;
         peer_details["firewall_status"] = fc::variant( peer->is_firewalled, 1 );
         peer_details["startingheight"] = "";
-        peer_details["banscore"] = "";
+        peer_details["banscore"] = peer->recent_transaction_rejections;
+        peer_details["compact_blocks"] = peer->supports_compact_blocks;
+        peer_details["transactions_accepted"] = peer->transactions_accepted;
+        peer_details["transactions_rejected"] = peer->transactions_rejected;
         peer_details["syncnode"] = "";
 
         if (peer->fc_git_revision_sha)
@@ -4935,6 +5260,9 @@ namespace graphene { namespace net { namespace detail {
         peer_details["current_head_block"] = fc::variant( peer->last_block_delegate_has_seen, 1 );
         peer_details["current_head_block_number"] = _delegate->get_block_number(peer->last_block_delegate_has_seen);
         peer_details["current_head_block_time"] = peer->last_block_time_delegate_has_seen;
+        peer_details["sync_blocks_per_second"] = peer->sync_blocks_per_second;
+        peer_details["average_sync_block_latency_us"] = peer->average_sync_block_latency.count();
+        peer_details["average_sync_block_interval_us"] = peer->average_sync_block_interval.count();
 
         this_peer_status.info = peer_details;
         statuses.push_back(this_peer_status);
@@ -5019,6 +5347,8 @@ namespace graphene { namespace net { namespace detail {
         _maximum_number_of_sync_blocks_to_prefetch = params["maximum_number_of_sync_blocks_to_prefetch"].as<uint32_t>(1);
       if (params.contains("maximum_blocks_per_peer_during_syncing"))
         _maximum_blocks_per_peer_during_syncing = params["maximum_blocks_per_peer_during_syncing"].as<uint32_t>(1);
+      if (params.contains("maximum_sync_request_window"))
+        _maximum_sync_request_window = params["maximum_sync_request_window"].as<uint32_t>(1);
 
       _desired_number_of_connections = std::min(_desired_number_of_connections, _maximum_number_of_connections);
 
@@ -5038,6 +5368,7 @@ namespace graphene { namespace net { namespace detail {
       result["maximum_number_of_blocks_to_handle_at_one_time"] = _maximum_number_of_blocks_to_handle_at_one_time;
       result["maximum_number_of_sync_blocks_to_prefetch"] = _maximum_number_of_sync_blocks_to_prefetch;
       result["maximum_blocks_per_peer_during_syncing"] = _maximum_blocks_per_peer_during_syncing;
+      result["maximum_sync_request_window"] = _maximum_sync_request_window;
       return result;
     }
 
@@ -5106,6 +5437,9 @@ namespace graphene { namespace net { namespace detail {
       info["node_public_key"] = fc::variant( _node_public_key, 1 );
       info["node_id"] = fc::variant( _node_id, 1 );
       info["firewalled"] = fc::variant( _is_firewalled, 1 );
+      info["compact_blocks_received"] = _compact_blocks_received;
+      info["compact_block_transactions_fetched"] = _compact_block_transactions_fetched;
+      info["compact_block_fallbacks"] = _compact_block_fallbacks;
       return info;
     }
     fc::variant_object node_impl::network_get_usage_stats() const
@@ -470,6 +470,46 @@ namespace graphene { namespace net
       return transaction_fetching_inhibited_until > fc::time_point::now();
     }
 
+    void peer_connection::record_sync_block_received(const fc::time_point& request_time, const fc::time_point& now)
+    {
+      VERIFY_CORRECT_THREAD();
+      // blocks in one request arrive back-to-back, so the gap since the previous block is the peer's
+      // delivery time for this one.  If the peer was idle in between, measure from when we asked instead.
+      // The gaps are averaged rather than their inverses: a few blocks landing in the same read would
+      // otherwise count as near-infinite rates and drag the average far above the real throughput.
+      fc::time_point delivery_start = std::max(last_sync_block_received_time, request_time);
+      int64_t interval_us = std::max<int64_t>((now - delivery_start).count(), 1);
+      int64_t latency_us = (now - request_time).count();
+      if (!sync_rate_measured)
+      {
+        // start from the rate seeded from the peer database, if any, so one sample doesn't replace it
+        average_sync_block_interval = fc::microseconds(sync_blocks_per_second > 0. ?
+                                                          (int64_t)(1000000. / sync_blocks_per_second) : interval_us);
+        average_sync_block_latency = fc::microseconds(latency_us);
+      }
+      else
+        average_sync_block_latency = fc::microseconds(average_sync_block_latency.count() +
+                                                      (latency_us - average_sync_block_latency.count()) / 8);
+      // exponential moving average, weighting the newest sample at 1/8
+      average_sync_block_interval = fc::microseconds(std::max<int64_t>(average_sync_block_interval.count() +
+                                                                       (interval_us - average_sync_block_interval.count()) / 8, 1));
+      sync_blocks_per_second = 1000000. / average_sync_block_interval.count();
+      last_sync_block_received_time = now;
+      sync_rate_measured = true;
+    }
+
+    unsigned peer_connection::get_sync_request_window(unsigned unmeasured_window, unsigned maximum_window) const
+    {
+      VERIFY_CORRECT_THREAD();
+      // until we've measured the peer, fall back to the configured fixed request size
+      if (sync_blocks_per_second <= 0.)
+        return std::min(unmeasured_window, maximum_window);
+      // ask for as many blocks as the peer delivers in GRAPHENE_NET_SYNC_REQUEST_TARGET_DURATION_MS
+      double window = sync_blocks_per_second * GRAPHENE_NET_SYNC_REQUEST_TARGET_DURATION_MS / 1000.;
+      window = std::min(window, (double)maximum_window);
+      return std::max((unsigned)window, std::min<unsigned>(GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING, maximum_window));
+    }
+
     fc::sha512 peer_connection::get_shared_secret() const
     {
       VERIFY_CORRECT_THREAD();
@@ -30,15 +30,58 @@
 
 #include <fc/io/raw.hpp>
 #include <fc/io/raw_variant.hpp>
+#include <fc/io/fstream.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/io/json.hpp>
 
+#include <cmath>
+#include <cstring>
+
 #include <graphene/net/peer_database.hpp>
 #include <graphene/net/config.hpp>
 
 namespace graphene { namespace net {
+
+  double potential_peer_record::score() const
+  {
+    // how often connecting to the peer has worked out, with a uniform prior so new peers start at 0.5
+    uint32_t failures = number_of_failed_connection_attempts + number_of_failed_handshakes;
+    double reliability = (number_of_successful_connection_attempts + 1.) /
+                         (number_of_successful_connection_attempts + failures + 2.);
+    // saturates after a day of total connection time
+    double uptime = std::min(1., total_connected_seconds / 86400.);
+    double latency = average_round_trip_delay_ms ? 100. / (100. + average_round_trip_delay_ms) : 0.5;
+    double bandwidth = average_sync_blocks_per_second ?
+                       average_sync_blocks_per_second / (average_sync_blocks_per_second + 100.) : 0.5;
+    return 0.4 * reliability + 0.15 * uptime + 0.15 * latency + 0.3 * bandwidth;
+  }
+
+  void potential_peer_record::record_connection_quality( const fc::microseconds& round_trip_delay,
+                                                         double sync_blocks_per_second,
+                                                         const fc::microseconds& connected_duration )
+  {
+    // blend new measurements in at 1/4 so one bad connection doesn't erase a peer's history
+    uint32_t round_trip_delay_ms = (uint32_t)std::max<int64_t>(round_trip_delay.count() / 1000, 1);
+    if (round_trip_delay.count() > 0)
+      average_round_trip_delay_ms = average_round_trip_delay_ms ?
+                                    (3 * average_round_trip_delay_ms + round_trip_delay_ms) / 4 :
+                                    round_trip_delay_ms;
+    if (sync_blocks_per_second > 0.)
+    {
+      uint32_t rate = (uint32_t)std::ceil(sync_blocks_per_second);
+      average_sync_blocks_per_second = average_sync_blocks_per_second ?
+                                       (3 * average_sync_blocks_per_second + rate) / 4 :
+                                       rate;
+    }
+    if (connected_duration.count() > 0)
+      total_connected_seconds += (uint32_t)connected_duration.to_seconds();
+  }
+
   namespace detail
   {
+    /// peer database files start with these bytes, followed by the raw-packed list of records
+    static const char peer_database_magic[] = { 'P', 'P', 'D', 'B', 0, 0, 0, 1 };
+
     using namespace boost::multi_index;
 
     class peer_database_impl
@@ -61,6 +104,9 @@ namespace graphene { namespace net {
       potential_peer_set     _potential_peer_set;
       fc::path _peer_database_filename;
 
+      std::vector<potential_peer_record> load_binary(const fc::path& filename, const std::string& contents);
+      void save_binary(const fc::path& filename, const std::vector<potential_peer_record>& peer_records);
+
     public:
       void open(const fc::path& databaseFilename);
       void close();
@@ -87,14 +133,54 @@ namespace graphene { namespace net {
     peer_database_iterator::peer_database_iterator( const peer_database_iterator& c ) :
       boost::iterator_facade<peer_database_iterator, const potential_peer_record, boost::forward_traversal_tag>(c){}
 
+    std::vector<potential_peer_record> peer_database_impl::load_binary(const fc::path& filename, const std::string& contents)
+    {
+      FC_ASSERT( contents.size() >= sizeof(peer_database_magic) &&
+                 memcmp(contents.data(), peer_database_magic, sizeof(peer_database_magic)) == 0,
+                 "${file} is not a peer database file", ("file", filename) );
+      return fc::raw::unpack<std::vector<potential_peer_record> >( contents.data() + sizeof(peer_database_magic),
+                                                                   contents.size() - sizeof(peer_database_magic) );
+    }
+
+    void peer_database_impl::save_binary(const fc::path& filename, const std::vector<potential_peer_record>& peer_records)
+    {
+      std::vector<char> packed_records = fc::raw::pack( peer_records );
+      // write to a temporary file and move it into place so a crash never leaves a truncated database
+      fc::path temporary_filename = filename;
+      temporary_filename.replace_extension(".tmp");
+      {
+        fc::ofstream out(temporary_filename);
+        out.write(peer_database_magic, sizeof(peer_database_magic));
+        out.write(packed_records.data(), packed_records.size());
+        out.close();
+      }
+      fc::rename(temporary_filename, filename);
+    }
+
     void peer_database_impl::open(const fc::path& peer_database_filename)
     {
       _peer_database_filename = peer_database_filename;
-      if (fc::exists(_peer_database_filename))
+      // older versions kept the database as JSON in a file with the same name and a .json extension;
+      // import it if we haven't written a binary database yet
+      fc::path legacy_json_filename = _peer_database_filename;
+      legacy_json_filename.replace_extension(".json");
+      bool load_legacy_json = !fc::exists(_peer_database_filename) && fc::exists(legacy_json_filename);
+      if (fc::exists(_peer_database_filename) || load_legacy_json)
       {
         try
         {
-          std::vector<potential_peer_record> peer_records = fc::json::from_file(_peer_database_filename).as<std::vector<potential_peer_record> >( GRAPHENE_NET_MAX_NESTED_OBJECTS );
+          std::vector<potential_peer_record> peer_records;
+          if (load_legacy_json)
+          {
+            ilog("importing peer database from ${file}", ("file", legacy_json_filename));
+            peer_records = fc::json::from_file(legacy_json_filename).as<std::vector<potential_peer_record> >( GRAPHENE_NET_MAX_NESTED_OBJECTS );
+          }
+          else
+          {
+            std::string contents;
+            fc::read_file_contents(_peer_database_filename, contents);
+            peer_records = load_binary(_peer_database_filename, contents);
+          }
           std::copy(peer_records.begin(), peer_records.end(), std::inserter(_potential_peer_set, _potential_peer_set.end()));
           if (_potential_peer_set.size() > MAXIMUM_PEERDB_SIZE)
           {
@@ -123,7 +209,7 @@ namespace graphene { namespace net {
         fc::path peer_database_filename_dir = _peer_database_filename.parent_path();
         if (!fc::exists(peer_database_filename_dir))
           fc::create_directories(peer_database_filename_dir);
-        fc::json::save_to_file( peer_records, _peer_database_filename, GRAPHENE_NET_MAX_NESTED_OBJECTS );
+        save_binary( _peer_database_filename, peer_records );
       }
       catch (const fc::exception& e)
       {
@@ -282,6 +368,8 @@ FC_REFLECT_ENUM( graphene::net::potential_peer_last_connection_disposition,
 FC_REFLECT_DERIVED_NO_TYPENAME( graphene::net::potential_peer_record, BOOST_PP_SEQ_NIL,
                                 (endpoint)(last_seen_time)(last_connection_disposition)
                                 (last_connection_attempt_time)(number_of_successful_connection_attempts)
-                                (number_of_failed_connection_attempts)(last_error) )
+                                (number_of_failed_connection_attempts)(last_error)
+                                (number_of_failed_handshakes)(average_round_trip_delay_ms)
+                                (average_sync_blocks_per_second)(total_connected_seconds) )
 
 GRAPHENE_EXTERNAL_SERIALIZATION(/*not extern*/, graphene::net::potential_peer_record)
@@ -39,6 +39,8 @@
 #include <graphene/bookie/bookie_plugin.hpp>
 #include <graphene/bookie/bookie_objects.hpp>
 
+#include <boost/range/iterator_range.hpp>
+
 namespace graphene { namespace bookie {
 
 namespace detail {
@@ -55,6 +57,7 @@ class bookie_api_impl
       fc::variants get_objects(const vector<object_id_type>& ids) const;
       std::vector<matched_bet_object> get_matched_bets_for_bettor(account_id_type bettor_id) const;
       std::vector<matched_bet_object> get_all_matched_bets_for_bettor(account_id_type bettor_id, bet_id_type start, unsigned limit) const;
+      betting_market_settlement_status get_betting_market_settlement_status() const;
       graphene::app::application& app;
 };
 
@@ -257,6 +260,31 @@ std::vector<matched_bet_object> bookie_api_impl::get_all_matched_bets_for_bettor
    return result;
 }
 
+betting_market_settlement_status bookie_api_impl::get_betting_market_settlement_status() const
+{
+   std::shared_ptr<graphene::chain::database> db = app.chain_database();
+   betting_market_settlement_status result;
+   result.positions_settled_per_block = db->get_global_properties().parameters.betting_positions_settled_per_block();
+   result.last_block = db->get_betting_market_settlement_statistics();
+
+   const auto& betting_market_group_index = db->get_index_type<betting_market_group_object_index>().indices().get<graphene::chain::by_settling_time>();
+   const auto& betting_market_index = db->get_index_type<betting_market_object_index>().indices().get<graphene::chain::by_betting_market_group_id>();
+   const auto& position_index = db->get_index_type<betting_market_position_index>().indices().get<graphene::chain::by_betting_market_bettor>();
+   for (auto group_iter = betting_market_group_index.upper_bound(fc::optional<fc::time_point_sec>());
+        group_iter != betting_market_group_index.end() && group_iter->is_settling(db->head_block_time());
+        ++group_iter)
+   {
+      result.pending_groups.push_back(group_iter->id);
+      for (const betting_market_object& betting_market :
+           boost::make_iterator_range(betting_market_index.equal_range(group_iter->id)))
+      {
+         auto positions = position_index.equal_range(betting_market.id);
+         result.pending_positions += std::distance(positions.first, positions.second);
+      }
+   }
+   return result;
+}
+
 std::shared_ptr<graphene::bookie::bookie_plugin> bookie_api_impl::get_plugin()
 {
    return app.get_plugin<graphene::bookie::bookie_plugin>("bookie");
@@ -311,6 +339,11 @@ std::vector<matched_bet_object> bookie_api::get_all_matched_bets_for_bettor(acco
    return my->get_all_matched_bets_for_bettor(bettor_id, start, limit);
 }
 
+betting_market_settlement_status bookie_api::get_betting_market_settlement_status() const
+{
+   return my->get_betting_market_settlement_status();
+}
+
 } } // graphene::bookie
 
 
@@ -32,6 +32,7 @@
 #include <graphene/protocol/types.hpp>
 #include <graphene/protocol/asset.hpp>
 #include <graphene/chain/event_object.hpp>
+#include <graphene/chain/betting_market_object.hpp>
 
 using namespace graphene::chain;
 
@@ -77,6 +78,17 @@ struct matched_bet_object {
    std::vector<operation_history_id_type> associated_operations;
 };
 
+struct betting_market_settlement_status {
+   // betting market groups past their settling time whose payouts are not finished yet
+   std::vector<betting_market_group_id_type> pending_groups;
+   // positions still to be paid out in those groups
+   uint32_t pending_positions = 0;
+   // the current per-block settlement budget, in positions
+   uint32_t positions_settled_per_block = 0;
+   // work done by the most recently applied block
+   graphene::chain::betting_market_settlement_statistics last_block;
+};
+
 class bookie_api
 {
    public:
@@ -93,6 +105,10 @@ class bookie_api
       fc::variants get_objects(const vector<object_id_type>& ids)const;
       std::vector<matched_bet_object> get_matched_bets_for_bettor(account_id_type bettor_id) const;
       std::vector<matched_bet_object> get_all_matched_bets_for_bettor(account_id_type bettor_id, bet_id_type start = bet_id_type(), unsigned limit = 1000) const;
+      /**
+       * Returns the betting market group settlement queue and the settlement work done in the last block.
+       */
+      betting_market_settlement_status get_betting_market_settlement_status() const;
       std::shared_ptr<detail::bookie_api_impl> my;
 };
 
@@ -101,6 +117,7 @@ class bookie_api
 FC_REFLECT(graphene::bookie::order_bin, (amount_to_bet)(backer_multiplier))
 FC_REFLECT(graphene::bookie::binned_order_book, (aggregated_back_bets)(aggregated_lay_bets))
 FC_REFLECT(graphene::bookie::matched_bet_object, (id)(bettor_id)(betting_market_id)(amount_to_bet)(backer_multiplier)(back_or_lay)(end_of_delay)(amount_matched)(associated_operations))
+FC_REFLECT(graphene::bookie::betting_market_settlement_status, (pending_groups)(pending_positions)(positions_settled_per_block)(last_block))
 
 FC_API(graphene::bookie::bookie_api,
        (get_binned_order_book)
@@ -108,5 +125,6 @@ FC_API(graphene::bookie::bookie_api,
        (get_events_containing_sub_string)
        (get_objects)
        (get_matched_bets_for_bettor)
-       (get_all_matched_bets_for_bettor))
+       (get_all_matched_bets_for_bettor)
+       (get_betting_market_settlement_status))
 
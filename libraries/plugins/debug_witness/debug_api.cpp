@@ -14,6 +14,8 @@
 #include <graphene/debug_witness/debug_api.hpp>
 #include <graphene/debug_witness/debug_witness.hpp>
 
+#include <graphene/witness/witness.hpp>
+
 namespace graphene { namespace debug_witness {
 
 namespace detail {
@@ -28,6 +30,7 @@ class debug_api_impl
       void debug_update_object( const fc::variant_object& update );
       void debug_stream_json_objects( const std::string& filename );
       void debug_stream_json_objects_flush();
+      fc::variants debug_get_block_production_timings();
       std::shared_ptr< graphene::debug_witness_plugin::debug_witness_plugin > get_plugin();
 
       graphene::app::application& app;
@@ -119,6 +122,15 @@ void debug_api_impl::debug_stream_json_objects_flush()
    get_plugin()->flush_json_object_stream();
 }
 
+fc::variants debug_api_impl::debug_get_block_production_timings()
+{
+   auto witness = app.get_plugin< graphene::witness_plugin::witness_plugin >( "witness" );
+   fc::variants result;
+   for( const auto& timing : witness->get_block_production_timings() )
+      result.emplace_back( timing, GRAPHENE_MAX_NESTED_OBJECTS );
+   return result;
+}
+
 } // detail
 
 debug_api::debug_api( graphene::app::application& app )
@@ -151,5 +163,10 @@ void debug_api::debug_stream_json_objects_flush()
    my->debug_stream_json_objects_flush();
 }
 
+fc::variants debug_api::debug_get_block_production_timings()
+{
+   return my->debug_get_block_production_timings();
+}
+
 
 } } // graphene::debug_witness
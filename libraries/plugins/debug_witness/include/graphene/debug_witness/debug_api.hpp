@@ -82,6 +82,11 @@ class debug_api
        */
       void debug_stream_json_objects_flush();
 
+      /**
+       * Latency breakdown of the blocks most recently produced by the witness plugin, oldest first.
+       */
+      fc::variants debug_get_block_production_timings();
+
       std::shared_ptr< detail::debug_api_impl > my;
 };
 
@@ -93,4 +98,5 @@ FC_API(graphene::debug_witness::debug_api,
        (debug_update_object)
        (debug_stream_json_objects)
        (debug_stream_json_objects_flush)
+       (debug_get_block_production_timings)
      )
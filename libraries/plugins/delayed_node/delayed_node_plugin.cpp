@@ -31,10 +31,17 @@
 #include <fc/rpc/websocket_api.hpp>
 #include <fc/api.hpp>
 
+#include <deque>
+
 namespace graphene { namespace delayed_node {
 namespace bpo = boost::program_options;
 
 namespace detail {
+/// Blocks fetched from the trusted node per get_blocks call (the API returns at most 101)
+const uint32_t blocks_per_request = 100;
+/// Number of get_blocks calls kept in flight while catching up
+const size_t max_outstanding_requests = 4;
+
 struct delayed_node_plugin_impl {
    std::string remote_endpoint;
    fc::http::websocket_client client;
@@ -43,6 +50,8 @@ struct delayed_node_plugin_impl {
    boost::signals2::scoped_connection client_connection_closed;
    graphene::chain::block_id_type last_received_remote_head;
    graphene::chain::block_id_type last_processed_remote_head;
+   /// set by the block applied callback to wake up the main loop once we are caught up
+   fc::promise<void>::ptr remote_head_changed;
 };
 }
 
@@ -97,13 +106,42 @@ void delayed_node_plugin::sync_with_trusted_node()
          break;
       }
       pass_count++;
-      while( remote_dpo.last_irreversible_block_num > db.head_block_num() )
+
+      // Fetch the missing blocks in ranges, keeping several requests in flight so that the round trips
+      // to the trusted node overlap with pushing the blocks we already have.
+      typedef std::vector<fc::optional<graphene::chain::signed_block>> block_batch;
+      std::deque<fc::future<block_batch>> pending_requests;
+      const uint32_t last_block_to_sync = remote_dpo.last_irreversible_block_num;
+      uint32_t next_block_to_request = db.head_block_num() + 1;
+      auto request_more_blocks = [&]() {
+         while( pending_requests.size() < detail::max_outstanding_requests && next_block_to_request <= last_block_to_sync )
+         {
+            const uint32_t first = next_block_to_request;
+            const uint32_t last = std::min( last_block_to_sync, first + detail::blocks_per_request - 1 );
+            fc::api<graphene::app::database_api> database_api = my->database_api;
+            pending_requests.push_back( fc::async( [database_api, first, last]() {
+               return database_api->get_blocks( first, last );
+            }, "delayed_node get_blocks" ) );
+            next_block_to_request = last + 1;
+         }
+      };
+
+      request_more_blocks();
+      while( !pending_requests.empty() )
       {
-         fc::optional<graphene::chain::signed_block> block = my->database_api->get_block( db.head_block_num()+1 );
-         FC_ASSERT(block, "Trusted node claims it has blocks it doesn't actually have.");
-         ilog("Pushing block #${n}", ("n", block->block_num()));
-         db.push_block(*block);
-         synced_blocks++;
+         block_batch blocks = pending_requests.front().wait();
+         pending_requests.pop_front();
+         request_more_blocks();
+
+         FC_ASSERT( !blocks.empty(), "Trusted node returned no blocks" );
+         ilog( "Pushing blocks #${first} to #${last}", ("first", db.head_block_num() + 1)("last", db.head_block_num() + blocks.size()) );
+         for( const fc::optional<graphene::chain::signed_block>& block : blocks )
+         {
+            FC_ASSERT( block, "Trusted node claims it has blocks it doesn't actually have." );
+            FC_ASSERT( block->block_num() == db.head_block_num() + 1, "Trusted node returned block #${n} out of order", ("n", block->block_num()) );
+            db.push_block( *block );
+            synced_blocks++;
+         }
       }
    }
 }
@@ -114,13 +152,25 @@ void delayed_node_plugin::mainloop()
    {
       try
       {
-         fc::usleep( fc::microseconds( 296645 ) );  // wake up a little over 3Hz
-
          if( my->last_received_remote_head == my->last_processed_remote_head )
+         {
+            // we're caught up, wait for the trusted node to apply a block.  Keep waking up a little over 3Hz
+            // in case a notification is lost.
+            my->remote_head_changed = fc::promise<void>::create( "graphene::delayed_node::remote_head_changed" );
+            try
+            {
+               my->remote_head_changed->wait_until( fc::time_point::now() + fc::microseconds( 296645 ) );
+            }
+            catch( const fc::timeout_exception& ) //intentionally not logged
+            {
+            }
+            my->remote_head_changed.reset();
             continue;
+         }
 
+         graphene::chain::block_id_type remote_head = my->last_received_remote_head;
          sync_with_trusted_node();
-         my->last_processed_remote_head = my->last_received_remote_head;
+         my->last_processed_remote_head = remote_head;
       }
       catch( const fc::exception& e )
       {
@@ -142,6 +192,8 @@ void delayed_node_plugin::plugin_startup()
       my->database_api->set_block_applied_callback([this]( const fc::variant& block_id )
       {
          fc::from_variant( block_id, my->last_received_remote_head, GRAPHENE_MAX_NESTED_OBJECTS );
+         if( my->remote_head_changed )
+            my->remote_head_changed->set_value();
       } );
       return;
    }
@@ -28,6 +28,8 @@
 
 #include <fc/thread/future.hpp>
 
+#include <deque>
+
 namespace graphene { namespace witness_plugin {
 
 namespace block_production_condition
@@ -46,10 +48,28 @@ namespace block_production_condition
    };
 }
 
+/// Where the time went when producing a block; durations are in microseconds
+struct block_production_timing
+{
+   uint32_t               block_num = 0;
+   chain::witness_id_type witness;
+   fc::time_point_sec     slot_time;
+   int64_t                wakeup_lag = 0;    ///< production loop wakeup minus its scheduled wakeup
+   int64_t                slot_offset = 0;   ///< production loop wakeup minus the slot time
+   bool                   pre_assembled = false;
+   int64_t                assemble = 0;      ///< re-applying pending transactions, merkle root and secrets
+   int64_t                sign = 0;
+   int64_t                push = 0;
+   int64_t                broadcast = 0;     ///< end of push until the block was handed to the p2p node
+   uint32_t               transaction_count = 0;
+};
+
 class witness_plugin : public graphene::app::plugin {
 public:
    ~witness_plugin() {
       try {
+         if( _block_assembly_task.valid() )
+            _block_assembly_task.cancel_and_wait(__FUNCTION__);
          if( _block_production_task.valid() )
             _block_production_task.cancel_and_wait(__FUNCTION__);
       } catch(fc::canceled_exception&) {
@@ -72,10 +92,15 @@ public:
    virtual void plugin_startup() override;
    virtual void plugin_shutdown() override;
 
+   /// Timings of the most recently produced blocks, oldest first
+   std::vector<block_production_timing> get_block_production_timings()const;
+
 private:
    void schedule_production_loop();
    block_production_condition::block_production_condition_enum block_production_loop();
    block_production_condition::block_production_condition_enum maybe_produce_block( fc::limited_mutable_variant_object& capture );
+   void pre_assemble_block( fc::time_point_sec when );
+   void record_broadcast( uint32_t block_num, fc::microseconds broadcast_time );
 
    boost::program_options::variables_map _options;
    bool _production_enabled = false;
@@ -85,6 +110,20 @@ private:
    std::map<chain::public_key_type, fc::ecc::private_key> _private_keys;
    std::set<chain::witness_id_type> _witnesses;
    fc::future<void> _block_production_task;
+   fc::time_point _scheduled_wakeup;
+
+   /// How long before a slot to assemble its block in advance, zero to assemble it at the slot
+   fc::microseconds _block_assembly_lead;
+   fc::future<void> _block_assembly_task;
+   fc::optional<chain::signed_block> _pre_assembled_block;
+   fc::microseconds _pre_assembly_time;
+
+   static const size_t max_production_timings = 100;
+   std::deque<block_production_timing> _production_timings;
 };
 
 } } //graphene::witness_plugin
+
+FC_REFLECT( graphene::witness_plugin::block_production_timing,
+            (block_num)(witness)(slot_time)(wakeup_lag)(slot_offset)(pre_assembled)
+            (assemble)(sign)(push)(broadcast)(transaction_count) )
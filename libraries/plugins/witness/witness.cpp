@@ -77,6 +77,8 @@ void witness_plugin::plugin_set_program_options(
          ("private-key", bpo::value<vector<string>>()->composing()->multitoken()->
           DEFAULT_VALUE_VECTOR(std::make_pair(chain::public_key_type(default_priv_key.get_public_key()), graphene::utilities::key_to_wif(default_priv_key))),
           "Tuple of [PublicKey, WIF private key] (may specify multiple times)")
+         ("block-assembly-lead-ms", bpo::value<uint32_t>()->default_value(0),
+          "Assemble our blocks this many milliseconds (less than 1000) before their slot, so only signing and pushing are left at the slot time; 0 to assemble at the slot")
          ;
    config_file_options.add(command_line_options);
 }
@@ -120,6 +122,13 @@ void witness_plugin::plugin_initialize(const boost::program_options::variables_m
          _private_keys[key_id_to_wif_pair.first] = *private_key;
       }
    }
+
+   if( options.count("block-assembly-lead-ms") )
+   {
+      const uint32_t lead_ms = options["block-assembly-lead-ms"].as<uint32_t>();
+      FC_ASSERT( lead_ms < 1000, "block-assembly-lead-ms must be less than 1000" );
+      _block_assembly_lead = fc::milliseconds( lead_ms );
+   }
    ilog("witness plugin:  plugin_initialize() end");
 } FC_LOG_AND_RETHROW() }
 
@@ -159,9 +168,65 @@ void witness_plugin::schedule_production_loop()
        time_to_next_second += 1000000;
 
    fc::time_point next_wakeup( now + fc::microseconds( time_to_next_second ) );
+   _scheduled_wakeup = next_wakeup;
 
    _block_production_task = fc::schedule([this]{block_production_loop();},
                                          next_wakeup, "Witness Block Production");
+
+   if( _block_assembly_lead.count() > 0 && next_wakeup - _block_assembly_lead > now )
+   {
+      const fc::time_point_sec slot_time( next_wakeup );
+      _block_assembly_task = fc::schedule([this, slot_time]{pre_assemble_block(slot_time);},
+                                          next_wakeup - _block_assembly_lead, "Witness Block Assembly");
+   }
+}
+
+void witness_plugin::pre_assemble_block( fc::time_point_sec when )
+{
+   _pre_assembled_block.reset();
+   if( !_production_enabled )
+      return;
+   try
+   {
+      chain::database& db = database();
+      const uint32_t slot = db.get_slot_at_time( when );
+      if( slot == 0 || db.get_slot_time( slot ) != when )
+         return;
+      const graphene::chain::witness_id_type scheduled_witness = db.get_scheduled_witness( slot );
+      if( _witnesses.find( scheduled_witness ) == _witnesses.end() )
+         return;
+      const auto private_key_itr = _private_keys.find( scheduled_witness( db ).signing_key );
+      if( private_key_itr == _private_keys.end() )
+         return;
+
+      const fc::time_point start = fc::time_point::now();
+      _pre_assembled_block = db.assemble_block( when, scheduled_witness, private_key_itr->second, _production_skip_flags );
+      _pre_assembly_time = fc::time_point::now() - start;
+   }
+   catch( const fc::canceled_exception& )
+   {
+      throw;
+   }
+   catch( const fc::exception& e )
+   {
+      wlog( "Failed to assemble block ahead of slot ${t}, it will be assembled at the slot: ${e}",
+            ("t", when)("e", e.to_detail_string()) );
+   }
+}
+
+vector<block_production_timing> witness_plugin::get_block_production_timings()const
+{
+   return vector<block_production_timing>( _production_timings.begin(), _production_timings.end() );
+}
+
+void witness_plugin::record_broadcast( uint32_t block_num, fc::microseconds broadcast_time )
+{
+   for( auto itr = _production_timings.rbegin(); itr != _production_timings.rend(); ++itr )
+      if( itr->block_num == block_num )
+      {
+         itr->broadcast = broadcast_time.count();
+         return;
+      }
 }
 
 block_production_condition::block_production_condition_enum witness_plugin::block_production_loop()
@@ -190,6 +255,9 @@ block_production_condition::block_production_condition_enum witness_plugin::bloc
       case block_production_condition::produced:
          ilog("Generated block #${n} with timestamp ${t} at time ${c}", 
                ("n", capture["n"])("t", capture["t"])("c", capture["c"]));
+         ilog("Block #${n} took ${a}us to assemble${p}, ${s}us to sign and ${u}us to push, woke up ${o}us after the slot",
+               ("n", capture["n"])("a", capture["assemble"])("p", capture["pre_assembled"].as_bool() ? " in advance" : "")
+               ("s", capture["sign"])("u", capture["push"])("o", capture["slot_offset"]));
          break;
       case block_production_condition::not_synced:
          ilog("Not producing block because production is disabled until we receive a recent block (see: --enable-stale-production)");
@@ -226,6 +294,9 @@ block_production_condition::block_production_condition_enum witness_plugin::mayb
    chain::database& db = database();
    fc::time_point now_fine = fc::time_point::now();
    fc::time_point_sec now = now_fine + fc::microseconds( 500000 );
+   const fc::time_point scheduled_wakeup = _scheduled_wakeup;
+   fc::optional<chain::signed_block> pre_assembled_block;
+   std::swap( pre_assembled_block, _pre_assembled_block );
 
    // If the next block production opportunity is in the present or future, we're synced.
    if( !_production_enabled )
@@ -296,15 +367,51 @@ block_production_condition::block_production_condition_enum witness_plugin::mayb
    //if (gpo.parameters.witness_schedule_algorithm == GRAPHENE_WITNESS_SCHEDULED_ALGORITHM)
    //ilog("Witness ${id} production slot has arrived; generating a block now...", ("id", scheduled_witness));
 
-   auto block = db.generate_block(
-      scheduled_time,
-      scheduled_witness,
-      private_key_itr->second,
-      _production_skip_flags
-      );
+   block_production_timing timing;
+   timing.witness = scheduled_witness;
+   timing.slot_time = scheduled_time;
+   timing.wakeup_lag = (now_fine - scheduled_wakeup).count();
+   timing.slot_offset = (now_fine - fc::time_point( scheduled_time )).count();
+
+   fc::time_point start = fc::time_point::now();
+   chain::signed_block block;
+   if( pre_assembled_block.valid() && pre_assembled_block->timestamp == scheduled_time
+         && pre_assembled_block->witness == scheduled_witness && pre_assembled_block->previous == db.head_block_id() )
+   {
+      block = std::move( *pre_assembled_block );
+      timing.pre_assembled = true;
+      timing.assemble = _pre_assembly_time.count();
+   }
+   else
+   {
+      // pushed right below, which rebuilds the pending state anyway
+      block = db.assemble_block( scheduled_time, scheduled_witness, private_key_itr->second, _production_skip_flags, false );
+      timing.assemble = (fc::time_point::now() - start).count();
+   }
 
-   capture("n", block.block_num())("t", block.timestamp)("c", now);
-   fc::async( [this,block](){ p2p_node().broadcast(net::block_message(block)); } );
+   start = fc::time_point::now();
+   if( !(_production_skip_flags & graphene::chain::database::skip_witness_signature) )
+      block.sign( private_key_itr->second );
+   const fc::time_point signed_time = fc::time_point::now();
+   timing.sign = (signed_time - start).count();
+
+   db.push_assembled_block( block, _production_skip_flags );
+   const fc::time_point pushed_time = fc::time_point::now();
+   timing.push = (pushed_time - signed_time).count();
+   timing.block_num = block.block_num();
+   timing.transaction_count = block.transactions.size();
+
+   _production_timings.push_back( timing );
+   if( _production_timings.size() > max_production_timings )
+      _production_timings.pop_front();
+
+   capture("n", block.block_num())("t", block.timestamp)("c", now)
+          ("assemble", timing.assemble)("pre_assembled", timing.pre_assembled)("sign", timing.sign)
+          ("push", timing.push)("slot_offset", timing.slot_offset);
+   fc::async( [this,block,pushed_time](){
+      p2p_node().broadcast(net::block_message(block));
+      record_broadcast( block.block_num(), fc::time_point::now() - pushed_time );
+   } );
 
    return block_production_condition::produced;
 }
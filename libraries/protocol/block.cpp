@@ -71,6 +71,14 @@ namespace graphene { namespace protocol {
       for( uint32_t i = 0; i < transactions.size(); ++i )
          ids[i] = transactions[i].merkle_digest();
 
+      return calculate_merkle_root( std::move(ids) );
+   }
+
+   checksum_type signed_block::calculate_merkle_root( vector<digest_type> ids )
+   {
+      if( ids.size() == 0 )
+         return checksum_type();
+
       vector<digest_type>::size_type current_number_of_hashes = ids.size();
       while( current_number_of_hashes > 1 )
       {
@@ -193,6 +193,10 @@ namespace graphene { namespace protocol {
          FC_ASSERT( *extensions.value.betting_rake_fee_percentage <= TOURNAMENT_MAXIMAL_RAKE_FEE_PERCENTAGE,
                     "Rake fee percentage must not be greater than ${max}", ("max", TOURNAMENT_MAXIMAL_RAKE_FEE_PERCENTAGE));
       }
+
+      if( extensions.value.betting_positions_settled_per_block.valid() )
+         FC_ASSERT( *extensions.value.betting_positions_settled_per_block > 0,
+                    "At least one betting market position must be settled per block" );
    }
 
 } } // graphene::protocol
@@ -54,6 +54,8 @@ namespace graphene { namespace protocol {
    struct signed_block : public signed_block_header
    {
       checksum_type calculate_merkle_root()const;
+      /// Computes the merkle root over already computed transaction merkle digests, in block order
+      static checksum_type calculate_merkle_root( vector<digest_type> leaf_digests );
       vector<processed_transaction> transactions;
    };
 
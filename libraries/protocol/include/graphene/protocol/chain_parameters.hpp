@@ -67,6 +67,7 @@ namespace graphene { namespace protocol {
       optional < uint16_t >           maximum_son_count                 = GRAPHENE_DEFAULT_MAX_SONS; ///< maximum number of active SONS
       optional < asset_id_type >      hbd_asset                         = asset_id_type();
       optional < asset_id_type >      hive_asset                        = asset_id_type();
+      optional < uint32_t >           betting_positions_settled_per_block;
    };
 
    struct chain_parameters
@@ -217,6 +218,9 @@ namespace graphene { namespace protocol {
       inline asset_id_type hive_asset() const {
          return extensions.value.hive_asset.valid() ? *extensions.value.hive_asset : asset_id_type();
       }
+      inline uint32_t betting_positions_settled_per_block()const {
+         return extensions.value.betting_positions_settled_per_block.valid() ? *extensions.value.betting_positions_settled_per_block : GRAPHENE_DEFAULT_BETTING_POSITIONS_SETTLED_PER_BLOCK;
+      }
       private:
       static void safe_copy(chain_parameters& to, const chain_parameters& from);
    };
@@ -254,6 +258,7 @@ FC_REFLECT( graphene::protocol::parameter_extension,
    (maximum_son_count)
    (hbd_asset)
    (hive_asset)
+   (betting_positions_settled_per_block)
 )
 
 FC_REFLECT( graphene::protocol::chain_parameters,
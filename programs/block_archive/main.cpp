@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <graphene/chain/block_archive.hpp>
+
+#include <fc/exception/exception.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+
+int main( int argc, char** argv )
+{
+   using namespace graphene::chain::block_archive;
+   namespace bpo = boost::program_options;
+   try
+   {
+      bpo::options_description cli_options("Export blocks to, import blocks from and verify block archives");
+      cli_options.add_options()
+            ("help,h", "Print this help message and exit.")
+            ("command", bpo::value<std::string>(), "export, import or verify")
+            ("data-dir,d", bpo::value<boost::filesystem::path>()->default_value("witness_node_data_dir"),
+             "Node data directory to export blocks from or import blocks into; the node must not be running")
+            ("archive,a", bpo::value<boost::filesystem::path>(), "Block archive file")
+            ("first-block", bpo::value<uint32_t>()->default_value(1), "First block to export")
+            ("last-block", bpo::value<uint32_t>()->default_value(0), "Last block to export, 0 for the last stored block")
+            ("blocks-per-chunk", bpo::value<uint32_t>()->default_value(1000), "Number of blocks per compressed chunk")
+            ("threads", bpo::value<uint32_t>()->default_value( std::max( 1u, std::thread::hardware_concurrency() ) ),
+             "Number of chunks compressed or verified in parallel")
+            ("trust-archive", "Required to import. Verification only checks that the archive is intact, not the "
+             "witness signatures, and the node does not check them when replaying the imported blocks either: "
+             "only import archives from a source you trust")
+            ;
+      bpo::positional_options_description positional;
+      positional.add( "command", 1 );
+
+      bpo::variables_map options;
+      try
+      {
+         bpo::store( bpo::command_line_parser( argc, argv ).options( cli_options ).positional( positional ).run(), options );
+      }
+      catch (const bpo::error& e)
+      {
+         std::cerr << "block_archive:  error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count("help") || !options.count("command") )
+      {
+         std::cout << "Usage: block_archive export|import|verify --archive FILE [options]\n"
+                   << "verify checks that an archive is intact and its blocks link up; it does not check witness\n"
+                   << "signatures, so it can't tell a forged chain from the real one.\n" << cli_options << "\n";
+         return 1;
+      }
+
+      if( !options.count("archive") )
+      {
+         std::cerr << "--archive option is required\n";
+         return 1;
+      }
+
+      const std::string command = options["command"].as<std::string>();
+      const fc::path archive_path = options["archive"].as<boost::filesystem::path>();
+      const fc::path blocks_dir = fc::path( options["data-dir"].as<boost::filesystem::path>() )
+                                  / "blockchain" / "database" / "block_num_to_block";
+      const uint32_t threads = std::max( 1u, options["threads"].as<uint32_t>() );
+
+      if( command == "export" )
+      {
+         const uint32_t blocks_per_chunk = options["blocks-per-chunk"].as<uint32_t>();
+         if( blocks_per_chunk == 0 )
+         {
+            std::cerr << "--blocks-per-chunk must be positive\n";
+            return 1;
+         }
+         export_blocks( blocks_dir, archive_path, options["first-block"].as<uint32_t>(),
+                        options["last-block"].as<uint32_t>(), blocks_per_chunk, threads );
+      }
+      else if( command == "import" )
+      {
+         if( !options.count("trust-archive") )
+         {
+            std::cerr << "block_archive:  archives are not authenticated, their witness signatures are not checked.\n"
+                      << "Importing an archive from an untrusted source can replace the chain with any other.\n"
+                      << "Pass --trust-archive to import from a source you trust.\n";
+            return 1;
+         }
+         std::cerr << "block_archive:  warning: importing blocks without checking witness signatures\n";
+         const uint32_t head_num = import_blocks( blocks_dir, archive_path, threads );
+         std::cerr << "block_archive:  block database now ends at block " << head_num << "\n";
+      }
+      else if( command == "verify" )
+      {
+         const uint32_t last_block = verify_archive( archive_path, threads );
+         std::cerr << "block_archive:  archive is intact up to block " << last_block
+                   << "; witness signatures were not checked\n";
+      }
+      else
+      {
+         std::cerr << "block_archive:  unknown command " << command << "\n";
+         return 1;
+      }
+   }
+   catch ( const fc::exception& e )
+   {
+      std::cout << e.to_detail_string() << "\n";
+      return 1;
+   }
+   return 0;
+}
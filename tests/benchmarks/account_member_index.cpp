@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/account_object.hpp>
+
+#include <fc/crypto/digest.hpp>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include <fstream>
+#include <unistd.h>
+
+using namespace graphene::chain;
+
+namespace {
+
+/// resident set size in kilobytes, 0 where /proc is not available
+uint64_t resident_kb()
+{
+   std::ifstream statm( "/proc/self/statm" );
+   uint64_t size = 0, resident = 0;
+   if( !( statm >> size >> resident ) )
+      return 0;
+   return resident * ( sysconf( _SC_PAGESIZE ) / 1024 );
+}
+
+public_key_type make_key( uint64_t seed )
+{
+   // a valid curve point is not needed for indexing, only distinct key bytes
+   public_key_type key;
+   const fc::sha256 h = fc::sha256::hash( (const char*)&seed, sizeof(seed) );
+   key.key_data.data()[0] = 2 + ( seed & 1 );
+   memcpy( key.key_data.data() + 1, h.data(), 32 );
+   return key;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE( account_member_index_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint64_t account_count = 1000000;
+#else
+      const uint64_t account_count = 50000;
+#endif
+
+      // driven directly through its secondary_index hooks, without a database
+      account_member_index index;
+      std::vector<account_object> accounts( account_count );
+      for( uint64_t i = 0; i < account_count; ++i )
+      {
+         account_object& a = accounts[i];
+         a.id = account_id_type( i );
+         a.owner = authority( 1, make_key( 3 * i ), 1 );
+         a.active = authority( 1, make_key( 3 * i + 1 ), 1 );
+         if( i > 0 )
+            a.active.account_auths[account_id_type( i / 2 )] = 1;
+         a.options.memo_key = make_key( 3 * i + 2 );
+      }
+
+      const uint64_t rss_before = resident_kb();
+      fc::time_point start_time = fc::time_point::now();
+      for( const auto& a : accounts )
+         index.object_loaded( a );
+      ilog( "Indexed ${c} accounts in ${t} milliseconds, resident memory grew by ${m} KB.",
+            ("c", account_count)("t", (fc::time_point::now() - start_time).count() / 1000)
+            ("m", resident_kb() - rss_before) );
+      BOOST_CHECK_EQUAL( index.account_to_key_memberships.size(), 3 * account_count );
+
+      // modifications that leave the authorities alone, e.g. vote or cashback updates
+      start_time = fc::time_point::now();
+      for( const auto& a : accounts )
+      {
+         index.about_to_modify( a );
+         index.object_modified( a );
+      }
+      ilog( "Applied ${c} modifications without authority changes in ${t} milliseconds.",
+            ("c", account_count)("t", (fc::time_point::now() - start_time).count() / 1000) );
+
+      // account_update replacing the active key
+      start_time = fc::time_point::now();
+      for( auto& a : accounts )
+      {
+         index.about_to_modify( a );
+         a.active.key_auths.clear();
+         a.active.key_auths[make_key( 3 * account_count + a.id.instance() )] = 1;
+         index.object_modified( a );
+      }
+      ilog( "Applied ${c} active key replacements in ${t} milliseconds.",
+            ("c", account_count)("t", (fc::time_point::now() - start_time).count() / 1000) );
+      BOOST_CHECK_EQUAL( index.account_to_key_memberships.size(), 3 * account_count );
+
+      start_time = fc::time_point::now();
+      uint64_t found = 0;
+      for( uint64_t i = 0; i < account_count; ++i )
+      {
+         auto itr = index.account_to_key_memberships.find( make_key( 3 * account_count + i ) );
+         if( itr != index.account_to_key_memberships.end() && *itr->second.begin() == account_id_type( i ) )
+            ++found;
+      }
+      ilog( "Looked up ${c} key references in ${t} milliseconds.",
+            ("c", account_count)("t", (fc::time_point::now() - start_time).count() / 1000) );
+      BOOST_CHECK_EQUAL( found, account_count );
+      BOOST_CHECK( index.account_to_key_memberships.find( make_key( 1 ) ) == index.account_to_key_memberships.end() );
+      BOOST_CHECK_EQUAL( index.account_to_account_memberships.at( account_id_type( 1 ) ).size(), 2 );
+
+      start_time = fc::time_point::now();
+      for( const auto& a : accounts )
+         index.object_removed( a );
+      ilog( "Removed ${c} accounts in ${t} milliseconds.",
+            ("c", account_count)("t", (fc::time_point::now() - start_time).count() / 1000) );
+      BOOST_CHECK( index.account_to_key_memberships.empty() );
+      BOOST_CHECK( index.account_to_address_memberships.empty() );
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "../common/betting_test_markets.hpp"
+
+#include <boost/test/auto_unit_test.hpp>
+
+using namespace graphene::chain;
+using namespace graphene::chain::keywords;
+
+BOOST_FIXTURE_TEST_CASE( in_play_betting_bench, database_fixture )
+{
+   try {
+#ifdef NDEBUG
+      ilog("Running in release mode.");
+      const int bets_per_block = 5000;
+      const int blocks_to_produce = 50;
+#else
+      ilog("Running in debug mode.");
+      const int bets_per_block = 500;
+      const int blocks_to_produce = 10;
+#endif
+
+      ACTORS( (alice)(bob)(carol)(dave) );
+      CREATE_ICE_HOCKEY_BETTING_MARKET(false, 0);
+      const account_id_type bettors[] = { alice_id, bob_id, carol_id, dave_id };
+      for( const account_id_type& bettor : bettors )
+         transfer( account_id_type(), bettor, asset(1000000000) );
+
+      // in play, every bet waits out the live betting delay and is matched when a block places it
+      update_betting_market_group( moneyline_betting_markets_id, _status = betting_market_group_status::in_play );
+      generate_blocks(1);
+
+      const auto& order_books = db.get_index_type< primary_index< bet_object_index > >().get_secondary_index< bet_order_book_index >();
+      const auto& bet_idx = db.get_index_type< bet_object_index >().indices();
+
+      // backs and lays at odds from 1.84 to 2.14 in steps of 0.02, so most bets match and some rest on the book
+      uint64_t seed = 0;
+      auto next_random = [&seed]() { seed = seed * 6364136223846793005ULL + 1442695040888963407ULL; return seed >> 33; };
+
+      fc::microseconds placing_time;
+      fc::microseconds matching_time;
+      uint32_t bets_placed = 0;
+      for( int block = 0; block < blocks_to_produce; ++block )
+      {
+         fc::time_point start_time = fc::time_point::now();
+         for( int i = 0; i < bets_per_block; ++i )
+         {
+            const uint64_t r = next_random();
+            const bet_type back_or_lay = r & 1 ? bet_type::back : bet_type::lay;
+            const bet_multiplier_type multiplier = 2 * GRAPHENE_BETTING_ODDS_PRECISION + ( int64_t(r >> 1 & 15) - 8 ) * 200;
+            // identical bets are common, vary the expiration so they aren't rejected as duplicate transactions
+            trx.expiration = db.head_block_time() + fc::seconds( 60 + i );
+            place_bet( bettors[r >> 5 & 3], capitals_win_market_id, back_or_lay, asset( 100 * (1 + (r >> 7 & 7)) ), multiplier );
+            ++bets_placed;
+         }
+         placing_time += fc::time_point::now() - start_time;
+
+         // the block that places the delayed bets does all the matching
+         start_time = fc::time_point::now();
+         generate_blocks( db.head_block_time() + fc::seconds( db.get_global_properties().parameters.live_betting_delay_time() +
+                                                              db.get_global_properties().parameters.block_interval ) );
+         matching_time += fc::time_point::now() - start_time;
+      }
+
+      const bet_order_book_index::market_order_book* book = order_books.get_order_book( capitals_win_market_id );
+      size_t resting_bets = 0;
+      size_t price_levels = 0;
+      if( book )
+      {
+         BOOST_CHECK( book->delayed_bets.empty() );
+         price_levels = book->back_bets.size() + book->lay_bets.size();
+         for( const auto& level : book->back_bets )
+            resting_bets += level.second.bets.size();
+         for( const auto& level : book->lay_bets )
+            resting_bets += level.second.bets.size();
+         // what's left can't cross: the best back is priced above the best lay
+         if( !book->back_bets.empty() && !book->lay_bets.empty() )
+            BOOST_CHECK( book->back_bets.begin()->first > book->lay_bets.begin()->first );
+      }
+      BOOST_CHECK_EQUAL( resting_bets, bet_idx.size() );
+
+      ilog( "Placed ${n} in-play bets in ${t} milliseconds.",
+            ("n", bets_placed)("t", placing_time.count() / 1000) );
+      ilog( "Matched them over ${b} blocks in ${t} milliseconds, ${r} bets at ${l} price levels left on the book.",
+            ("b", blocks_to_produce)("t", matching_time.count() / 1000)("r", resting_bets)("l", price_levels) );
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2018 Peerplays Blockchain Standards Association, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/hardfork.hpp>
+#include <graphene/chain/market_object.hpp>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+
+BOOST_FIXTURE_TEST_CASE( dex_order_placement_bench, database_fixture )
+{
+   try {
+#ifdef NDEBUG
+      ilog("Running in release mode.");
+      const int orders_per_block = 2000;
+      const int blocks_to_produce = 20;
+#else
+      ilog("Running in debug mode.");
+      const int orders_per_block = 200;
+      const int blocks_to_produce = 5;
+#endif
+
+      ACTORS( (maker)(borrower)(feedproducer) );
+      const asset_id_type usd_id = create_bitasset( "USDBIT", feedproducer_id ).id;
+      transfer( committee_account, maker_id, asset(1000000000) );
+      transfer( committee_account, borrower_id, asset(1000000000) );
+      update_feed_producers( usd_id, {feedproducer_id} );
+
+      price_feed feed;
+      feed.settlement_price = asset( 100, usd_id ) / asset( 100 );
+      publish_feed( usd_id, feedproducer_id, feed );
+
+      // well collateralized margin positions, so every order in the market is looked at by the call checks
+      borrow( borrower_id, asset( 100000000, usd_id ), asset( 300000000 ) );
+      transfer( borrower_id, maker_id, asset( 100000000, usd_id ) );
+
+      const auto& limit_idx = db.get_index_type< limit_order_index >().indices().get< by_id >();
+
+      uint64_t seed = 0;
+      auto next_random = [&seed]() { seed = seed * 6364136223846793005ULL + 1442695040888963407ULL; return seed >> 33; };
+
+      // a market maker quoting both sides of a 0.80 to 1.20 core per usd market, and cancelling half its quotes
+      auto make_market = [&]( const char* phase ) {
+         fc::microseconds placing_time;
+         fc::microseconds block_time;
+         uint32_t orders_placed = 0;
+         uint32_t orders_cancelled = 0;
+         for( int block = 0; block < blocks_to_produce; ++block )
+         {
+            vector< limit_order_id_type > placed;
+            fc::time_point start_time = fc::time_point::now();
+            for( int i = 0; i < orders_per_block; ++i )
+            {
+               const uint64_t r = next_random();
+               limit_order_create_operation op;
+               op.seller = maker_id;
+               if( r & 1 )
+               {
+                  op.amount_to_sell = asset( 1000, usd_id );
+                  op.min_to_receive = asset( 1010 + (r >> 1) % 190 );
+               }
+               else
+               {
+                  op.amount_to_sell = asset( 1000 );
+                  op.min_to_receive = asset( 1010 + (r >> 1) % 240, usd_id );
+               }
+               trx.operations.push_back( op );
+               // identical quotes are common, vary the expiration so they aren't rejected as duplicate transactions
+               trx.expiration = db.head_block_time() + fc::seconds( 60 + i );
+               auto processed = db.push_transaction( trx, ~0 );
+               trx.operations.clear();
+               placed.push_back( limit_order_id_type( processed.operation_results[0].get<object_id_type>() ) );
+               ++orders_placed;
+
+               if( r >> 9 & 1 )
+               {
+                  const limit_order_object* order = db.find( placed[ (r >> 10) % placed.size() ] );
+                  if( order == nullptr )
+                     continue;
+                  limit_order_cancel_operation cancel;
+                  cancel.fee_paying_account = maker_id;
+                  cancel.order = order->id;
+                  trx.operations.push_back( cancel );
+                  db.push_transaction( trx, ~0 );
+                  trx.operations.clear();
+                  ++orders_cancelled;
+               }
+            }
+            placing_time += fc::time_point::now() - start_time;
+
+            start_time = fc::time_point::now();
+            generate_block();
+            block_time += fc::time_point::now() - start_time;
+         }
+         ilog( "${p}: placed ${n} orders and cancelled ${c} in ${t} milliseconds, producing ${b} blocks took ${bt} milliseconds, ${o} orders on the book.",
+               ("p", phase)("n", orders_placed)("c", orders_cancelled)("t", placing_time.count() / 1000)
+               ("b", blocks_to_produce)("bt", block_time.count() / 1000)("o", limit_idx.size()) );
+      };
+
+      make_market( "Checking calls on every order" );
+
+      generate_blocks( HARDFORK_DEX_CALL_CHECK_TIME );
+      generate_block();
+      test::set_expiration( db, trx );
+      // the feed has expired while skipping ahead
+      publish_feed( usd_id, feedproducer_id, feed );
+
+      make_market( "Checking calls on orders at the front of the book" );
+
+      BOOST_CHECK( !db.get( usd_id ).bitasset_data( db ).has_settlement() );
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
@@ -26,6 +26,7 @@
 #include <graphene/utilities/tempdir.hpp>
 
 #include <fc/crypto/digest.hpp>
+#include <fc/io/json.hpp>
 
 #include <boost/test/auto_unit_test.hpp>
 
@@ -59,27 +60,42 @@ BOOST_AUTO_TEST_CASE( genesis_and_persistence_bench )
       const int blocks_to_produce = 1000;
 #endif
 
+      fc::time_point start_time = fc::time_point::now();
       for( int i = 0; i < account_count; ++i )
          genesis_state.initial_accounts.emplace_back("target"+fc::to_string(i),
                                                      public_key_type(fc::ecc::private_key::regenerate(fc::digest(i)).get_public_key()));
+      ilog("Derived ${c} genesis account keys in ${t} milliseconds.",
+           ("c", account_count)("t", (fc::time_point::now() - start_time).count() / 1000));
+
+      // Round-trip through JSON the way witness_node loads --genesis-json
+      start_time = fc::time_point::now();
+      const std::string genesis_json = fc::json::to_string(genesis_state);
+      ilog("Serialized genesis (${s} bytes) in ${t} milliseconds.",
+           ("s", genesis_json.size())("t", (fc::time_point::now() - start_time).count() / 1000));
+      start_time = fc::time_point::now();
+      genesis_state = fc::json::from_string(genesis_json).as<genesis_state_type>(20);
+      ilog("Parsed genesis in ${t} milliseconds.", ("t", (fc::time_point::now() - start_time).count() / 1000));
 
       fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
 
       {
          database db;
+         // init_genesis logs the time spent in each of its phases
+         start_time = fc::time_point::now();
          db.open(data_dir.path(), [&]{return genesis_state;}, "test");
+         ilog("Initialized database from genesis in ${t} milliseconds.", ("t", (fc::time_point::now() - start_time).count() / 1000));
 
          for( int i = 11; i < account_count + 11; ++i)
             BOOST_CHECK(db.get_balance(account_id_type(i), asset_id_type()).amount == GRAPHENE_MAX_SHARE_SUPPLY / account_count);
 
-         fc::time_point start_time = fc::time_point::now();
+         start_time = fc::time_point::now();
          db.close();
          ilog("Closed database in ${t} milliseconds.", ("t", (fc::time_point::now() - start_time).count() / 1000));
       }
       {
          database db;
 
-         fc::time_point start_time = fc::time_point::now();
+         start_time = fc::time_point::now();
          db.open(data_dir.path(), [&]{return genesis_state;}, "test");
          ilog("Opened database in ${t} milliseconds.", ("t", (fc::time_point::now() - start_time).count() / 1000));
 
@@ -113,7 +129,7 @@ BOOST_AUTO_TEST_CASE( genesis_and_persistence_bench )
       {
          database db;
 
-         auto start_time = fc::time_point::now();
+         start_time = fc::time_point::now();
          wlog( "about to start reindex..." );
          db.open(data_dir.path(), [&]{return genesis_state;}, "force_wipe");
          ilog("Replayed database in ${t} milliseconds.", ("t", (fc::time_point::now() - start_time).count() / 1000));
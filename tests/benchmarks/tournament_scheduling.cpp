@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/tournament_object.hpp>
+
+#include "../common/tournament_helper.hpp"
+
+#include <boost/test/auto_unit_test.hpp>
+
+using namespace graphene::chain;
+
+BOOST_FIXTURE_TEST_CASE( tournament_scheduling_bench, database_fixture )
+{
+   try {
+#ifdef NDEBUG
+      ilog("Running in release mode.");
+      const int tournament_count = 5000;
+      const int blocks_to_produce = 200;
+#else
+      ilog("Running in debug mode.");
+      const int tournament_count = 500;
+      const int blocks_to_produce = 50;
+#endif
+      const int transactions_per_block = 200;
+
+      ACTORS((nathan)(alice)(bob));
+      tournaments_helper tournament_helper(*this);
+
+      transfer(committee_account, nathan_id, asset(1000000000));
+      transfer(committee_account, alice_id, asset(1000000000));
+      transfer(committee_account, bob_id, asset(1000000000));
+      upgrade_to_lifetime_member(nathan);
+      generate_block();
+
+      // create a large number of concurrent two-player rock-paper-scissors tournaments.  Nobody
+      // ever moves, so every tournament stays in progress, with games only advancing on timeouts
+      asset buy_in = asset(10);
+      fc::time_point start_time = fc::time_point::now();
+      for( int i = 0; i < tournament_count; ++i )
+      {
+         tournament_id_type tournament_id = tournament_helper.create_tournament( nathan_id, nathan_private_key, buy_in, 2,
+                                                                                 30, 30, 3, 3600, 3 );
+         tournament_helper.join_tournament( tournament_id, alice_id, alice_id, alice_private_key, buy_in );
+         tournament_helper.join_tournament( tournament_id, bob_id, bob_id, bob_private_key, buy_in );
+         if( (i + 1) % (transactions_per_block / 3) == 0 )
+            generate_block();
+      }
+      generate_block();
+      ilog("Created and filled ${c} tournaments in ${t} milliseconds.",
+           ("c", tournament_count)("t", (fc::time_point::now() - start_time).count() / 1000));
+
+      // let the start delay pass so all tournaments are in progress
+      generate_blocks( db.head_block_time() + fc::seconds(6) );
+
+      const auto& tournaments_by_start_time = db.get_index_type<tournament_index>().indices().get<by_start_time>();
+      size_t in_progress = std::distance( tournaments_by_start_time.lower_bound( boost::make_tuple( tournament_state::in_progress ) ),
+                                          tournaments_by_start_time.upper_bound( boost::make_tuple( tournament_state::in_progress ) ) );
+      BOOST_CHECK_EQUAL( in_progress, (size_t)tournament_count );
+
+      start_time = fc::time_point::now();
+      for( int i = 0; i < blocks_to_produce; ++i )
+         generate_block();
+      fc::microseconds elapsed = fc::time_point::now() - start_time;
+      ilog("Produced ${b} blocks with ${c} tournaments in progress in ${t} milliseconds (${p} microseconds per block).",
+           ("b", blocks_to_produce)("c", in_progress)("t", elapsed.count() / 1000)("p", elapsed.count() / blocks_to_produce));
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
@@ -1253,6 +1253,280 @@ BOOST_AUTO_TEST_CASE( cancel_one_event_in_group )
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( incremental_settlement_test )
+{
+   // after the hardfork, a betting market group is paid out over as many blocks as it takes to
+   // stay within the per-block settlement budget
+   try
+   {
+      generate_blocks(HARDFORK_BMG_SETTLEMENT_TIME);
+      generate_blocks(1);
+
+      ACTORS( (alice)(bob)(carol)(dan) );
+      CREATE_ICE_HOCKEY_BETTING_MARKET(false, 0);
+
+      db.modify(db.get_global_properties(), [](global_property_object& p) {
+         p.parameters.extensions.value.betting_positions_settled_per_block = 2;
+      });
+
+      for (const account_id_type& bettor_id : {alice_id, bob_id, carol_id, dan_id})
+         transfer(account_id_type(), bettor_id, asset(10000));
+
+      // alice and carol back the capitals at 1:1, bob and dan lay them
+      place_bet(alice_id, capitals_win_market_id, bet_type::back, asset(1000, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_bet(bob_id, capitals_win_market_id, bet_type::lay, asset(1000, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_bet(carol_id, capitals_win_market_id, bet_type::back, asset(1000, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_bet(dan_id, capitals_win_market_id, bet_type::lay, asset(1000, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+
+      update_betting_market_group(moneyline_betting_markets_id, _status = betting_market_group_status::closed);
+      generate_blocks(1);
+
+      resolve_betting_market_group(moneyline_betting_markets_id,
+                                  {{capitals_win_market_id, betting_market_resolution_type::win},
+                                   {blackhawks_win_market_id, betting_market_resolution_type::not_win}});
+
+      uint16_t rake_fee_percentage = db.get_global_properties().parameters.betting_rake_fee_percentage();
+      uint32_t rake_value = 1000 * rake_fee_percentage / GRAPHENE_1_PERCENT / 100;
+
+      // the first block only has room for alice and bob
+      generate_blocks(1);
+      BOOST_REQUIRE(db.find(moneyline_betting_markets_id));
+      BOOST_CHECK(moneyline_betting_markets_id(db).get_status() == betting_market_group_status::settled);
+      BOOST_CHECK_EQUAL(db.get_betting_market_settlement_statistics().positions_settled, 2u);
+      BOOST_CHECK_EQUAL(db.get_betting_market_settlement_statistics().groups_pending, 1u);
+      BOOST_CHECK_EQUAL(get_balance(alice_id, asset_id_type()), 10000 - 1000 + 2000 - rake_value);
+      BOOST_CHECK_EQUAL(get_balance(bob_id, asset_id_type()), 10000 - 1000);
+      BOOST_CHECK_EQUAL(get_balance(carol_id, asset_id_type()), 10000 - 1000);
+
+      // nothing can be added to a group while it is being settled
+      BOOST_CHECK_THROW(place_bet(carol_id, capitals_win_market_id, bet_type::back, asset(100, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION), fc::exception);
+
+      // the second block pays carol and dan, then removes the group
+      generate_blocks(1);
+      BOOST_CHECK(!db.find(moneyline_betting_markets_id));
+      BOOST_CHECK(!db.find(capitals_win_market_id));
+      BOOST_CHECK_EQUAL(db.get_betting_market_settlement_statistics().positions_settled, 2u);
+      BOOST_CHECK_EQUAL(db.get_betting_market_settlement_statistics().groups_settled, 1u);
+      BOOST_CHECK_EQUAL(db.get_betting_market_settlement_statistics().groups_pending, 0u);
+      BOOST_CHECK_EQUAL(get_balance(carol_id, asset_id_type()), 10000 - 1000 + 2000 - rake_value);
+      BOOST_CHECK_EQUAL(get_balance(dan_id, asset_id_type()), 10000 - 1000);
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE(bet_order_book_test)
+{
+   try
+   {
+      ACTORS( (alice)(bob) );
+      CREATE_ICE_HOCKEY_BETTING_MARKET(false, 0);
+      transfer(account_id_type(), alice_id, asset(10000000));
+      transfer(account_id_type(), bob_id, asset(10000000));
+      generate_blocks(1);
+
+      const auto& bet_odds_idx = db.get_index_type<bet_object_index>().indices().get<by_odds>();
+      const auto& order_books = db.get_index_type<primary_index<bet_object_index>>().get_secondary_index<bet_order_book_index>();
+
+      // the book must list the same bets in the same order as by_odds, with matching totals
+      auto check_order_book = [&]() {
+         vector<bet_id_type> expected_bets;
+         share_type expected_total;
+         for (auto itr = bet_odds_idx.lower_bound(std::make_tuple(capitals_win_market_id));
+              itr != bet_odds_idx.upper_bound(std::make_tuple(capitals_win_market_id)); ++itr)
+         {
+            expected_bets.push_back(itr->id);
+            expected_total += itr->amount_to_bet.amount;
+         }
+         vector<bet_id_type> book_bets;
+         share_type book_total;
+         const bet_order_book_index::market_order_book* book = order_books.get_order_book(capitals_win_market_id);
+         if (book)
+         {
+            for (const auto& level : book->back_bets)
+            {
+               book_bets.insert(book_bets.end(), level.second.bets.begin(), level.second.bets.end());
+               book_total += level.second.total_amount_to_bet;
+            }
+            for (const auto& level : book->lay_bets)
+            {
+               book_bets.insert(book_bets.end(), level.second.bets.begin(), level.second.bets.end());
+               book_total += level.second.total_amount_to_bet;
+            }
+         }
+         BOOST_CHECK(book_bets == expected_bets);
+         BOOST_CHECK_EQUAL(book_total.value, expected_total.value);
+      };
+
+      place_bet(alice_id, capitals_win_market_id, bet_type::back, asset(1000, asset_id_type()), 3 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_bet(alice_id, capitals_win_market_id, bet_type::back, asset(1000, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_bet(bob_id, capitals_win_market_id, bet_type::back, asset(500, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_bet(bob_id, capitals_win_market_id, bet_type::lay, asset(100, asset_id_type()), 15 * GRAPHENE_BETTING_ODDS_PRECISION / 10);
+      check_order_book();
+      BOOST_REQUIRE(order_books.get_order_book(capitals_win_market_id));
+      BOOST_CHECK_EQUAL(order_books.get_order_book(capitals_win_market_id)->back_bets.at(2 * GRAPHENE_BETTING_ODDS_PRECISION).total_amount_to_bet.value, 1500);
+      generate_blocks(1);
+
+      // a lay at 2.5 takes the backs at 2 oldest first, leaving part of alice's bet
+      place_bet(bob_id, capitals_win_market_id, bet_type::lay, asset(1000, asset_id_type()), 25 * GRAPHENE_BETTING_ODDS_PRECISION / 10);
+      check_order_book();
+      BOOST_CHECK(!order_books.get_best_matching_bet(capitals_win_market_id, bet_type::back, 19 * GRAPHENE_BETTING_ODDS_PRECISION / 10));
+      BOOST_CHECK(order_books.get_best_matching_bet(capitals_win_market_id, bet_type::back, 2 * GRAPHENE_BETTING_ODDS_PRECISION));
+      generate_blocks(1);
+
+      // undoing the block brings back the bets it matched
+      db.pop_block();
+      check_order_book();
+      BOOST_CHECK_EQUAL(order_books.get_order_book(capitals_win_market_id)->back_bets.at(2 * GRAPHENE_BETTING_ODDS_PRECISION).total_amount_to_bet.value, 1500);
+
+      cancel_unmatched_bets(moneyline_betting_markets_id);
+      check_order_book();
+      BOOST_CHECK(!order_books.get_order_book(capitals_win_market_id));
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( settlement_budget_parameter_test )
+{
+   try
+   {
+      auto propose_settlement_budget = [this]() {
+         proposal_create_operation cop = proposal_create_operation::committee_proposal(db.get_global_properties().parameters, db.head_block_time());
+         cop.fee_paying_account = GRAPHENE_TEMP_ACCOUNT;
+         cop.expiration_time = db.head_block_time() + *cop.review_period_seconds + 10;
+         committee_member_update_global_parameters_operation uop;
+         uop.new_parameters = db.get_global_properties().parameters;
+         uop.new_parameters.extensions.value.betting_positions_settled_per_block = 5;
+         cop.proposed_ops.emplace_back(uop);
+         trx.operations.push_back(cop);
+         set_expiration(db, trx);
+         db.push_transaction(trx);
+         trx.clear();
+      };
+
+      BOOST_TEST_MESSAGE("the settlement budget can't be proposed before the hardfork");
+      GRAPHENE_REQUIRE_THROW(propose_settlement_budget(), fc::exception);
+      trx.clear();
+
+      generate_blocks(HARDFORK_BMG_SETTLEMENT_TIME);
+      generate_blocks(1);
+      propose_settlement_budget();
+
+      BOOST_TEST_MESSAGE("a later parameter update leaving the settlement budget unset keeps it");
+      db.modify(db.get_global_properties(), [](global_property_object& p) {
+         p.parameters.extensions.value.betting_positions_settled_per_block = 5;
+         p.pending_parameters = p.parameters;
+         p.pending_parameters->extensions.value.betting_positions_settled_per_block.reset();
+         p.pending_parameters->maximum_transaction_size += 1;
+      });
+      const uint32_t maximum_transaction_size = db.get_global_properties().pending_parameters->maximum_transaction_size;
+      generate_blocks(db.get_dynamic_global_properties().next_maintenance_time);
+      generate_blocks(1);
+
+      BOOST_CHECK_EQUAL(db.get_global_properties().parameters.maximum_transaction_size, maximum_transaction_size);
+      BOOST_CHECK_EQUAL(db.get_global_properties().parameters.betting_positions_settled_per_block(), 5u);
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( event_canceled_after_group_settling_time_test )
+{
+   // once a group's settling time passes it is settled, even when the budget leaves no room to pay
+   // anyone that block, so canceling the event afterwards can't undo its resolutions, and the event
+   // is kept until the group has been paid out
+   try
+   {
+      generate_blocks(HARDFORK_BMG_SETTLEMENT_TIME);
+      generate_blocks(1);
+
+      ACTORS( (alice)(bob) );
+      CREATE_ICE_HOCKEY_BETTING_MARKET(false, 0);
+
+      auto set_settlement_budget = [this](uint32_t positions_per_block) {
+         db.modify(db.get_global_properties(), [positions_per_block](global_property_object& p) {
+            p.parameters.extensions.value.betting_positions_settled_per_block = positions_per_block;
+         });
+      };
+      set_settlement_budget(0);
+
+      transfer(account_id_type(), alice_id, asset(10000));
+      transfer(account_id_type(), bob_id, asset(10000));
+      place_bet(alice_id, capitals_win_market_id, bet_type::back, asset(1000, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_bet(bob_id, capitals_win_market_id, bet_type::lay, asset(1000, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+
+      update_betting_market_group(moneyline_betting_markets_id, _status = betting_market_group_status::closed);
+      generate_blocks(1);
+
+      resolve_betting_market_group(moneyline_betting_markets_id,
+                                  {{capitals_win_market_id, betting_market_resolution_type::win},
+                                   {blackhawks_win_market_id, betting_market_resolution_type::not_win}});
+      generate_blocks(1);
+
+      BOOST_REQUIRE(db.find(moneyline_betting_markets_id));
+      BOOST_CHECK(moneyline_betting_markets_id(db).get_status() == betting_market_group_status::settled);
+      BOOST_CHECK_EQUAL(db.get_betting_market_settlement_statistics().positions_settled, 0u);
+      BOOST_CHECK_EQUAL(get_balance(alice_id, asset_id_type()), 10000 - 1000);
+      BOOST_CHECK_EQUAL(get_balance(bob_id, asset_id_type()), 10000 - 1000);
+
+      BOOST_TEST_MESSAGE("canceling the event leaves the settled group's resolutions alone");
+      update_event(capitals_vs_blackhawks_id, _status = event_status::canceled);
+      generate_blocks(1);
+
+      BOOST_REQUIRE(db.find(moneyline_betting_markets_id));
+      BOOST_CHECK(moneyline_betting_markets_id(db).get_status() == betting_market_group_status::settled);
+      BOOST_CHECK(capitals_win_market_id(db).get_status() == betting_market_status::settled);
+      BOOST_CHECK(db.find(capitals_vs_blackhawks_id));
+
+      BOOST_TEST_MESSAGE("the group is paid as resolved, then the group and its event are removed");
+      set_settlement_budget(10);
+      generate_blocks(1);
+
+      uint16_t rake_fee_percentage = db.get_global_properties().parameters.betting_rake_fee_percentage();
+      uint32_t rake_value = 1000 * rake_fee_percentage / GRAPHENE_1_PERCENT / 100;
+      BOOST_CHECK_EQUAL(get_balance(alice_id, asset_id_type()), 10000 - 1000 + 2000 - rake_value);
+      BOOST_CHECK_EQUAL(get_balance(bob_id, asset_id_type()), 10000 - 1000);
+      BOOST_CHECK(!db.find(moneyline_betting_markets_id));
+
+      generate_blocks(1);
+      BOOST_CHECK(!db.find(capitals_vs_blackhawks_id));
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( event_canceled_before_group_settling_time_test )
+{
+   // canceling the event while a graded group is still waiting out its settling delay cancels the
+   // group, and every bettor gets their stake back
+   try
+   {
+      generate_blocks(HARDFORK_BMG_SETTLEMENT_TIME);
+      generate_blocks(1);
+
+      ACTORS( (alice)(bob) );
+      CREATE_ICE_HOCKEY_BETTING_MARKET(false, 60);
+
+      transfer(account_id_type(), alice_id, asset(10000));
+      transfer(account_id_type(), bob_id, asset(10000));
+      place_bet(alice_id, capitals_win_market_id, bet_type::back, asset(1000, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+      place_bet(bob_id, capitals_win_market_id, bet_type::lay, asset(1000, asset_id_type()), 2 * GRAPHENE_BETTING_ODDS_PRECISION);
+
+      update_betting_market_group(moneyline_betting_markets_id, _status = betting_market_group_status::closed);
+      generate_blocks(1);
+
+      resolve_betting_market_group(moneyline_betting_markets_id,
+                                  {{capitals_win_market_id, betting_market_resolution_type::win},
+                                   {blackhawks_win_market_id, betting_market_resolution_type::not_win}});
+      generate_blocks(1);
+      BOOST_CHECK(moneyline_betting_markets_id(db).get_status() == betting_market_group_status::graded);
+
+      update_event(capitals_vs_blackhawks_id, _status = event_status::canceled);
+      BOOST_CHECK(moneyline_betting_markets_id(db).get_status() == betting_market_group_status::canceled);
+
+      generate_blocks(2);
+      BOOST_CHECK_EQUAL(get_balance(alice_id, asset_id_type()), 10000);
+      BOOST_CHECK_EQUAL(get_balance(bob_id, asset_id_type()), 10000);
+      BOOST_CHECK(!db.find(moneyline_betting_markets_id));
+
+      generate_blocks(1);
+      BOOST_CHECK(!db.find(capitals_vs_blackhawks_id));
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_FIXTURE_TEST_SUITE( simple_bet_tests, simple_bet_test_fixture )
@@ -711,6 +711,10 @@ BOOST_AUTO_TEST_CASE( merkle_root )
 
    block.transactions.push_back( tx[9] );
    BOOST_CHECK( block.calculate_merkle_root() == c(dO) );
+
+   // the root over precomputed leaf digests must match
+   BOOST_CHECK( signed_block::calculate_merkle_root( t ) == c(dO) );
+   BOOST_CHECK( signed_block::calculate_merkle_root( vector<digest_type>() ) == checksum_type() );
 }
 
 /**
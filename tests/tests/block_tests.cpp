@@ -24,6 +24,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <graphene/chain/block_archive.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/exceptions.hpp>
 
@@ -127,6 +128,128 @@ BOOST_AUTO_TEST_CASE( block_database_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( block_database_segment_storage_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const fc::path segments_dir = data_dir.path() / "segments";
+
+      block_database bdb;
+      signed_block b;
+      vector<block_id_type> ids( 1 );
+      auto store_up_to = [&]( uint32_t block_num ) {
+         while( ids.size() <= block_num )
+         {
+            b.previous = ids.back();
+            b.witness = witness_id_type( ids.size() % 7 );
+            ids.push_back( b.id() );
+            bdb.store( ids.back(), b );
+         }
+      };
+      auto check_blocks = [&]() {
+         for( uint32_t i = 1; i < ids.size(); ++i )
+         {
+            auto blk = bdb.fetch_by_number( i );
+            BOOST_REQUIRE( blk.valid() );
+            BOOST_CHECK( blk->id() == ids[i] );
+            if( i % 1000 == 0 )
+               BOOST_CHECK( bdb.fetch_optional( ids[i] ).valid() );
+         }
+         BOOST_CHECK( bdb.last_id() == ids.back() );
+      };
+
+      // legacy blocks file, then segment files for the blocks stored after segment storage is enabled
+      bdb.open( data_dir.path() );
+      store_up_to( 12000 );
+      bdb.close();
+      bdb.open( data_dir.path(), true );
+      store_up_to( 25000 );
+      check_blocks();
+      BOOST_CHECK( fc::exists( segments_dir / "00000001.blocks" ) );
+
+      // both segments below block 20000 get compressed, which absorbs all legacy blocks
+      for( uint32_t segment = 0; segment < 2; ++segment )
+      {
+         bdb.compact( 25000 );
+         bdb.close();
+         bdb.open( data_dir.path(), true );
+      }
+      bdb.compact( 25000 );
+      BOOST_CHECK( fc::exists( segments_dir / "00000000.zblocks" ) );
+      BOOST_CHECK( fc::exists( segments_dir / "00000001.zblocks" ) );
+      BOOST_CHECK( !fc::exists( segments_dir / "00000001.blocks" ) );
+      BOOST_CHECK( !fc::exists( segments_dir / "00000002.zblocks" ) );
+      BOOST_CHECK( !fc::exists( data_dir.path() / "blocks" ) );
+      check_blocks();
+
+      store_up_to( 26000 );
+      check_blocks();
+      bdb.close();
+
+      // compressed and segment storage stay readable with segment storage disabled
+      bdb.open( data_dir.path() );
+      store_up_to( 26100 );
+      check_blocks();
+      bdb.close();
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( block_archive_test )
+{
+   try {
+      fc::temp_directory source_dir( graphene::utilities::temp_directory_path() );
+      fc::temp_directory target_dir( graphene::utilities::temp_directory_path() );
+      fc::temp_directory archive_dir( graphene::utilities::temp_directory_path() );
+      const fc::path archive = archive_dir.path() / "blocks.archive";
+
+      // the target already holds the first blocks of the chain
+      block_database source;
+      source.open( source_dir.path() );
+      block_database target;
+      target.open( target_dir.path() );
+      vector<block_id_type> ids;
+      signed_block b;
+      for( uint32_t i = 0; i < 25; ++i )
+      {
+         if( i > 0 ) b.previous = b.id();
+         b.witness = witness_id_type( i % 3 + 1 );
+         b.timestamp = fc::time_point_sec( GRAPHENE_TESTING_GENESIS_TIMESTAMP + 3 * i );
+         ids.push_back( b.id() );
+         source.store( b.id(), b );
+         if( i < 10 )
+            target.store( b.id(), b );
+      }
+      source.close();
+      target.close();
+
+      block_archive::export_blocks( source_dir.path(), archive, 1, 0, 7, 2 );
+      BOOST_CHECK_EQUAL( block_archive::verify_archive( archive, 2 ), 25u );
+
+      BOOST_CHECK_EQUAL( block_archive::import_blocks( target_dir.path(), archive, 2 ), 25u );
+      target.open( target_dir.path() );
+      for( uint32_t i = 0; i < ids.size(); ++i )
+         BOOST_CHECK( target.fetch_block_id( i + 1 ) == ids[i] );
+      BOOST_CHECK( target.last_id() == ids.back() );
+      target.close();
+
+      // a damaged archive fails verification
+      {
+         std::fstream file( archive.generic_string().c_str(), std::ios::in | std::ios::out | std::ios::binary );
+         file.seekg( -1, std::ios::end );
+         char c = file.get();
+         file.seekp( -1, std::ios::end );
+         file.put( c ^ 0x5a );
+      }
+      BOOST_CHECK_THROW( block_archive::verify_archive( archive, 2 ), fc::exception );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( generate_empty_blocks )
 {
    try {
@@ -1408,4 +1531,130 @@ BOOST_FIXTURE_TEST_CASE( miss_many_blocks, database_fixture )
    }
 }
 
+BOOST_FIXTURE_TEST_CASE( precheck_transaction, database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   transfer( account_id_type(), alice_id, asset( 1000000 ) );
+   generate_block();
+
+   const auto& params = db.get_global_properties().parameters;
+   auto make_transfer = [&]( share_type amount ) {
+      transfer_operation op;
+      op.from = alice_id;
+      op.to = bob_id;
+      op.amount = asset( amount );
+      signed_transaction tx;
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      return tx;
+   };
+   auto precheck_signed = [&]( signed_transaction& tx ) {
+      tx.clear_signatures();
+      sign( tx, alice_private_key );
+      return db.precheck_transaction( tx );
+   };
+
+   BOOST_TEST_MESSAGE( "A valid transaction is accepted, and prechecking it changes nothing" );
+   signed_transaction good = make_transfer( 1000 );
+   BOOST_CHECK( precheck_signed( good ) == transaction_precheck_result::accepted );
+   BOOST_CHECK( db.precheck_transaction( good ) == transaction_precheck_result::accepted );
+   BOOST_CHECK_EQUAL( db.get_balance( bob_id, asset_id_type() ).amount.value, 0 );
+   PUSH_TX( db, good );
+   BOOST_CHECK_EQUAL( db.get_balance( bob_id, asset_id_type() ).amount.value, 1000 );
+
+   BOOST_TEST_MESSAGE( "Duplicate, both pending and in a block" );
+   BOOST_CHECK( db.precheck_transaction( good ) == transaction_precheck_result::duplicate );
+   generate_block();
+   BOOST_CHECK( db.precheck_transaction( good ) == transaction_precheck_result::duplicate );
+   GRAPHENE_REQUIRE_THROW( PUSH_TX( db, good ), fc::exception );
+
+   BOOST_TEST_MESSAGE( "Expired, and expiring too far ahead" );
+   signed_transaction tx = make_transfer( 1000 );
+   tx.expiration = db.head_block_time() - 1;
+   BOOST_CHECK( precheck_signed( tx ) == transaction_precheck_result::expired );
+   tx.expiration = db.head_block_time() + params.maximum_time_until_expiration + 1;
+   BOOST_CHECK( precheck_signed( tx ) == transaction_precheck_result::expiration_too_far );
+
+   BOOST_TEST_MESSAGE( "TaPoS referencing a block not on our chain" );
+   tx = make_transfer( 1000 );
+   tx.ref_block_prefix ^= 0x12345678;
+   BOOST_CHECK( precheck_signed( tx ) == transaction_precheck_result::tapos_mismatch );
+   GRAPHENE_REQUIRE_THROW( PUSH_TX( db, tx ), fc::exception );
+   tx.ref_block_num = 9999;
+   BOOST_CHECK( precheck_signed( tx ) == transaction_precheck_result::tapos_mismatch );
+
+   BOOST_TEST_MESSAGE( "Larger than maximum_transaction_size, which the chain accepts" );
+   tx = make_transfer( 1000 );
+   custom_operation filler;
+   filler.payer = alice_id;
+   filler.data.resize( params.maximum_transaction_size );
+   tx.operations.push_back( filler );
+   BOOST_CHECK( precheck_signed( tx ) == transaction_precheck_result::accepted );
+   PUSH_TX( db, tx );
+
+   BOOST_TEST_MESSAGE( "Too large to fit in any block" );
+   db.modify( db.get_global_properties(), []( global_property_object& p ) {
+      p.parameters.maximum_block_size = 4 * p.parameters.maximum_transaction_size;
+   });
+   tx = make_transfer( 1000 );
+   filler.data.resize( params.maximum_block_size );
+   tx.operations.push_back( filler );
+   BOOST_CHECK( precheck_signed( tx ) == transaction_precheck_result::oversized );
+
+   BOOST_TEST_MESSAGE( "Failing validation" );
+   tx = make_transfer( 0 );
+   BOOST_CHECK( precheck_signed( tx ) == transaction_precheck_result::invalid );
+
+   BOOST_TEST_MESSAGE( "Without the required signature" );
+   tx = make_transfer( 1000 );
+   BOOST_CHECK( db.precheck_transaction( tx ) == transaction_precheck_result::missing_authority );
+
+   BOOST_TEST_MESSAGE( "None of the rejections affected a valid transaction" );
+   tx = make_transfer( 2000 );
+   BOOST_CHECK( precheck_signed( tx ) == transaction_precheck_result::accepted );
+   PUSH_TX( db, tx );
+   generate_block();
+   BOOST_CHECK_EQUAL( db.get_balance( bob_id, asset_id_type() ).amount.value, 3000 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( pre_assembled_block_keeps_pending_state, database_fixture )
+{ try {
+   ACTORS( (alice)(bob)(carol) );
+   transfer( account_id_type(), alice_id, asset( 10000 ) );
+   generate_block();
+   auto balance = [&]( account_id_type id ) { return db.get_balance( id, asset_id_type() ).amount.value; };
+
+   BOOST_TEST_MESSAGE( "Fund bob in a pending transaction" );
+   transfer( alice_id, bob_id, asset( 3000 ) );
+   const int64_t alice_balance = balance( alice_id );
+   BOOST_CHECK_EQUAL( balance( bob_id ), 3000 );
+
+   BOOST_TEST_MESSAGE( "Assemble the next block ahead of its slot" );
+   const uint32_t skip = database::skip_undo_history_check;
+   signed_block block = db.assemble_block( db.get_slot_time(1), db.get_scheduled_witness(1),
+                                           init_account_priv_key, skip );
+   BOOST_REQUIRE_EQUAL( block.transactions.size(), 1u );
+   // the pending transfer is still applied
+   BOOST_CHECK_EQUAL( balance( bob_id ), 3000 );
+
+   BOOST_TEST_MESSAGE( "Push a transaction spending the pending funds before the block is produced" );
+   transfer( bob_id, carol_id, asset( 2000 ) );
+   const int64_t bob_balance = balance( bob_id );
+   BOOST_CHECK_LE( bob_balance, 1000 );
+   BOOST_CHECK_EQUAL( balance( carol_id ), 2000 );
+
+   BOOST_TEST_MESSAGE( "Produce the pre-assembled block, the later transaction stays pending" );
+   block.sign( init_account_priv_key );
+   db.push_assembled_block( block, skip );
+   BOOST_CHECK( db.head_block_id() == block.id() );
+   BOOST_CHECK_EQUAL( balance( bob_id ), bob_balance );
+   BOOST_CHECK_EQUAL( balance( carol_id ), 2000 );
+
+   const signed_block next = generate_block();
+   BOOST_REQUIRE_EQUAL( next.transactions.size(), 1u );
+   BOOST_CHECK_EQUAL( balance( alice_id ), alice_balance );
+   BOOST_CHECK_EQUAL( balance( bob_id ), bob_balance );
+   BOOST_CHECK_EQUAL( balance( carol_id ), 2000 );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
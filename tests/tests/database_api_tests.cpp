@@ -24,6 +24,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <graphene/app/api.hpp>
 #include <graphene/app/database_api.hpp>
 
 #include "../common/database_fixture.hpp"
@@ -68,4 +69,207 @@ BOOST_FIXTURE_TEST_SUITE(database_api_tests, database_fixture)
       } FC_LOG_AND_RETHROW()
   }
 
+  BOOST_AUTO_TEST_CASE(get_full_accounts_cache) {
+      try {
+          /***
+           * Arrange
+           */
+          ACTORS((nathan)(dan));
+          transfer(committee_account, nathan_id, asset(10000));
+          generate_block();
+          set_expiration(db, trx);
+
+          graphene::app::database_api db_api(db);
+          auto get_core_balance = [&db_api]() {
+             auto results = db_api.get_full_accounts({"nathan", "dan"}, false);
+             BOOST_REQUIRE_EQUAL(results.size(), 2u);
+             const auto& balances = results["nathan"].balances;
+             BOOST_REQUIRE_EQUAL(balances.size(), 1u);
+             return balances.front().balance;
+          };
+          BOOST_CHECK_EQUAL(get_core_balance().value, 10000);
+          // served from the cache
+          BOOST_CHECK_EQUAL(get_core_balance().value, 10000);
+
+
+          /***
+           * Act
+           */
+          transfer(nathan_id, dan_id, asset(1000));
+
+
+          /***
+           * Assert
+           */
+          // pending transactions are reflected straight away
+          const share_type expected = db.get_balance(nathan_id, asset_id_type()).amount;
+          BOOST_CHECK_LT(expected.value, 10000);
+          BOOST_CHECK_EQUAL(get_core_balance().value, expected.value);
+
+          generate_block();
+          BOOST_CHECK_EQUAL(get_core_balance().value, expected.value);
+          BOOST_CHECK_EQUAL(db_api.get_full_accounts({"dan"}, false)["dan"].balances.front().balance.value, 1000);
+
+      } FC_LOG_AND_RETHROW()
+  }
+
+  BOOST_AUTO_TEST_CASE(list_asset_holders) {
+      try {
+          /***
+           * Arrange
+           */
+          ACTORS((alice)(bob)(carol)(dave)(erin));
+          const asset_id_type uia_id = create_user_issued_asset("HOLDME").id;
+          issue_uia(alice_id, asset(500, uia_id));
+          issue_uia(bob_id, asset(400, uia_id));
+          issue_uia(carol_id, asset(300, uia_id));
+          issue_uia(dave_id, asset(300, uia_id));
+          issue_uia(erin_id, asset(100, uia_id));
+          generate_block();
+
+          graphene::app::asset_api asset_api(app);
+
+
+          /***
+           * Act
+           */
+          vector<graphene::app::account_asset_balance> paged;
+          optional<graphene::app::account_asset_balance> last;
+          for (;;) {
+             auto page = asset_api.list_asset_holders("HOLDME", last, 2);
+             BOOST_REQUIRE_LE(page.size(), 2u);
+             if (page.empty())
+                break;
+             paged.insert(paged.end(), page.begin(), page.end());
+             last = page.back();
+          }
+
+
+          /***
+           * Assert
+           */
+          const auto all = asset_api.get_asset_holders("HOLDME", 0, 100);
+          BOOST_REQUIRE_EQUAL(all.size(), 5u);
+          BOOST_REQUIRE_EQUAL(paged.size(), all.size());
+          for (size_t i = 0; i < all.size(); ++i) {
+             BOOST_CHECK(paged[i].account_id == all[i].account_id);
+             BOOST_CHECK_EQUAL(paged[i].amount.value, all[i].amount.value);
+          }
+          // largest first, equal amounts by account id
+          BOOST_CHECK(paged[0].account_id == alice_id);
+          BOOST_CHECK(paged[1].account_id == bob_id);
+          BOOST_CHECK(paged[2].account_id == carol_id);
+          BOOST_CHECK(paged[3].account_id == dave_id);
+          BOOST_CHECK(paged[4].account_id == erin_id);
+          BOOST_CHECK_EQUAL(paged[2].name, "carol");
+
+          // the asset may also be given by id, and paging past the end yields nothing
+          BOOST_CHECK_EQUAL(asset_api.list_asset_holders(std::string(object_id_type(uia_id)), last, 2).size(), 0u);
+          BOOST_CHECK_EQUAL(asset_api.list_asset_holders(std::string(object_id_type(uia_id)), {}, 3).size(), 3u);
+
+          // limits above the configured maximum are refused
+          const uint32_t max_limit = asset_api.api_limit_get_asset_holders;
+          BOOST_CHECK_EQUAL(asset_api.list_asset_holders("HOLDME", {}, max_limit).size(), 5u);
+          GRAPHENE_REQUIRE_THROW(asset_api.list_asset_holders("HOLDME", {}, max_limit + 1), fc::exception);
+          GRAPHENE_REQUIRE_THROW(asset_api.get_asset_holders("HOLDME", 0, max_limit + 1), fc::exception);
+
+      } FC_LOG_AND_RETHROW()
+  }
+
+  BOOST_AUTO_TEST_CASE(asset_holders_count) {
+      try {
+          /***
+           * Arrange
+           */
+          ACTORS((alice)(bob)(carol));
+          const asset_id_type uia_id = create_user_issued_asset("HOLDME").id;
+          issue_uia(alice_id, asset(500, uia_id));
+          generate_block();
+
+          graphene::app::asset_api asset_api(app);
+          auto count_in_all = [&]() {
+             for (const auto& holders : asset_api.get_all_asset_holders())
+                if (holders.asset_id == uia_id)
+                   return holders.count;
+             BOOST_FAIL("asset missing from get_all_asset_holders");
+             return -1;
+          };
+          const int initial = asset_api.get_asset_holders_count("HOLDME");
+          BOOST_CHECK_EQUAL(count_in_all(), initial);
+
+
+          /***
+           * Act
+           */
+          issue_uia(bob_id, asset(200, uia_id));
+          transfer(alice_id, carol_id, asset(100, uia_id));
+
+
+          /***
+           * Assert
+           */
+          // pending balance changes are counted straight away
+          BOOST_CHECK_EQUAL(asset_api.get_asset_holders_count("HOLDME"), initial + 2);
+          BOOST_CHECK_EQUAL(count_in_all(), initial + 2);
+          generate_block();
+          BOOST_CHECK_EQUAL(asset_api.get_asset_holders_count("HOLDME"), initial + 2);
+          BOOST_CHECK_EQUAL(asset_api.get_asset_holders_count(std::string(object_id_type(uia_id))), initial + 2);
+
+          // the count is of balance objects, so emptying a balance keeps it, while the listing drops it
+          transfer(bob_id, carol_id, asset(200, uia_id));
+          generate_block();
+          BOOST_CHECK_EQUAL(asset_api.get_asset_holders_count("HOLDME"), initial + 2);
+          BOOST_CHECK_EQUAL(count_in_all(), initial + 2);
+          const auto holders = asset_api.list_asset_holders("HOLDME", {}, 100);
+          BOOST_REQUIRE_EQUAL(holders.size(), 2u);
+          BOOST_CHECK(holders[0].account_id == alice_id);
+          BOOST_CHECK_EQUAL(holders[0].amount.value, 400);
+          BOOST_CHECK(holders[1].account_id == carol_id);
+          BOOST_CHECK_EQUAL(holders[1].amount.value, 300);
+
+      } FC_LOG_AND_RETHROW()
+  }
+
+  BOOST_AUTO_TEST_CASE(subscribe_to_key_references) {
+      try {
+          /***
+           * Arrange
+           */
+          ACTORS((alice)(bob));
+          fund(alice, asset(10000000));
+          fund(bob, asset(10000000));
+          generate_block();
+
+          graphene::app::database_api db_api(db, app.database_api_state());
+          flat_set<object_id_type> notified;
+          db_api.set_subscribe_callback([&notified](const variant &notices) {
+             for (const variant &notice : notices.get_array())
+                notified.insert(notice["id"].as<object_id_type>(1));
+          }, false);
+
+          const auto refs = db_api.get_key_references({alice_public_key});
+          BOOST_REQUIRE_EQUAL(refs.size(), 1u);
+          BOOST_REQUIRE_EQUAL(refs[0].size(), 1u);
+          BOOST_CHECK(refs[0][0] == alice_id);
+
+
+          /***
+           * Act
+           */
+          upgrade_to_lifetime_member(alice_id);
+          upgrade_to_lifetime_member(bob_id);
+          generate_block();
+          // notices are queued to this thread
+          fc::usleep(fc::milliseconds(10));
+
+
+          /***
+           * Assert
+           */
+          BOOST_CHECK(notified.find(alice_id) != notified.end());
+          BOOST_CHECK(notified.find(bob_id) == notified.end());
+
+      } FC_LOG_AND_RETHROW()
+  }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -27,6 +27,7 @@
 #include <graphene/chain/database.hpp>
 
 #include <graphene/chain/account_object.hpp>
+#include <graphene/chain/vesting_balance_object.hpp>
 
 #include <fc/crypto/digest.hpp>
 
@@ -195,4 +196,65 @@ BOOST_AUTO_TEST_CASE( direct_index_test )
    // but the secondary has not updated its representation
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( balance_totals_secondary_indexes_test )
+{ try {
+   ACTORS( (alice)(bob) );
+   const asset_id_type core_id;
+   const auto& balance_counts = db.get_index_type< primary_index< account_balance_index > >()
+                                  .get_secondary_index< balance_counts_by_asset_index >();
+   const auto& vesting_totals = db.get_index_type< primary_index< vesting_balance_index > >()
+                                  .get_secondary_index< vesting_balance_totals_index >();
+
+   // compares the incrementally maintained values against a walk of the primary indexes
+   auto check_totals = [&]() {
+      uint64_t balance_objects = 0;
+      for( const account_balance_object& b : db.get_index_type< account_balance_index >().indices() )
+         if( b.asset_type == core_id )
+            ++balance_objects;
+      BOOST_CHECK_EQUAL( balance_counts.get_balance_counts( core_id ).balance_objects, balance_objects );
+
+      uint64_t vesting_objects = 0;
+      share_type vesting_amount;
+      for( const vesting_balance_object& v : db.get_index_type< vesting_balance_index >().indices() )
+         if( v.balance.asset_id == core_id && v.balance_type == vesting_balance_type::gpos )
+         {
+            ++vesting_objects;
+            vesting_amount += v.balance.amount;
+         }
+      const auto totals = vesting_totals.get_totals( core_id, vesting_balance_type::gpos );
+      BOOST_CHECK_EQUAL( totals.balance_objects, vesting_objects );
+      BOOST_CHECK_EQUAL( totals.amount.value, vesting_amount.value );
+   };
+
+   check_totals();
+   const uint64_t objects_before = balance_counts.get_balance_counts( core_id ).balance_objects;
+   fund( alice, asset(1000) );
+   check_totals();
+   BOOST_CHECK_EQUAL( balance_counts.get_balance_counts( core_id ).balance_objects, objects_before + 1 );
+
+   const vesting_balance_object& vbo = db.create<vesting_balance_object>( [&]( vesting_balance_object& obj ) {
+      obj.owner = bob_id;
+      obj.balance = asset(600);
+      obj.balance_type = vesting_balance_type::gpos;
+   });
+   const vesting_balance_id_type vbo_id = vbo.id;
+   check_totals();
+   {
+      auto session = db._undo_db.start_undo_session();
+      db.adjust_balance( alice_id, -asset(1000) );
+      db.adjust_balance( bob_id, asset(400) );
+      check_totals();
+      db.modify( vbo, [&]( vesting_balance_object& obj ) {
+         obj.balance.amount -= 100;
+      });
+      check_totals();
+      db.remove( vbo );
+      check_totals();
+      // undoing restores all of the above, including the removed vesting balance
+   }
+   BOOST_CHECK_EQUAL( vbo_id(db).balance.amount.value, 600 );
+   check_totals();
+   BOOST_CHECK_EQUAL( balance_counts.get_balance_counts( core_id ).balance_objects, objects_before + 1 );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -25,6 +25,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <graphene/app/api.hpp>
+#include <graphene/net/peer_connection.hpp>
 
 #include "../common/database_fixture.hpp"
 
@@ -198,4 +199,49 @@ BOOST_AUTO_TEST_CASE(unsubscribe_from_pending_transactions) {
     } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE(sync_request_window_follows_delivery_rate) {
+    try {
+        graphene::net::peer_connection_ptr peer = graphene::net::peer_connection::make_shared(nullptr);
+        const unsigned unmeasured_window = GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING;
+        const unsigned maximum_window = GRAPHENE_NET_MAX_SYNC_REQUEST_WINDOW;
+        auto window = [&]() { return peer->get_sync_request_window(unmeasured_window, maximum_window); };
+
+        // deliver one request's worth of blocks, the gaps between them cycling through the given intervals
+        fc::time_point now = fc::time_point::now();
+        auto deliver = [&](unsigned blocks, std::vector<int64_t> intervals_us) {
+            const fc::time_point request_time = now;
+            for (unsigned i = 0; i < blocks; ++i) {
+                now += fc::microseconds(intervals_us[i % intervals_us.size()]);
+                peer->record_sync_block_received(request_time, now);
+            }
+        };
+
+        BOOST_TEST_MESSAGE("An unmeasured peer gets the fixed window");
+        BOOST_CHECK_EQUAL(window(), unmeasured_window);
+
+        BOOST_TEST_MESSAGE("A fast peer's window grows past the fixed one, up to the ceiling");
+        deliver(100, {100});
+        BOOST_CHECK_EQUAL(window(), maximum_window);
+        BOOST_CHECK_GT(window(), unmeasured_window);
+
+        BOOST_TEST_MESSAGE("A slow peer's window shrinks to the floor");
+        deliver(100, {50000});
+        BOOST_CHECK_EQUAL(window(), GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING);
+
+        BOOST_TEST_MESSAGE("Blocks arriving in bursts count at their average throughput");
+        // one block per millisecond on average, every other one in the same read as the one before it
+        deliver(100, {1, 1999});
+        BOOST_CHECK_GT(window(), 300u);
+        BOOST_CHECK_LT(window(), 500u);
+
+        BOOST_TEST_MESSAGE("A steady peer gets what it delivers in the target duration");
+        deliver(100, {1000});
+        BOOST_CHECK_GE(peer->average_sync_block_interval.count(), 990);
+        BOOST_CHECK_LE(peer->average_sync_block_interval.count(), 1010);
+        BOOST_CHECK_GE(window(), 395u);
+        BOOST_CHECK_LE(window(), 405u);
+
+    } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_SUITE_END()
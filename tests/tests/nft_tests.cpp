@@ -2,6 +2,7 @@
 
 #include "../common/database_fixture.hpp"
 
+#include <graphene/app/database_api.hpp>
 #include <graphene/chain/hardfork.hpp>
 #include <graphene/chain/nft_object.hpp>
 
@@ -408,5 +409,174 @@ BOOST_AUTO_TEST_CASE( nft_set_approval_for_all_test ) {
    }
 }
 
+BOOST_AUTO_TEST_CASE( nft_token_queries_test ) {
+
+   BOOST_TEST_MESSAGE("nft_token_queries_test");
+
+   INVOKE(nft_metadata_create_test);
+
+   ACTORS((alice)(bob)(carol));
+   GET_ACTOR(mdowner);
+
+   generate_block();
+   set_expiration(db, trx);
+
+   const nft_metadata_id_type first_md_id = db.get_index_type<nft_metadata_index>().indices().get<by_id>().begin()->id;
+   nft_metadata_id_type second_md_id;
+   {
+      nft_metadata_create_operation op;
+      op.owner = mdowner_id;
+      op.symbol = "SEC";
+      op.base_uri = "http://nft.example.com";
+      op.name = "second";
+      op.is_transferable = true;
+      trx.operations.push_back(op);
+      sign(trx, mdowner_private_key);
+      second_md_id = PUSH_TX(db, trx, ~0).operation_results[0].get<object_id_type>();
+      trx.clear();
+   }
+
+   auto mint = [&](nft_metadata_id_type md_id, account_id_type owner) {
+      nft_mint_operation op;
+      op.payer = mdowner_id;
+      op.nft_metadata_id = md_id;
+      op.owner = owner;
+      op.approved = owner;
+      trx.operations.push_back(op);
+      sign(trx, mdowner_private_key);
+      nft_id_type token_id = PUSH_TX(db, trx, ~0).operation_results[0].get<object_id_type>();
+      trx.clear();
+      return token_id;
+   };
+   auto transfer_token = [&](nft_id_type token_id, account_id_type from, account_id_type to, const fc::ecc::private_key& from_key) {
+      nft_safe_transfer_from_operation op;
+      op.operator_ = from;
+      op.from = from;
+      op.to = to;
+      op.token_id = token_id;
+      op.data = "data";
+      trx.operations.push_back(op);
+      sign(trx, from_key);
+      PUSH_TX(db, trx, ~0);
+      trx.clear();
+   };
+
+   // 12 tokens across both collections, alice and bob holding interleaved ones
+   vector<nft_id_type> tokens;
+   for (int i = 0; i < 12; ++i)
+      tokens.push_back(mint(i % 2 ? second_md_id : first_md_id, i % 3 ? alice_id : bob_id));
+   generate_block();
+
+   graphene::app::database_api db_api(db);
+   const nft_object missing;
+
+   // what the API must agree with: every token currently in the database, in id order
+   auto tokens_where = [&](std::function<bool(const nft_object&)> pred) {
+      vector<nft_id_type> result;
+      const auto& idx = db.get_index_type<nft_index>().indices().get<by_id>();
+      for (const nft_object& token : idx)
+         if (pred(token))
+            result.push_back(token.id);
+      return result;
+   };
+   auto ids_of = [](const vector<nft_object>& objs) {
+      vector<nft_id_type> result;
+      for (const nft_object& obj : objs)
+         result.push_back(obj.id);
+      return result;
+   };
+   // nft_token_of_owner_by_index must walk tokens in the order of the index it ranks, and stop at its end
+   auto check_owner_positions = [&](nft_metadata_id_type md_id, account_id_type owner) {
+      const auto& idx = db.get_index_type<nft_index>().indices().get<by_metadata_and_owner>();
+      auto range = idx.equal_range(std::make_tuple(md_id, owner));
+      uint64_t position = 0;
+      for (auto itr = range.first; itr != range.second; ++itr, ++position)
+         BOOST_CHECK(db_api.nft_token_of_owner_by_index(md_id, owner, position).id == itr->id);
+      BOOST_CHECK(db_api.nft_token_of_owner_by_index(md_id, owner, position).id == missing.id);
+      BOOST_CHECK(db_api.nft_token_of_owner_by_index(md_id, owner, position + 1000).id == missing.id);
+      return position;
+   };
+   auto check_all = [&]() {
+      for (nft_metadata_id_type md_id : {first_md_id, second_md_id}) {
+         const vector<nft_id_type> in_collection = tokens_where([&](const nft_object& t) { return t.nft_metadata_id == md_id; });
+         for (uint64_t i = 0; i < in_collection.size(); ++i)
+            BOOST_CHECK(db_api.nft_token_by_index(md_id, i).id == in_collection[i]);
+         BOOST_CHECK(db_api.nft_token_by_index(md_id, in_collection.size()).id == missing.id);
+         BOOST_CHECK(db_api.nft_token_by_index(md_id, std::numeric_limits<uint64_t>::max()).id == missing.id);
+
+         for (account_id_type owner : {alice_id, bob_id, carol_id}) {
+            const auto owned = tokens_where([&](const nft_object& t) { return t.nft_metadata_id == md_id && t.owner == owner; });
+            BOOST_CHECK_EQUAL(check_owner_positions(md_id, owner), owned.size());
+         }
+      }
+      for (account_id_type owner : {alice_id, bob_id, carol_id}) {
+         const vector<nft_id_type> owned = tokens_where([&](const nft_object& t) { return t.owner == owner; });
+         BOOST_CHECK_EQUAL(db_api.nft_get_balance(owner), owned.size());
+         BOOST_CHECK(ids_of(db_api.nft_list_tokens_by_owner(owner, nft_id_type(), 100)) == owned);
+
+         // page through the owner's tokens, resuming after the last one seen
+         vector<nft_id_type> paged;
+         nft_id_type cursor;
+         for (vector<nft_object> page; !(page = db_api.nft_list_tokens_by_owner(owner, cursor, 3)).empty(); ) {
+            BOOST_CHECK_LE(page.size(), 3u);
+            for (const nft_object& token : page)
+               BOOST_CHECK(token.owner == owner);
+            auto page_ids = ids_of(page);
+            paged.insert(paged.end(), page_ids.begin(), page_ids.end());
+            cursor = nft_id_type(page.back().id.instance() + 1);
+         }
+         BOOST_CHECK(paged == owned);
+      }
+
+      const vector<nft_id_type> all = tokens_where([](const nft_object&) { return true; });
+      vector<nft_id_type> paged;
+      nft_id_type cursor;
+      for (vector<nft_object> page; !(page = db_api.nft_list_tokens(cursor, 5)).empty(); ) {
+         BOOST_CHECK_LE(page.size(), 5u);
+         auto page_ids = ids_of(page);
+         paged.insert(paged.end(), page_ids.begin(), page_ids.end());
+         cursor = nft_id_type(page.back().id.instance() + 1);
+      }
+      BOOST_CHECK(paged == all);
+   };
+
+   BOOST_TEST_MESSAGE("Check the token queries after minting");
+   BOOST_CHECK_EQUAL(db_api.nft_get_balance(alice_id), 8u);
+   BOOST_CHECK_EQUAL(db_api.nft_get_balance(bob_id), 4u);
+   BOOST_CHECK_EQUAL(db_api.nft_get_balance(carol_id), 0u);
+   BOOST_CHECK(db_api.nft_token_by_index(first_md_id, 0).id == tokens[0]);
+   BOOST_CHECK(db_api.nft_token_by_index(second_md_id, 5).id == tokens[11]);
+   BOOST_CHECK(db_api.nft_token_of_owner_by_index(first_md_id, bob_id, 1).id == tokens[6]);
+   check_all();
+
+   BOOST_TEST_MESSAGE("Check the limits");
+   BOOST_CHECK(db_api.nft_list_tokens(nft_id_type(), 0).empty());
+   BOOST_CHECK_EQUAL(db_api.nft_list_tokens(nft_id_type(), 100).size(), 12u);
+   GRAPHENE_REQUIRE_THROW(db_api.nft_list_tokens(nft_id_type(), 101), fc::exception);
+   GRAPHENE_REQUIRE_THROW(db_api.nft_list_tokens_by_owner(alice_id, nft_id_type(), 101), fc::exception);
+   BOOST_CHECK(db_api.nft_list_tokens(nft_id_type(tokens.back().instance.value + 1), 10).empty());
+   BOOST_CHECK(db_api.nft_list_tokens_by_owner(alice_id, nft_id_type(tokens.back().instance.value + 1), 10).empty());
+
+   BOOST_TEST_MESSAGE("Check the token queries after transfers");
+   transfer_token(tokens[1], alice_id, carol_id, alice_private_key);
+   transfer_token(tokens[4], alice_id, bob_id, alice_private_key);
+   transfer_token(tokens[0], bob_id, alice_id, bob_private_key);
+   transfer_token(tokens[10], alice_id, carol_id, alice_private_key);
+   generate_block();
+   BOOST_CHECK_EQUAL(db_api.nft_get_balance(carol_id), 2u);
+   BOOST_CHECK(ids_of(db_api.nft_list_tokens_by_owner(carol_id, nft_id_type(), 100)) == vector<nft_id_type>({tokens[1], tokens[10]}));
+   BOOST_CHECK(ids_of(db_api.nft_list_tokens_by_owner(carol_id, tokens[2], 100)) == vector<nft_id_type>({tokens[10]}));
+   check_all();
+
+   BOOST_TEST_MESSAGE("Check the token queries after burning tokens");
+   // tokens are only ever removed from the database the way lottery tickets are deleted after a draw
+   for (nft_id_type token_id : {tokens[0], tokens[5], tokens[10]})
+      db.remove(token_id(db));
+   BOOST_CHECK_EQUAL(db_api.nft_get_balance(carol_id), 1u);
+   BOOST_CHECK(db_api.nft_list_tokens_by_owner(carol_id, tokens[2], 100).empty());
+   BOOST_CHECK(db_api.nft_token_by_index(first_md_id, 0).id == tokens[2]);
+   check_all();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -230,6 +230,59 @@ BOOST_AUTO_TEST_CASE( margin_call_limit_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( margin_call_front_of_book_test )
+{ try {
+      generate_blocks( HARDFORK_DEX_CALL_CHECK_TIME );
+      generate_block();
+      set_expiration( db, trx );
+
+      ACTORS((borrower)(borrower2)(feedproducer));
+
+      const auto& bitusd = create_bitasset("USDBIT", feedproducer_id);
+      const auto& core   = asset_id_type()(db);
+      const auto& call_limits = db.get_index_type< primary_index< asset_bitasset_data_index > >()
+                                   .get_secondary_index< bitasset_call_limit_index >();
+
+      int64_t init_balance(1000000);
+
+      transfer(committee_account, borrower_id, asset(init_balance));
+      transfer(committee_account, borrower2_id, asset(init_balance));
+      update_feed_producers( bitusd, {feedproducer.id} );
+      BOOST_CHECK( call_limits.get_call_limit( bitusd.id ) == nullptr );
+
+      price_feed current_feed;
+      current_feed.settlement_price = bitusd.amount( 100 ) / core.amount(100);
+      publish_feed( bitusd, feedproducer, current_feed );
+      BOOST_REQUIRE( call_limits.get_call_limit( bitusd.id ) != nullptr );
+      BOOST_CHECK( *call_limits.get_call_limit( bitusd.id ) == bitusd.bitasset_data(db).current_feed.max_short_squeeze_price() );
+
+      call_order_id_type call_id = borrow( borrower, bitusd.amount(1000), asset(2000) )->id;
+      borrow( borrower2, bitusd.amount(1000), asset(10000) );
+
+      // core drops to 1.5 per usd, the first position is below the maintenance collateral ratio
+      current_feed.settlement_price = bitusd.amount( 100 ) / core.amount(150);
+      publish_feed( bitusd, feedproducer, current_feed );
+      BOOST_CHECK( *call_limits.get_call_limit( bitusd.id ) == bitusd.bitasset_data(db).current_feed.max_short_squeeze_price() );
+
+      BOOST_TEST_MESSAGE( "An order below the call limit doesn't call the position" );
+      auto order = create_sell_order( borrower2, bitusd.amount(100), core.amount(500) );
+      BOOST_REQUIRE( order != nullptr );
+      BOOST_CHECK( !db.is_front_of_callable_book( *order ) );
+      BOOST_CHECK( db.is_front_of_callable_book( *order, false ) );
+      BOOST_CHECK_EQUAL( call_id(db).debt.value, 1000 );
+
+      BOOST_TEST_MESSAGE( "An order at the front of the book above the call limit calls the position" );
+      order = create_sell_order( borrower2, bitusd.amount(100), core.amount(200) );
+      BOOST_CHECK( order == nullptr );
+      BOOST_CHECK_EQUAL( call_id(db).debt.value, 900 );
+      BOOST_CHECK_EQUAL( call_id(db).collateral.value, 1800 );
+      BOOST_CHECK_EQUAL( get_balance( borrower2, core ), init_balance - 10000 + 200 );
+   } catch( const fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 /**
  *  This test sets up the minimum condition for a black swan to occur but does
  *  not test the full range of cases that may be possible during a black swan.
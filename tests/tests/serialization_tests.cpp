@@ -25,7 +25,8 @@
 #include <boost/test/unit_test.hpp>
 
 #include <graphene/chain/database.hpp>
-
+#include <graphene/net/core_messages.hpp>
+#include <graphene/net/message.hpp>
 
 #include <fc/crypto/digest.hpp>
 #include <fc/crypto/elliptic.hpp>
@@ -112,4 +113,44 @@ BOOST_AUTO_TEST_CASE( extension_serialization_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( compact_block_message_test )
+{
+   try {
+      ACTOR( alice );
+      transfer_operation op;
+      op.from = alice_id;
+      op.to = account_id_type();
+      op.amount = asset(1);
+      signed_transaction relayed_trx;
+      relayed_trx.operations.push_back( op );
+      test::set_expiration( db, relayed_trx );
+      sign( relayed_trx, alice_private_key );
+
+      signed_block block;
+      block.timestamp = db.head_block_time();
+      block.transactions.emplace_back( relayed_trx );
+      block.transactions.back().operation_results.push_back( void_result() );
+      block.transaction_merkle_root = block.calculate_merkle_root();
+      graphene::net::block_message full_block( block );
+      graphene::net::message_hash_type full_block_hash = graphene::net::message( full_block ).id();
+
+      // the compact form refers to the transaction by the id it was relayed under
+      graphene::net::compact_block_message compact_block( full_block, full_block_hash );
+      BOOST_REQUIRE_EQUAL( compact_block.transactions.size(), 1u );
+      BOOST_CHECK( compact_block.transactions[0].transaction_message_id ==
+                   graphene::net::message( graphene::net::trx_message( relayed_trx ) ).id() );
+      BOOST_CHECK( compact_block.block_id == full_block.block_id );
+
+      // rebuilding it from the relayed transaction gives back the exact block message
+      signed_block rebuilt;
+      static_cast<signed_block_header&>( rebuilt ) = compact_block.header;
+      rebuilt.transactions.emplace_back( relayed_trx );
+      rebuilt.transactions.back().operation_results = compact_block.transactions[0].operation_results;
+      BOOST_CHECK( graphene::net::message( graphene::net::block_message( rebuilt ) ).id() == full_block_hash );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()